@@ -0,0 +1,208 @@
+#include "GameOfLife.hpp"
+
+BatchRunner::BatchRunner(int generations, const std::string &output_dir, int thread_count)
+    : generations(generations),
+      output_dir(output_dir),
+      thread_count(thread_count > 0 ? thread_count : 1) {}
+
+std::vector<std::string> BatchRunner::find_patterns(const std::string &source)
+{
+    std::vector<std::string> files;
+    std::error_code error;
+    if (std::filesystem::is_directory(source, error))
+    {
+        std::filesystem::directory_iterator entries(source, error);
+        for (; !error && entries != std::filesystem::directory_iterator(); entries.increment(error))
+        {
+            bool regular = entries->is_regular_file(error);
+            if (error)
+            {
+                break;
+            }
+            if (regular && entries->path().extension() == ".live")
+            {
+                files.push_back(entries->path().string());
+            }
+        }
+        if (error)
+        {
+            throw std::runtime_error("It couldn't list directory: " + source + " (" + error.message() + ")");
+        }
+    }
+    else
+    {
+        glob_t matches{};
+        if (::glob(source.c_str(), 0, nullptr, &matches) == 0)
+        {
+            for (size_t i = 0; i < matches.gl_pathc; ++i)
+            {
+                files.push_back(matches.gl_pathv[i]);
+            }
+        }
+        ::globfree(&matches);
+    }
+
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+void BatchRunner::run(const std::vector<std::string> &input_files)
+{
+    // Results are named after the pattern files, so patterns of the same name from different directories collide
+    std::vector<std::string> output_files;
+    std::map<std::string, std::string> inputs_by_output;
+    for (const std::string &input_file : input_files)
+    {
+        output_files.push_back((std::filesystem::path(output_dir) / std::filesystem::path(input_file).filename()).string());
+        auto [found, inserted] = inputs_by_output.emplace(output_files.back(), input_file);
+        if (!inserted)
+        {
+            throw std::invalid_argument("Patterns " + found->second + " and " + input_file + " would both be written to " +
+                                        output_files.back() + ".");
+        }
+    }
+
+    jobs.assign(input_files.size(), Job());
+    std::vector<size_t> order(jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        jobs[i].input_file = input_files[i];
+        jobs[i].output_file = output_files[i];
+        jobs[i].cells = estimate_cells(input_files[i]);
+        order[i] = i;
+    }
+
+    // Largest first, dealt round robin so every queue starts with a big job
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b)
+                     { return jobs[a].cells > jobs[b].cells; });
+    size_t threads = std::min<size_t>(thread_count, std::max<size_t>(1, jobs.size()));
+    std::vector<WorkQueue> queues(threads);
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        queues[i % threads].jobs.push_back(order[i]);
+    }
+
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([this, &queues, t]
+                             {
+                                 // The scratch field lives as long as the thread and serves all its jobs
+                                 PackedField buffer;
+                                 size_t job;
+                                 while (take_job(queues, t, job))
+                                 {
+                                     run_job(jobs[job], buffer);
+                                 } });
+    }
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+const std::vector<BatchRunner::Job> &BatchRunner::get_jobs() const
+{
+    return jobs;
+}
+
+void BatchRunner::write_summary(const std::string &csv_file) const
+{
+    std::ofstream file(csv_file);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("It couldn't open file for write: " + csv_file);
+    }
+
+    file << "input,output,cells,seconds,population,error\n";
+    for (const Job &job : jobs)
+    {
+        file << csv_field(job.input_file) << ',' << csv_field(job.output_file) << ',' << job.cells << ','
+             << job.seconds << ',' << job.population << ',' << csv_field(job.error) << '\n';
+    }
+
+    if (!file)
+    {
+        throw std::runtime_error("It couldn't write to file: " + csv_file);
+    }
+}
+
+std::string BatchRunner::csv_field(const std::string &value)
+{
+    std::string field = "\"";
+    for (char c : value)
+    {
+        if (c == '"')
+        {
+            field += '"';
+        }
+        field += c;
+    }
+    return field + '"';
+}
+
+long long BatchRunner::estimate_cells(const std::string &file_name)
+{
+    std::ifstream file(file_name);
+    std::string line;
+    while (std::getline(file, line) && !line.empty() && line[0] == '#')
+    {
+        if (line.rfind("#Size ", 0) == 0)
+        {
+            long long size = std::atoll(line.c_str() + 6);
+            return size * size;
+        }
+    }
+    return 0;
+}
+
+bool BatchRunner::take_job(std::vector<WorkQueue> &queues, size_t own, size_t &job)
+{
+    {
+        std::lock_guard<std::mutex> lock(queues[own].mutex);
+        if (!queues[own].jobs.empty())
+        {
+            job = queues[own].jobs.front();
+            queues[own].jobs.pop_front();
+            return true;
+        }
+    }
+
+    // Steal from the small end, the owner keeps working on its big jobs
+    for (size_t i = 1; i < queues.size(); ++i)
+    {
+        WorkQueue &victim = queues[(own + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty())
+        {
+            job = victim.jobs.back();
+            victim.jobs.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void BatchRunner::run_job(Job &job, PackedField &buffer) const
+{
+    auto started = std::chrono::steady_clock::now();
+    try
+    {
+        GameState game;
+        ParserFile parser_file(job.input_file);
+        parser_file.parse(game);
+        job.cells = static_cast<long long>(game.get_size()) * game.get_size();
+
+        GameEngine engine(game, generations, buffer);
+        engine.UpdateGameState();
+
+        LiveFileWriter writer(job.output_file);
+        writer.write(game);
+        job.population = game.get_population();
+    }
+    catch (const std::exception &e)
+    {
+        job.error = e.what();
+    }
+    job.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+}
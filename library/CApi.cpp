@@ -0,0 +1,171 @@
+#include "GameOfLife.hpp"
+#include "GameOfLife.h"
+
+struct gol_universe
+{
+    GameState game;                             // Field, rule and generation counter
+    PackedField buffer;                         // Scratch field reused by every step
+    gol_generation_callback callback = nullptr; // Function called after every generation
+    void *user_data = nullptr;                  // Pointer passed to the callback
+    std::string error;                          // Message of the last failure
+};
+
+namespace
+{
+    // Read-only stream over a caller's buffer, so that loading does not copy the data first
+    class MemoryBuffer : public std::streambuf
+    {
+    public:
+        MemoryBuffer(const char *data, size_t length)
+        {
+            char *begin = const_cast<char *>(data);
+            setg(begin, begin, begin + length);
+        }
+    };
+
+    // Gives a game without live cells its storage, so that gol_cells always has a buffer
+    void allocate_field(GameState &game)
+    {
+        if (game.get_packed_field().get_size() != game.get_size())
+        {
+            game.set_field(PackedField(game.get_size()));
+        }
+    }
+}
+
+extern "C"
+{
+    int gol_api_version(void)
+    {
+        return GOL_API_VERSION;
+    }
+
+    gol_universe *gol_create(int size)
+    {
+        if (size < 1)
+        {
+            return nullptr;
+        }
+        try
+        {
+            gol_universe *universe = new gol_universe;
+            universe->game.set_size(size);
+            universe->game.set_B_conditions({3});
+            universe->game.set_S_conditions({2, 3});
+            allocate_field(universe->game);
+            return universe;
+        }
+        catch (const std::exception &)
+        {
+            return nullptr;
+        }
+    }
+
+    void gol_destroy(gol_universe *universe)
+    {
+        delete universe;
+    }
+
+    int gol_load(gol_universe *universe, const char *data, size_t length)
+    {
+        if (universe == nullptr || (data == nullptr && length > 0))
+        {
+            return GOL_ERROR_ARGUMENT;
+        }
+        try
+        {
+            MemoryBuffer buffer(data, length);
+            std::istream input(&buffer);
+            GameState loaded;
+            ParserFile parser_file("<buffer>");
+            parser_file.parse(input, loaded, [&loaded](int row, int col)
+                              { loaded.set_cell(row, col, true); });
+            if (loaded.get_size() < 1)
+            {
+                throw std::runtime_error("The buffer has no #Size line.");
+            }
+            allocate_field(loaded);
+            universe->game = std::move(loaded);
+            return GOL_OK;
+        }
+        catch (const std::exception &e)
+        {
+            universe->error = e.what();
+            return GOL_ERROR_PARSE;
+        }
+    }
+
+    int gol_step(gol_universe *universe, int generations)
+    {
+        if (universe == nullptr)
+        {
+            return GOL_ERROR_ARGUMENT;
+        }
+        if (generations < 0)
+        {
+            universe->error = "The number of generations must not be negative.";
+            return GOL_ERROR_ARGUMENT;
+        }
+        try
+        {
+            GameEngine engine(universe->game, generations, universe->buffer);
+            if (universe->callback != nullptr)
+            {
+                engine.add_generation_callback([universe](const GameState &state)
+                                               { universe->callback(universe, state.get_count_of_iterations(), universe->user_data); });
+            }
+            engine.UpdateGameState();
+            return GOL_OK;
+        }
+        catch (const std::exception &e)
+        {
+            universe->error = e.what();
+            return GOL_ERROR_RUNTIME;
+        }
+    }
+
+    int gol_set_callback(gol_universe *universe, gol_generation_callback callback, void *user_data)
+    {
+        if (universe == nullptr)
+        {
+            return GOL_ERROR_ARGUMENT;
+        }
+        universe->callback = callback;
+        universe->user_data = user_data;
+        return GOL_OK;
+    }
+
+    int gol_size(const gol_universe *universe)
+    {
+        return universe == nullptr ? 0 : universe->game.get_size();
+    }
+
+    long long gol_generation(const gol_universe *universe)
+    {
+        return universe == nullptr ? 0 : universe->game.get_count_of_iterations();
+    }
+
+    long long gol_population(const gol_universe *universe)
+    {
+        return universe == nullptr ? 0 : universe->game.get_packed_field().population();
+    }
+
+    const uint64_t *gol_cells(const gol_universe *universe, size_t *stride)
+    {
+        if (universe == nullptr)
+        {
+            return nullptr;
+        }
+        const PackedField &field = universe->game.get_packed_field();
+        if (stride != nullptr)
+        {
+            *stride = static_cast<size_t>(field.get_stride());
+        }
+        return field.get_words().data();
+    }
+
+    const char *gol_last_error(const gol_universe *universe)
+    {
+        return universe == nullptr ? "" : universe->error.c_str();
+    }
+}
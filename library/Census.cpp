@@ -0,0 +1,563 @@
+#include "GameOfLife.hpp"
+
+namespace
+{
+    struct Cell
+    {
+        int row;
+        int col;
+    };
+
+    struct Run
+    {
+        int row;   // Row of the run
+        int start; // First live column
+        int end;   // Last live column
+    };
+
+    const uint8_t ROW_WRAP = 1; // Island crosses the top and bottom edge
+    const uint8_t COL_WRAP = 2; // Island crosses the left and right edge
+
+    class UnionFind
+    {
+    public:
+        explicit UnionFind(size_t count) : parent(count), flags(count, 0)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                parent[i] = static_cast<int>(i);
+            }
+        }
+
+        int find(int node)
+        {
+            while (parent[node] != node)
+            {
+                parent[node] = parent[parent[node]];
+                node = parent[node];
+            }
+            return node;
+        }
+
+        void unite(int a, int b, uint8_t flag)
+        {
+            int root_a = find(a);
+            int root_b = find(b);
+            if (root_a != root_b)
+            {
+                parent[root_b] = root_a;
+                flags[root_a] |= flags[root_b];
+            }
+            flags[root_a] |= flag;
+        }
+
+        uint8_t get_flags(int node)
+        {
+            return flags[find(node)];
+        }
+
+    private:
+        std::vector<int> parent;
+        std::vector<uint8_t> flags;
+    };
+
+    // Shifts the cells to start at row 0 and column 0 and returns the height and width
+    std::pair<int, int> normalize(std::vector<Cell> &cells)
+    {
+        int min_row = std::numeric_limits<int>::max(), min_col = std::numeric_limits<int>::max();
+        int max_row = std::numeric_limits<int>::min(), max_col = std::numeric_limits<int>::min();
+        for (const Cell &cell : cells)
+        {
+            min_row = std::min(min_row, cell.row);
+            min_col = std::min(min_col, cell.col);
+            max_row = std::max(max_row, cell.row);
+            max_col = std::max(max_col, cell.col);
+        }
+        for (Cell &cell : cells)
+        {
+            cell.row -= min_row;
+            cell.col -= min_col;
+        }
+        return {max_row - min_row + 1, max_col - min_col + 1};
+    }
+
+    // Height, width and a bitmap of the normalized cells
+    std::string shape_key(const std::vector<Cell> &cells, int height, int width)
+    {
+        std::string key(8 + (static_cast<size_t>(height) * width + 7) / 8, '\0');
+        std::memcpy(&key[0], &height, 4);
+        std::memcpy(&key[4], &width, 4);
+        for (const Cell &cell : cells)
+        {
+            size_t index = static_cast<size_t>(cell.row) * width + cell.col;
+            key[8 + index / 8] |= static_cast<char>(1 << (index % 8));
+        }
+        return key;
+    }
+
+    // Picks the smallest key of the eight rotations and reflections and turns the cells accordingly
+    std::string canonicalize(std::vector<Cell> &cells, int &height, int &width)
+    {
+        std::string best;
+        std::vector<Cell> best_cells;
+        int best_height = 0, best_width = 0;
+        std::vector<Cell> turned(cells.size());
+
+        for (int transform = 0; transform < 8; ++transform)
+        {
+            bool swaps = transform & 1;
+            int h = swaps ? width : height;
+            int w = swaps ? height : width;
+            for (size_t i = 0; i < cells.size(); ++i)
+            {
+                int r = cells[i].row, c = cells[i].col;
+                int row = swaps ? c : r;
+                int col = swaps ? r : c;
+                if (transform & 2)
+                {
+                    row = h - 1 - row;
+                }
+                if (transform & 4)
+                {
+                    col = w - 1 - col;
+                }
+                turned[i] = {row, col};
+            }
+
+            std::string key = shape_key(turned, h, w);
+            if (best.empty() || key < best)
+            {
+                best = std::move(key);
+                best_cells = turned;
+                best_height = h;
+                best_width = w;
+            }
+        }
+
+        cells = std::move(best_cells);
+        height = best_height;
+        width = best_width;
+        return best;
+    }
+
+    // Live cells of a packed field in row-major order
+    std::vector<Cell> live_cells(const PackedField &field)
+    {
+        std::vector<Cell> cells;
+        const PackedWords &words = field.get_words();
+        for (int row = 0; row < field.get_size(); ++row)
+        {
+            for (int w = 0; w < field.get_stride(); ++w)
+            {
+                for (uint64_t bits = words[static_cast<size_t>(row) * field.get_stride() + w]; bits != 0; bits &= bits - 1)
+                {
+                    cells.push_back({row, w * 64 + std::countr_zero(bits)});
+                }
+            }
+        }
+        return cells;
+    }
+
+    bool same_cells(const std::vector<Cell> &a, const std::vector<Cell> &b)
+    {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const Cell &x, const Cell &y)
+                          { return x.row == y.row && x.col == y.col; });
+    }
+
+    // Links the runs of two neighboring rows that touch each other, diagonals included
+    void link_rows(const std::vector<Run> &runs, size_t a_begin, size_t a_end, size_t b_begin, size_t b_end,
+                   int size, uint8_t flag, UnionFind &sets)
+    {
+        size_t i = a_begin, j = b_begin;
+        while (i < a_end && j < b_end)
+        {
+            if (runs[i].end + 1 < runs[j].start)
+            {
+                ++i;
+            }
+            else if (runs[j].end + 1 < runs[i].start)
+            {
+                ++j;
+            }
+            else
+            {
+                sets.unite(static_cast<int>(i), static_cast<int>(j), flag);
+                runs[i].end < runs[j].end ? ++i : ++j;
+            }
+        }
+
+        // Cells in the first and the last column touch across the edge
+        if (a_begin < a_end && b_begin < b_end && size > 1)
+        {
+            if (runs[a_begin].start == 0 && runs[b_end - 1].end == size - 1)
+            {
+                sets.unite(static_cast<int>(a_begin), static_cast<int>(b_end - 1), flag | COL_WRAP);
+            }
+            if (runs[b_begin].start == 0 && runs[a_end - 1].end == size - 1)
+            {
+                sets.unite(static_cast<int>(b_begin), static_cast<int>(a_end - 1), flag | COL_WRAP);
+            }
+        }
+    }
+
+    std::string picture_key(const std::vector<std::string> &rows)
+    {
+        std::vector<Cell> cells;
+        for (size_t r = 0; r < rows.size(); ++r)
+        {
+            for (size_t c = 0; c < rows[r].size(); ++c)
+            {
+                if (rows[r][c] == 'O')
+                {
+                    cells.push_back({static_cast<int>(r), static_cast<int>(c)});
+                }
+            }
+        }
+        auto [height, width] = normalize(cells);
+        return canonicalize(cells, height, width);
+    }
+
+    // Canonical keys of every phase of common Life objects
+    const std::unordered_map<std::string, std::string> &known_objects()
+    {
+        static const std::unordered_map<std::string, std::string> names = []
+        {
+            const std::vector<std::tuple<std::string, int, std::vector<std::string> > > catalogue = {
+                {"block", 1, {"OO", "OO"}},
+                {"beehive", 1, {".OO.", "O..O", ".OO."}},
+                {"loaf", 1, {".OO.", "O..O", ".O.O", "..O."}},
+                {"boat", 1, {"OO.", "O.O", ".O."}},
+                {"ship", 1, {"OO.", "O.O", ".OO"}},
+                {"tub", 1, {".O.", "O.O", ".O."}},
+                {"pond", 1, {".OO.", "O..O", "O..O", ".OO."}},
+                {"blinker", 2, {"OOO"}},
+                {"toad", 2, {".OOO", "OOO."}},
+                {"beacon", 2, {"OO..", "OO..", "..OO", "..OO"}},
+                {"glider", 4, {".O.", "..O", "OOO"}},
+                {"lwss", 4, {".O..O", "O....", "O...O", "OOOO."}},
+            };
+
+            std::unordered_map<std::string, std::string> table;
+            for (const auto &[name, period, rows] : catalogue)
+            {
+                // Register every phase, stepped in a box large enough for the period
+                int pad = period + 2;
+                GameState game;
+                game.set_size(static_cast<int>(std::max(rows.size(), rows[0].size())) + 2 * pad);
+                game.set_B_conditions({3});
+                game.set_S_conditions({2, 3});
+                for (size_t r = 0; r < rows.size(); ++r)
+                {
+                    for (size_t c = 0; c < rows[r].size(); ++c)
+                    {
+                        game.set_cell(pad + static_cast<int>(r), pad + static_cast<int>(c), rows[r][c] == 'O');
+                    }
+                }
+                for (int phase = 0; phase < period; ++phase)
+                {
+                    std::vector<Cell> cells = live_cells(game.get_packed_field());
+                    auto [height, width] = normalize(cells);
+                    table.emplace(canonicalize(cells, height, width), name);
+                    GameEngine(game, 1).UpdateGameState();
+                }
+            }
+            return table;
+        }();
+        return names;
+    }
+}
+
+Census::Census(int max_period) : max_period(max_period), objects(), island_count(0) {}
+
+void Census::take(const PackedField &field, const std::set<int> &B_conditions, const std::set<int> &S_conditions)
+{
+    objects.clear();
+    island_count = 0;
+
+    int size = field.get_size();
+    int stride = field.get_stride();
+    const PackedWords &words = field.get_words();
+
+    // Runs of live cells, row by row
+    std::vector<Run> runs;
+    std::vector<size_t> row_begin(static_cast<size_t>(size) + 1, 0);
+    for (int r = 0; r < size; ++r)
+    {
+        row_begin[r] = runs.size();
+        const uint64_t *row = &words[static_cast<size_t>(r) * stride];
+        int col = 0;
+        while (col < size)
+        {
+            int w = col >> 6;
+            uint64_t bits = row[w] & (~uint64_t(0) << (col & 63));
+            while (bits == 0 && ++w < stride)
+            {
+                bits = row[w];
+            }
+            if (w >= stride)
+            {
+                break;
+            }
+            int start = w * 64 + std::countr_zero(bits);
+
+            w = start >> 6;
+            uint64_t gaps = ~row[w] & (~uint64_t(0) << (start & 63));
+            while (gaps == 0 && ++w < stride)
+            {
+                gaps = ~row[w];
+            }
+            int end = w >= stride ? size : std::min(size, w * 64 + std::countr_zero(gaps));
+
+            runs.push_back({r, start, end - 1});
+            col = end;
+        }
+    }
+    row_begin[size] = runs.size();
+    if (runs.empty())
+    {
+        return;
+    }
+
+    // Islands: runs of the same and of neighboring rows that touch, across the edges too
+    UnionFind sets(runs.size());
+    for (int r = 0; r < size; ++r)
+    {
+        size_t begin = row_begin[r], end = row_begin[r + 1];
+        if (end - begin > 1 && runs[begin].start == 0 && runs[end - 1].end == size - 1)
+        {
+            sets.unite(static_cast<int>(begin), static_cast<int>(end - 1), COL_WRAP);
+        }
+        if (r > 0)
+        {
+            link_rows(runs, row_begin[r - 1], begin, begin, end, size, 0, sets);
+        }
+    }
+    if (size > 2)
+    {
+        link_rows(runs, row_begin[size - 1], row_begin[size], row_begin[0], row_begin[1], size, ROW_WRAP, sets);
+    }
+
+    // Group the runs of every island together
+    std::vector<int> island_of(runs.size(), -1);
+    std::vector<int> root_island(runs.size(), -1);
+    std::vector<size_t> island_begin;
+    for (size_t i = 0; i < runs.size(); ++i)
+    {
+        int root = sets.find(static_cast<int>(i));
+        if (root_island[root] < 0)
+        {
+            root_island[root] = static_cast<int>(island_count++);
+            island_begin.push_back(0);
+        }
+        island_of[i] = root_island[root];
+        ++island_begin[island_of[i]];
+    }
+    size_t offset = 0;
+    for (size_t &begin : island_begin)
+    {
+        size_t count = begin;
+        begin = offset;
+        offset += count;
+    }
+    island_begin.push_back(offset);
+    std::vector<size_t> next = island_begin;
+    std::vector<size_t> island_runs(runs.size());
+    for (size_t i = 0; i < runs.size(); ++i)
+    {
+        island_runs[next[island_of[i]]++] = i;
+    }
+
+    // Identical islands share the key of their normalized cells, so only new shapes are canonicalized
+    std::unordered_map<std::string, size_t> by_shape;
+    std::unordered_map<std::string, size_t> by_canonical;
+    std::vector<Cell> cells;
+    for (long long island = 0; island < island_count; ++island)
+    {
+        cells.clear();
+        uint8_t flags = sets.get_flags(static_cast<int>(island_runs[island_begin[island]]));
+        for (size_t k = island_begin[island]; k < island_begin[island + 1]; ++k)
+        {
+            const Run &run = runs[island_runs[k]];
+            int row = (flags & ROW_WRAP) && run.row < size / 2 ? run.row + size : run.row;
+            for (int col = run.start; col <= run.end; ++col)
+            {
+                cells.push_back({row, (flags & COL_WRAP) && col < size / 2 ? col + size : col});
+            }
+        }
+
+        auto [height, width] = normalize(cells);
+        std::string key = shape_key(cells, height, width);
+        auto found = by_shape.find(key);
+        if (found == by_shape.end())
+        {
+            std::string canonical = canonicalize(cells, height, width);
+            auto known = by_canonical.find(canonical);
+            size_t index;
+            if (known == by_canonical.end())
+            {
+                index = objects.size();
+                Object object;
+                object.population = static_cast<int>(cells.size());
+                object.rows.assign(height, std::string(width, '.'));
+                for (const Cell &cell : cells)
+                {
+                    object.rows[cell.row][cell.col] = 'O';
+                }
+                objects.push_back(std::move(object));
+                by_canonical.emplace(std::move(canonical), index);
+            }
+            else
+            {
+                index = known->second;
+            }
+            found = by_shape.emplace(std::move(key), index).first;
+        }
+        ++objects[found->second].count;
+    }
+
+    bool life = B_conditions == std::set<int>{3} && S_conditions == std::set<int>{2, 3};
+    for (Object &object : objects)
+    {
+        classify(object, B_conditions, S_conditions);
+        if (life)
+        {
+            auto name = known_objects().find(picture_key(object.rows));
+            if (name != known_objects().end())
+            {
+                object.name = name->second;
+            }
+        }
+    }
+
+    std::sort(objects.begin(), objects.end(), [](const Object &a, const Object &b)
+              { return a.count != b.count ? a.count > b.count : a.population < b.population; });
+}
+
+const std::vector<Census::Object> &Census::get_objects() const
+{
+    return objects;
+}
+
+long long Census::get_island_count() const
+{
+    return island_count;
+}
+
+std::string Census::format(size_t max_objects) const
+{
+    std::ostringstream out;
+    out << "islands: " << island_count << ", distinct objects: " << objects.size() << "\n";
+
+    auto column = [&out](const std::string &text, size_t width)
+    {
+        out << text << std::string(text.size() < width ? width - text.size() : 1, ' ');
+    };
+    column("count", 10);
+    column("kind", 12);
+    column("period", 8);
+    column("move", 8);
+    column("cells", 7);
+    out << "object\n";
+
+    for (size_t i = 0; i < objects.size() && i < max_objects; ++i)
+    {
+        const Object &object = objects[i];
+        std::string shape = object.name;
+        if (shape.empty())
+        {
+            // Small unknown objects are shown as their picture, rows separated by '/'
+            if (object.population <= 16 && object.rows[0].size() <= 8)
+            {
+                for (size_t r = 0; r < object.rows.size(); ++r)
+                {
+                    shape += (r > 0 ? "/" : "") + object.rows[r];
+                }
+            }
+            else
+            {
+                shape = std::to_string(object.rows[0].size()) + "x" + std::to_string(object.rows.size());
+            }
+        }
+
+        column(std::to_string(object.count), 10);
+        column(kind_name(object.kind), 12);
+        column(object.kind == Kind::OTHER ? "-" : std::to_string(object.period), 8);
+        column(object.kind == Kind::SPACESHIP ? std::to_string(object.dx) + "," + std::to_string(object.dy) : "-", 8);
+        column(std::to_string(object.population), 7);
+        out << shape << "\n";
+    }
+    if (objects.size() > max_objects)
+    {
+        out << "... " << objects.size() - max_objects << " more objects\n";
+    }
+    return out.str();
+}
+
+std::string Census::kind_name(Kind kind)
+{
+    switch (kind)
+    {
+    case Kind::STILL_LIFE:
+        return "still life";
+    case Kind::OSCILLATOR:
+        return "oscillator";
+    case Kind::SPACESHIP:
+        return "spaceship";
+    default:
+        return "other";
+    }
+}
+
+void Census::classify(Object &object, const std::set<int> &B_conditions, const std::set<int> &S_conditions) const
+{
+    int height = static_cast<int>(object.rows.size());
+    int width = static_cast<int>(object.rows[0].size());
+
+    // The box leaves room for a spaceship to travel for max_period generations without wrapping
+    int pad = max_period + 2;
+    GameState game;
+    game.set_size(std::max(height, width) + 2 * pad);
+    game.set_B_conditions(B_conditions);
+    game.set_S_conditions(S_conditions);
+    std::vector<Cell> start;
+    for (int r = 0; r < height; ++r)
+    {
+        for (int c = 0; c < width; ++c)
+        {
+            if (object.rows[r][c] == 'O')
+            {
+                game.set_cell(pad + r, pad + c, true);
+                start.push_back({r, c});
+            }
+        }
+    }
+
+    // Stepping stops at the first generation that repeats the shape
+    GameEngine engine(game, max_period);
+    int generation = 0;
+    for (const PackedField &field : engine.generations())
+    {
+        ++generation;
+        std::vector<Cell> cells = live_cells(field);
+        if (cells.empty())
+        {
+            break;
+        }
+
+        int min_row = cells.front().row;
+        int min_col = std::min_element(cells.begin(), cells.end(), [](const Cell &a, const Cell &b)
+                                       { return a.col < b.col; })->col;
+        normalize(cells);
+        if (same_cells(cells, start))
+        {
+            object.period = generation;
+            object.dy = min_row - pad;
+            object.dx = min_col - pad;
+            object.kind = object.dx != 0 || object.dy != 0 ? Kind::SPACESHIP
+                          : generation == 1                ? Kind::STILL_LIFE
+                                                           : Kind::OSCILLATOR;
+            return;
+        }
+    }
+    object.kind = Kind::OTHER;
+}
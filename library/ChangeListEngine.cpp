@@ -0,0 +1,147 @@
+#include "GameOfLife.hpp"
+
+ChangeListEngine::ChangeListEngine(GameState &game)
+    : game(game),
+      size(game.get_size()),
+      births(),
+      survivals(),
+      counts(),
+      alive(),
+      queued(),
+      changes(),
+      candidates(),
+      flips(),
+      counted_generation(-1)
+{
+    if (game.get_state_count() > 2)
+    {
+        throw std::invalid_argument("The change-list engine does not support dying cell states.");
+    }
+    GameEngine::get_rule_tables(game, births, survivals);
+    if (births[0])
+    {
+        // Every empty area would change, so there is no small set of changes to follow
+        throw std::invalid_argument("The change-list engine does not support births without neighbors (B0).");
+    }
+    rebuild();
+}
+
+void ChangeListEngine::run(int generations)
+{
+    if (game.get_size() != size || game.get_count_of_iterations() != counted_generation)
+    {
+        size = game.get_size();
+        rebuild();
+    }
+
+    for (int i = 0; i < generations; ++i)
+    {
+        step();
+    }
+}
+
+size_t ChangeListEngine::get_change_count() const
+{
+    return changes.size();
+}
+
+void ChangeListEngine::rebuild()
+{
+    size_t cells = static_cast<size_t>(size) * size;
+    counts.assign(cells, 0);
+    alive.assign((cells + 63) / 64, 0);
+    queued.assign((cells + 63) / 64, 0);
+    changes.clear();
+
+    // Only cells next to a live cell can change, so the live cells are the first changes
+    const PackedField &field = game.get_packed_field();
+    if (field.get_size() == size)
+    {
+        const PackedWords &words = field.get_words();
+        for (int row = 0; row < size; ++row)
+        {
+            for (int w = 0; w < field.get_stride(); ++w)
+            {
+                for (uint64_t bits = words[static_cast<size_t>(row) * field.get_stride() + w]; bits != 0; bits &= bits - 1)
+                {
+                    size_t cell = static_cast<size_t>(row) * size + w * 64 + std::countr_zero(bits);
+                    alive[cell >> 6] |= uint64_t(1) << (cell & 63);
+                    add_to_neighbors(cell, 1);
+                    changes.push_back(cell);
+                }
+            }
+        }
+    }
+    counted_generation = game.get_count_of_iterations();
+}
+
+void ChangeListEngine::step()
+{
+    // Cells in the neighborhood of a change, each once
+    candidates.clear();
+    for (size_t cell : changes)
+    {
+        int row = static_cast<int>(cell / size);
+        int col = static_cast<int>(cell % size);
+        size_t rows[3] = {static_cast<size_t>(row == 0 ? size - 1 : row - 1) * size, static_cast<size_t>(row) * size,
+                          static_cast<size_t>(row == size - 1 ? 0 : row + 1) * size};
+        int cols[3] = {col == 0 ? size - 1 : col - 1, col, col == size - 1 ? 0 : col + 1};
+        for (size_t row_start : rows)
+        {
+            for (int neighbor_col : cols)
+            {
+                size_t neighbor = row_start + neighbor_col;
+                uint64_t bit = uint64_t(1) << (neighbor & 63);
+                if (!(queued[neighbor >> 6] & bit))
+                {
+                    queued[neighbor >> 6] |= bit;
+                    candidates.push_back(neighbor);
+                }
+            }
+        }
+    }
+
+    // All cells are decided on the old counts before any count changes
+    flips.clear();
+    for (size_t cell : candidates)
+    {
+        queued[cell >> 6] &= ~(uint64_t(1) << (cell & 63));
+        bool is_alive = (alive[cell >> 6] >> (cell & 63)) & 1;
+        bool next = is_alive ? survivals[counts[cell]] : births[counts[cell]];
+        if (next != is_alive)
+        {
+            flips.push_back(cell);
+        }
+    }
+
+    for (size_t cell : flips)
+    {
+        alive[cell >> 6] ^= uint64_t(1) << (cell & 63);
+        bool born = (alive[cell >> 6] >> (cell & 63)) & 1;
+        game.set_cell(static_cast<int>(cell / size), static_cast<int>(cell % size), born);
+        add_to_neighbors(cell, born ? 1 : -1);
+    }
+
+    changes.swap(flips);
+    counted_generation = game.get_count_of_iterations() + 1;
+    game.set_count_of_iterations(counted_generation);
+}
+
+void ChangeListEngine::add_to_neighbors(size_t cell, int delta)
+{
+    int row = static_cast<int>(cell / size);
+    int col = static_cast<int>(cell % size);
+    int left = col == 0 ? size - 1 : col - 1;
+    int right = col == size - 1 ? 0 : col + 1;
+    uint8_t *up = &counts[static_cast<size_t>(row == 0 ? size - 1 : row - 1) * size];
+    uint8_t *mid = &counts[static_cast<size_t>(row) * size];
+    uint8_t *down = &counts[static_cast<size_t>(row == size - 1 ? 0 : row + 1) * size];
+    for (uint8_t *counts_row : {up, down})
+    {
+        counts_row[left] = static_cast<uint8_t>(counts_row[left] + delta);
+        counts_row[col] = static_cast<uint8_t>(counts_row[col] + delta);
+        counts_row[right] = static_cast<uint8_t>(counts_row[right] + delta);
+    }
+    mid[left] = static_cast<uint8_t>(mid[left] + delta);
+    mid[right] = static_cast<uint8_t>(mid[right] + delta);
+}
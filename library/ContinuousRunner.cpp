@@ -0,0 +1,97 @@
+#include "GameOfLife.hpp"
+
+// Constructor: prepares the runner without starting any threads
+ContinuousRunner::ContinuousRunner(GameState &game, int fps)
+    : game(game),
+      fps(fps > 0 ? fps : 30),
+      running(false),
+      computed(0),
+      snapshots(),
+      simulation_thread(),
+      rendering_thread()
+{
+}
+
+ContinuousRunner::~ContinuousRunner()
+{
+    stop();
+}
+
+void ContinuousRunner::add_generation_callback(const std::function<void(const GameState &)> &callback)
+{
+    generation_callbacks.push_back(callback);
+}
+
+void ContinuousRunner::start(const std::function<void(const PackedField &, int)> &render)
+{
+    if (running.exchange(true))
+    {
+        throw std::logic_error("The simulation is already running.");
+    }
+    computed = 0;
+    simulation_thread = std::thread(&ContinuousRunner::simulate, this);
+    rendering_thread = std::thread(&ContinuousRunner::render_frames, this, render);
+}
+
+void ContinuousRunner::stop()
+{
+    running = false;
+    if (simulation_thread.joinable())
+    {
+        simulation_thread.join();
+    }
+    if (rendering_thread.joinable())
+    {
+        rendering_thread.join();
+    }
+}
+
+long long ContinuousRunner::get_computed_generations() const
+{
+    return computed;
+}
+
+void ContinuousRunner::simulate()
+{
+    GameEngine engine(game, 1);
+    for (const auto &callback : generation_callbacks)
+    {
+        engine.add_generation_callback(callback);
+    }
+
+    while (running.load(std::memory_order_relaxed))
+    {
+        engine.UpdateGameState();
+        ++computed;
+
+        // Copy the field only when the renderer has taken the previous copy
+        if (!snapshots.has_pending())
+        {
+            Snapshot &snapshot = snapshots.write_buffer();
+            snapshot.field = game.get_packed_field();
+            snapshot.generation = game.get_count_of_iterations();
+            snapshots.publish();
+        }
+    }
+}
+
+void ContinuousRunner::render_frames(const std::function<void(const PackedField &, int)> &render)
+{
+    const auto frame_time = std::chrono::microseconds(1000000 / fps);
+    auto next_frame = std::chrono::steady_clock::now();
+
+    while (running.load(std::memory_order_relaxed))
+    {
+        next_frame += frame_time;
+        std::this_thread::sleep_until(next_frame);
+
+        if (snapshots.acquire())
+        {
+            const Snapshot &snapshot = snapshots.read_buffer();
+            render(snapshot.field, snapshot.generation);
+        }
+
+        // Do not try to catch up after a slow frame
+        next_frame = std::max(next_frame, std::chrono::steady_clock::now());
+    }
+}
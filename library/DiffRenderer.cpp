@@ -0,0 +1,164 @@
+#include "GameOfLife.hpp"
+
+// Constructor: remembers the terminal to draw on
+DiffRenderer::DiffRenderer(int fd) : fd(fd), last(), has_last(false), frame() {}
+
+void DiffRenderer::draw(const PackedField &field)
+{
+    build_full(field);
+    flush();
+}
+
+void DiffRenderer::update(const PackedField &field, int lines_below)
+{
+    build_update(field, lines_below);
+    flush();
+}
+
+const std::string &DiffRenderer::build_full(const PackedField &field)
+{
+    int size = field.get_size();
+    frame.clear();
+    frame.reserve(static_cast<size_t>(size) * (2 * size + 1));
+
+    for (int row = 0; row < size; ++row)
+    {
+        for (int col = 0; col < size; ++col)
+        {
+            frame += field.get(row, col) ? 'O' : '.';
+            frame += ' ';
+        }
+        frame += '\n';
+    }
+
+    last = field;
+    has_last = true;
+    return frame;
+}
+
+const std::string &DiffRenderer::build_update(const PackedField &field, int lines_below)
+{
+    if (!has_last || last.get_size() != field.get_size())
+    {
+        // Nothing to compare with: clear the old lines and draw everything
+        std::string clear;
+        for (int i = 0; i < lines_below + (has_last ? last.get_size() : 0); ++i)
+        {
+            clear += "\033[F\033[K";
+        }
+        build_full(field);
+        frame.insert(0, clear);
+        return frame;
+    }
+
+    int size = field.get_size();
+    int stride = field.get_stride();
+    const PackedWords &now = field.get_words();
+    const PackedWords &before = last.get_words();
+
+    frame.clear();
+
+    // Erase the lines typed below the field
+    for (int i = 0; i < lines_below; ++i)
+    {
+        frame += "\033[F\033[K";
+    }
+
+    int cursor_row = size; // The cursor is on the line below the field
+    for (int row = 0; row < size; ++row)
+    {
+        size_t base = static_cast<size_t>(row) * stride;
+
+        int changed = 0;
+        for (int w = 0; w < stride; ++w)
+        {
+            changed += std::popcount(now[base + w] ^ before[base + w]);
+        }
+        if (changed == 0)
+        {
+            continue;
+        }
+
+        if (row < cursor_row)
+        {
+            append_escape(cursor_row - row, 'A');
+        }
+        else
+        {
+            append_escape(row - cursor_row, 'B');
+        }
+        cursor_row = row;
+
+        if (changed * 4 > size)
+        {
+            // Many changes: rewriting the row is shorter than positioning
+            frame += '\r';
+            for (int col = 0; col < size; ++col)
+            {
+                frame += ((now[base + (col >> 6)] >> (col & 63)) & 1) ? 'O' : '.';
+                frame += ' ';
+            }
+            continue;
+        }
+
+        int next_col = -1; // Column the cursor is at after the last written cell
+        for (int w = 0; w < stride; ++w)
+        {
+            for (uint64_t diff = now[base + w] ^ before[base + w]; diff != 0; diff &= diff - 1)
+            {
+                int col = w * 64 + std::countr_zero(diff);
+                if (col != next_col)
+                {
+                    append_escape(2 * col + 1, 'G');
+                }
+                frame += ((now[base + w] >> (col & 63)) & 1) ? "O " : ". ";
+                next_col = col + 1;
+            }
+        }
+    }
+
+    append_escape(size - cursor_row, 'B');
+    frame += '\r';
+
+    last = field;
+    return frame;
+}
+
+void DiffRenderer::append_escape(int count, char code)
+{
+    // A zero count means "one" for the cursor movement sequences
+    if (count <= 0 && code != 'G')
+    {
+        return;
+    }
+
+    char buffer[16];
+    buffer[0] = '\033';
+    buffer[1] = '[';
+    char *end = std::to_chars(buffer + 2, buffer + sizeof(buffer) - 1, count).ptr;
+    *end++ = code;
+    frame.append(buffer, end);
+}
+
+void DiffRenderer::flush()
+{
+    // Text written through std::cout must appear before the frame
+    std::cout.flush();
+
+    const char *data = frame.data();
+    size_t left = frame.size();
+    while (left > 0)
+    {
+        ssize_t written = ::write(fd, data, left);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw std::runtime_error("It couldn't write to the terminal.");
+        }
+        data += written;
+        left -= written;
+    }
+}
@@ -0,0 +1,129 @@
+# Turns the .live files of the bundled games and of the pattern catalogue into
+# a header of constexpr cell lists for PatternLibrary.cpp.
+#
+# Usage: cmake -DGAMES_DIR=<dir> -DPATTERNS_DIR=<dir> -DOUTPUT=<header> -P EmbedPatterns.cmake
+#
+# Only two-state rules are embedded; the files are checked here, so a broken
+# pattern fails the build instead of a load at run time.
+
+cmake_minimum_required(VERSION 3.5 FATAL_ERROR)
+cmake_policy(SET CMP0057 NEW)
+
+file(GLOB GAME_FILES ${GAMES_DIR}/*.live)
+file(GLOB CATALOGUE_FILES ${PATTERNS_DIR}/*.live)
+list(SORT GAME_FILES)
+list(SORT CATALOGUE_FILES)
+
+set(DATA "")
+set(TABLE "")
+set(NAMES "")
+set(INDEX 0)
+
+foreach(FILE ${GAME_FILES} ${CATALOGUE_FILES})
+    get_filename_component(NAME ${FILE} NAME_WE)
+    if(NOT NAME MATCHES "^[a-z0-9-]+$")
+        message(FATAL_ERROR "${FILE}: pattern names have lowercase letters, digits and dashes only")
+    endif()
+    if(NAME IN_LIST NAMES)
+        message(FATAL_ERROR "${FILE}: there is already a pattern named ${NAME}")
+    endif()
+    list(APPEND NAMES ${NAME})
+
+    set(VERSION "1.0")
+    set(TITLE "Default")
+    set(SIZE 0)
+    set(BIRTHS 0)
+    set(SURVIVALS 0)
+    set(RULE_FOUND FALSE)
+    set(CELLS "")
+    set(COUNT 0)
+
+    file(STRINGS ${FILE} LINES)
+    foreach(LINE ${LINES})
+        if(LINE MATCHES "^#Life (.*)$")
+            set(VERSION "${CMAKE_MATCH_1}")
+        elseif(LINE MATCHES "^#N (.*)$")
+            set(TITLE "${CMAKE_MATCH_1}")
+            string(REPLACE "\\" "\\\\" TITLE "${TITLE}")
+            string(REPLACE "\"" "\\\"" TITLE "${TITLE}")
+        elseif(LINE MATCHES "^#Size ([0-9]+)")
+            set(SIZE ${CMAKE_MATCH_1})
+        elseif(LINE MATCHES "^#R B([0-8]*)/S([0-8]*)$")
+            set(RULE_FOUND TRUE)
+            foreach(PART BIRTHS SURVIVALS)
+                if(PART STREQUAL "BIRTHS")
+                    set(DIGITS "${CMAKE_MATCH_1}")
+                else()
+                    set(DIGITS "${CMAKE_MATCH_2}")
+                endif()
+                string(LENGTH "${DIGITS}" LENGTH)
+                set(MASK 0)
+                if(LENGTH GREATER 0)
+                    math(EXPR LAST "${LENGTH} - 1")
+                    foreach(I RANGE ${LAST})
+                        string(SUBSTRING "${DIGITS}" ${I} 1 DIGIT)
+                        math(EXPR MASK "${MASK} | (1 << ${DIGIT})")
+                    endforeach()
+                endif()
+                set(${PART} ${MASK})
+            endforeach()
+        elseif(LINE MATCHES "^#")
+            message(FATAL_ERROR "${FILE}: unsupported line for an embedded pattern: ${LINE}")
+        elseif(LINE MATCHES "^[ \t]*$")
+        else()
+            string(REGEX MATCHALL "-?[0-9]+" NUMBERS "${LINE}")
+            list(LENGTH NUMBERS NUMBER_COUNT)
+            math(EXPR ODD "${NUMBER_COUNT} % 2")
+            if(NUMBER_COUNT EQUAL 0 OR ODD)
+                message(FATAL_ERROR "${FILE}: invalid coordinates: ${LINE}")
+            endif()
+            math(EXPR LAST "${NUMBER_COUNT} - 1")
+            foreach(I RANGE 0 ${LAST} 2)
+                math(EXPR J "${I} + 1")
+                list(GET NUMBERS ${I} ROW)
+                list(GET NUMBERS ${J} COL)
+                if(ROW LESS 1 OR COL LESS 1 OR ROW GREATER SIZE OR COL GREATER SIZE)
+                    message(FATAL_ERROR "${FILE}: cell ${ROW} ${COL} lies outside the field of size ${SIZE}")
+                endif()
+                math(EXPR ROW "${ROW} - 1")
+                math(EXPR COL "${COL} - 1")
+                string(APPEND CELLS "{${ROW}, ${COL}}, ")
+                math(EXPR COUNT "${COUNT} + 1")
+            endforeach()
+        endif()
+    endforeach()
+
+    if(SIZE EQUAL 0 OR NOT RULE_FOUND)
+        message(FATAL_ERROR "${FILE}: an embedded pattern needs #Size and a #R B.../S... rule")
+    endif()
+    if(COUNT EQUAL 0)
+        set(CELLS_TYPE "std::array<std::array<int, 2>, 0>")
+        set(CELLS_INIT "{}")
+    else()
+        string(REGEX REPLACE ", $" "" CELLS "${CELLS}")
+        set(CELLS_TYPE "std::array<std::array<int, 2>, ${COUNT}>")
+        set(CELLS_INIT "{{${CELLS}}}")
+    endif()
+
+    if(FILE IN_LIST GAME_FILES)
+        set(IS_GAME true)
+    else()
+        set(IS_GAME false)
+    endif()
+
+    string(APPEND DATA "    // ${NAME}.live\n")
+    string(APPEND DATA "    constexpr ${CELLS_TYPE} cells_${INDEX}${CELLS_INIT};\n")
+    string(APPEND DATA "    constexpr auto words_${INDEX} = PatternLibrary::pack<${SIZE}>(cells_${INDEX});\n\n")
+    string(APPEND TABLE "        {\"${NAME}\", \"${TITLE}\", \"${VERSION}\", ${IS_GAME}, ${SIZE}, ${BIRTHS}, ${SURVIVALS}, words_${INDEX}},\n")
+    math(EXPR INDEX "${INDEX} + 1")
+endforeach()
+
+if(INDEX EQUAL 0)
+    message(FATAL_ERROR "No patterns found in ${GAMES_DIR} and ${PATTERNS_DIR}")
+endif()
+
+set(HEADER "// Generated by EmbedPatterns.cmake from the .live files of the games and patterns directories, do not edit.\n\n")
+string(APPEND HEADER "namespace\n{\n${DATA}")
+string(APPEND HEADER "    constexpr PatternLibrary::Pattern PATTERNS[] = {\n${TABLE}    };\n}\n")
+
+file(WRITE ${OUTPUT} "${HEADER}")
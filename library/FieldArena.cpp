@@ -0,0 +1,161 @@
+#include "GameOfLife.hpp"
+
+FieldArena &FieldArena::instance()
+{
+    static FieldArena arena;
+    return arena;
+}
+
+FieldArena::~FieldArena()
+{
+    release_cache();
+}
+
+void *FieldArena::allocate(size_t bytes)
+{
+    size_t block_size = size_class(bytes);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = cache.find(block_size);
+        if (found != cache.end())
+        {
+            void *block = found->second;
+            cache.erase(found);
+            stats.cached_bytes -= block_size;
+            ++stats.reuses;
+            return block;
+        }
+    }
+    return map_block(block_size);
+}
+
+void FieldArena::deallocate(void *block, size_t bytes)
+{
+    if (block == nullptr)
+    {
+        return;
+    }
+
+    size_t block_size = size_class(bytes);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stats.cached_bytes + block_size <= CACHE_LIMIT)
+        {
+            cache.emplace(block_size, block);
+            stats.cached_bytes += block_size;
+            return;
+        }
+    }
+    unmap_block(block, block_size);
+}
+
+void FieldArena::set_huge_pages(HugePages policy)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    huge_pages = policy;
+}
+
+void FieldArena::release_cache()
+{
+    std::multimap<size_t, void *> released;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        released.swap(cache);
+        stats.cached_bytes = 0;
+    }
+    for (const auto &[block_size, block] : released)
+    {
+        unmap_block(block, block_size);
+    }
+}
+
+FieldArena::Stats FieldArena::get_stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+// Small blocks are rounded to cache lines, large ones to whole huge pages
+size_t FieldArena::size_class(size_t bytes)
+{
+    if (bytes >= HUGE_PAGE)
+    {
+        return (bytes + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+    }
+    return std::max(CACHE_LINE, (bytes + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE);
+}
+
+void *FieldArena::map_block(size_t bytes)
+{
+    HugePages policy;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        policy = huge_pages;
+        ++stats.allocations;
+    }
+
+    if (bytes < HUGE_PAGE)
+    {
+        void *block = std::aligned_alloc(CACHE_LINE, bytes);
+        if (block == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        return block;
+    }
+
+    if (policy == HugePages::EXPLICIT)
+    {
+        // Fails unless huge pages were reserved, e.g. in /proc/sys/vm/nr_hugepages
+        void *block = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (block != MAP_FAILED)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++stats.huge_tlb_blocks;
+            return block;
+        }
+    }
+
+    // Map one huge page more and trim, so that the block starts on a huge page boundary
+    size_t mapped = policy == HugePages::NONE ? bytes : bytes + HUGE_PAGE;
+    void *region = ::mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED)
+    {
+        throw std::bad_alloc();
+    }
+    if (policy == HugePages::NONE)
+    {
+        return region;
+    }
+
+    uintptr_t start = reinterpret_cast<uintptr_t>(region);
+    uintptr_t aligned = (start + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+    if (aligned > start)
+    {
+        ::munmap(region, aligned - start);
+    }
+    if (aligned + bytes < start + mapped)
+    {
+        ::munmap(reinterpret_cast<void *>(aligned + bytes), start + mapped - aligned - bytes);
+    }
+
+    void *block = reinterpret_cast<void *>(aligned);
+    if (::madvise(block, bytes, MADV_HUGEPAGE) == 0)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.advised_blocks;
+    }
+    return block;
+}
+
+void FieldArena::unmap_block(void *block, size_t bytes)
+{
+    if (bytes < HUGE_PAGE)
+    {
+        std::free(block);
+    }
+    else
+    {
+        ::munmap(block, bytes);
+    }
+}
@@ -0,0 +1,146 @@
+#include "GameOfLife.hpp"
+
+namespace
+{
+    // Reverses the bits of every byte: packed rows start with the lowest bit,
+    // PBM rows start with the highest one
+    struct ReversedBytes
+    {
+        uint8_t table[256];
+
+        ReversedBytes()
+        {
+            for (int value = 0; value < 256; ++value)
+            {
+                uint8_t reversed = 0;
+                for (int bit = 0; bit < 8; ++bit)
+                {
+                    if (value & (1 << bit))
+                    {
+                        reversed |= 0x80 >> bit;
+                    }
+                }
+                table[value] = reversed;
+            }
+        }
+    };
+
+    const ReversedBytes REVERSED;
+}
+
+// Constructor: chooses the image format and the downscaling factor
+FrameExporter::FrameExporter(int scale, bool grayscale)
+    : scale(scale), grayscale(grayscale), frame()
+{
+    if (scale <= 0)
+    {
+        throw std::invalid_argument("Scale must be a positive integer.");
+    }
+}
+
+const std::string &FrameExporter::encode(const PackedField &field)
+{
+    int size = field.get_size();
+    int width = (size + scale - 1) / scale;
+
+    frame.clear();
+    frame += grayscale ? "P5\n" : "P4\n";
+    frame += std::to_string(width) + " " + std::to_string(width) + "\n";
+    if (grayscale)
+    {
+        frame += "255\n";
+    }
+
+    if (!grayscale && scale == 1)
+    {
+        // Copy the packed rows byte by byte, only reversing the bit order
+        int row_bytes = (size + 7) / 8;
+        const PackedWords &words = field.get_words();
+        size_t offset = frame.size();
+        frame.resize(offset + static_cast<size_t>(row_bytes) * size);
+
+        for (int row = 0; row < size; ++row)
+        {
+            const uint64_t *cells = &words[static_cast<size_t>(row) * field.get_stride()];
+            char *out = &frame[offset + static_cast<size_t>(row) * row_bytes];
+            for (int b = 0; b < row_bytes; ++b)
+            {
+                out[b] = static_cast<char>(REVERSED.table[(cells[b >> 3] >> (8 * (b & 7))) & 0xFF]);
+            }
+        }
+        return frame;
+    }
+
+    // Every pixel pools a scale x scale block of cells
+    int row_bytes = grayscale ? width : (width + 7) / 8;
+    size_t offset = frame.size();
+    frame.resize(offset + static_cast<size_t>(row_bytes) * width, 0);
+    std::vector<int> counts(width);
+
+    for (int y = 0; y < width; ++y)
+    {
+        std::fill(counts.begin(), counts.end(), 0);
+        int rows = std::min(scale, size - y * scale);
+        for (int r = 0; r < rows; ++r)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                int col = x * scale;
+                counts[x] += field.count_range(y * scale + r, col, std::min(scale, size - col));
+            }
+        }
+
+        char *out = &frame[offset + static_cast<size_t>(y) * row_bytes];
+        for (int x = 0; x < width; ++x)
+        {
+            if (grayscale)
+            {
+                // Live cells are dark like in PBM
+                int cells = rows * std::min(scale, size - x * scale);
+                out[x] = static_cast<char>(255 - counts[x] * 255 / cells);
+            }
+            else if (counts[x] > 0)
+            {
+                out[x >> 3] = static_cast<char>(out[x >> 3] | (0x80 >> (x & 7)));
+            }
+        }
+    }
+    return frame;
+}
+
+void FrameExporter::write_to_file(const PackedField &field, const std::string &file_name)
+{
+    std::ofstream file(file_name, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("It couldn't open file for write: " + file_name);
+    }
+
+    const std::string &data = encode(field);
+    file.write(data.data(), data.size());
+    if (!file)
+    {
+        throw std::runtime_error("It couldn't write to file: " + file_name);
+    }
+}
+
+void FrameExporter::write_to_fd(const PackedField &field, int fd)
+{
+    const std::string &data = encode(field);
+    const char *position = data.data();
+    size_t left = data.size();
+    while (left > 0)
+    {
+        ssize_t written = ::write(fd, position, left);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw std::runtime_error("It couldn't write the frame.");
+        }
+        position += written;
+        left -= written;
+    }
+}
@@ -3,55 +3,400 @@
 // Constructor: Initializes the game engine with a reference to the GameState object
 GameEngine::GameEngine(GameState &ReceivedGameState, int iterations)
     : CurrentGameState(ReceivedGameState),
-      received_number_of_iterations(iterations)
+      received_number_of_iterations(iterations),
+      next_field(&own_buffer),
+      cancel_flag(nullptr)
+{
+}
+
+// Constructor: Uses a scratch field owned by the caller
+GameEngine::GameEngine(GameState &ReceivedGameState, int iterations, PackedField &buffer)
+    : CurrentGameState(ReceivedGameState),
+      received_number_of_iterations(iterations),
+      next_field(&buffer),
+      cancel_flag(nullptr)
 {
 }
 
 // Updates the field based on the rules of the game
 void GameEngine::UpdateGameState()
 {
+    TraceZone zone("GameEngine::UpdateGameState");
+    std::array<bool, 9> births;
+    std::array<bool, 9> survivals;
+    prepare(births, survivals);
+    if (run_fixed(births, survivals) || run_adaptive(births, survivals))
+    {
+        return;
+    }
 
-    int rows = CurrentGameState.get_size();
-    int cols = CurrentGameState.get_size();
+    for (int i = 0; i < received_number_of_iterations && !is_cancelled(); ++i)
+    {
+        advance(births, survivals);
+    }
+}
+
+Generator<const PackedField &> GameEngine::generations()
+{
+    std::array<bool, 9> births;
+    std::array<bool, 9> survivals;
+    prepare(births, survivals);
 
     for (int i = 0; i < received_number_of_iterations; ++i)
     {
+        advance(births, survivals);
+        co_yield CurrentGameState.get_packed_field();
+    }
+}
+
+void GameEngine::prepare(std::array<bool, 9> &births, std::array<bool, 9> &survivals)
+{
+    int size = CurrentGameState.get_size();
+    if (CurrentGameState.get_packed_field().get_size() != size)
+    {
+        // A field without any live cell has no storage yet
+        CurrentGameState.set_field(PackedField(size));
+    }
+
+    get_rule_tables(CurrentGameState, births, survivals);
+}
+
+void GameEngine::advance(const std::array<bool, 9> &births, const std::array<bool, 9> &survivals)
+{
+    // The next generation goes to the scratch field, which is only reallocated when the size changes
+    int size = CurrentGameState.get_size();
+    if (next_field->get_size() != size)
+    {
+        *next_field = PackedField(size);
+    }
 
-        // Create a copy of the field to store the updated state
+    {
+        TraceZone zone("step", CurrentGameState.get_count_of_iterations() + 1);
+        if (CurrentGameState.get_state_count() > 2)
+        {
+            // Dying cells need a byte per cell; the packed field keeps the alive ones for everything else
+            CurrentGameState.allocate_cell_states();
+            next_states.resize(static_cast<size_t>(size) * size);
+            step_states(CurrentGameState.get_cell_states(), next_states, size, CurrentGameState.get_state_count(),
+                        births, survivals, column_sums);
+            pack_alive(next_states, *next_field);
+            CurrentGameState.swap_cells(*next_field, next_states);
+        }
+        else
+        {
+            step(CurrentGameState.get_packed_field(), *next_field, births, survivals);
+            CurrentGameState.swap_field(*next_field); // Return the updated field
+        }
+    }
+    CurrentGameState.set_count_of_iterations(CurrentGameState.get_count_of_iterations() + 1);
 
-        Field currentField = CurrentGameState.get_field();
-        Field newField = currentField;
+    // Notify observers about the finished generation
+    for (const auto &callback : generation_callbacks)
+    {
+        TraceZone zone("observer", CurrentGameState.get_count_of_iterations());
+        callback(CurrentGameState);
+    }
+}
 
-        // Retrieve birth and survival conditions from the game state
-        std::set<int> B_conditions = CurrentGameState.get_B_conditions();
-        std::set<int> S_conditions = CurrentGameState.get_S_conditions();
+namespace
+{
+    template <typename Rule>
+    bool run_fixed_size(const PackedField &current, PackedField &next, int iterations)
+    {
+        auto run = [&](auto universe)
+        {
+            universe.run(iterations);
+            universe.to_field(next);
+            return true;
+        };
+        switch (current.get_size())
+        {
+        case 16:
+            return run(FixedUniverse<16, Rule>(current));
+        case 32:
+            return run(FixedUniverse<32, Rule>(current));
+        case 64:
+            return run(FixedUniverse<64, Rule>(current));
+        default:
+            return false;
+        }
+    }
 
-        // Iterate through each cell in the field
-        for (int x = 0; x < rows; ++x)
+    template <typename Rule>
+    bool is_rule(const std::array<bool, 9> &births, const std::array<bool, 9> &survivals)
+    {
+        for (int n = 0; n <= 8; ++n)
         {
-            for (int y = 0; y < cols; ++y)
+            if (births[n] != (((Rule::births >> n) & 1) != 0) || survivals[n] != (((Rule::survivals >> n) & 1) != 0))
             {
-                // Count the number of alive neighbors
-                int neighbors = countNeighbors(currentField, x, y);
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+bool GameEngine::run_fixed(const std::array<bool, 9> &births, const std::array<bool, 9> &survivals)
+{
+    // All generations run in one go, which can neither be observed nor cancelled in between
+    if (!generation_callbacks.empty() || cancel_flag != nullptr || CurrentGameState.get_state_count() > 2)
+    {
+        return false;
+    }
+
+    const PackedField &current = CurrentGameState.get_packed_field();
+    int iterations = received_number_of_iterations;
+    int64_t started = Tracer::is_enabled() ? Tracer::now() : 0;
+    bool ran = false;
+    if (is_rule<ConwayRule>(births, survivals))
+    {
+        ran = run_fixed_size<ConwayRule>(current, *next_field, iterations);
+    }
+    else if (is_rule<HighLifeRule>(births, survivals))
+    {
+        ran = run_fixed_size<HighLifeRule>(current, *next_field, iterations);
+    }
+    if (!ran)
+    {
+        return false;
+    }
+    if (started != 0)
+    {
+        Tracer::instance().record("step fixed", started, Tracer::now(), -1);
+    }
+
+    CurrentGameState.swap_field(*next_field);
+    CurrentGameState.set_count_of_iterations(CurrentGameState.get_count_of_iterations() + iterations);
+    return true;
+}
+
+namespace
+{
+    std::string describe_occupancy(size_t occupied, size_t capacity, int generation, const char *comparison,
+                                   double threshold)
+    {
+        std::ostringstream text;
+        text.setf(std::ios::fixed);
+        text.precision(1);
+        text << occupied << " of " << capacity << " tiles occupied at generation " << generation << ", "
+             << comparison << " " << 100 * threshold << "%";
+        return text.str();
+    }
+}
 
-                // Determine the new state based on the current state and conditions
-                if (currentField[x][y]) // Cell is currently alive
+bool GameEngine::run_adaptive(const std::array<bool, 9> &births, const std::array<bool, 9> &survivals)
+{
+    int size = CurrentGameState.get_size();
+    if (!generation_callbacks.empty() || CurrentGameState.get_state_count() > 2 || size < STORAGE_MIN_SIZE)
+    {
+        return false;
+    }
+    if (births[0])
+    {
+        // Every empty tile changes, not only the tiles next to live cells
+        return false;
+    }
+
+    SparseField sparse;
+    SparseField next_sparse;
+    bool is_sparse = false;
+    auto to_sparse = [&]
+    {
+        sparse = SparseField(CurrentGameState.get_packed_field());
+        // The packed buffers go back to the arena while the field is sparse
+        CurrentGameState.set_field(PackedField());
+        *next_field = PackedField();
+        is_sparse = true;
+    };
+    auto to_dense = [&]
+    {
+        PackedField dense(size);
+        sparse.to_packed(dense);
+        CurrentGameState.swap_field(dense);
+        sparse = SparseField();
+        next_sparse = SparseField();
+        is_sparse = false;
+    };
+
+    if (CurrentGameState.get_storage() == GameState::Storage::SPARSE)
+    {
+        to_sparse();
+    }
+
+    for (int i = 0; i < received_number_of_iterations && !is_cancelled(); ++i)
+    {
+        if (i % STORAGE_CHECK_INTERVAL == 0)
+        {
+            int generation = CurrentGameState.get_count_of_iterations();
+            if (is_sparse)
+            {
+                double occupied = static_cast<double>(sparse.get_tile_count()) / sparse.get_tile_capacity();
+                if (occupied > DENSE_ABOVE)
                 {
-                    // Survives only if it satisfies survival conditions
-                    newField[x][y] = S_conditions.count(neighbors) > 0;
+                    CurrentGameState.set_storage(GameState::Storage::DENSE,
+                                                 describe_occupancy(sparse.get_tile_count(), sparse.get_tile_capacity(),
+                                                                    generation, "above", DENSE_ABOVE));
+                    to_dense();
                 }
-                else // Cell is currently dead
+            }
+            else
+            {
+                const PackedField &field = CurrentGameState.get_packed_field();
+                size_t tiles = SparseField::count_occupied_tiles(field);
+                size_t capacity = static_cast<size_t>(field.get_stride()) * field.get_stride();
+                if (static_cast<double>(tiles) / capacity < SPARSE_BELOW)
                 {
-                    // Becomes alive if it satisfies birth conditions
-                    newField[x][y] = B_conditions.count(neighbors) > 0;
+                    CurrentGameState.set_storage(GameState::Storage::SPARSE,
+                                                 describe_occupancy(tiles, capacity, generation, "below", SPARSE_BELOW));
+                    to_sparse();
                 }
             }
         }
 
-        CurrentGameState.set_field(newField); // Return the updated field
+        if (is_sparse)
+        {
+            TraceZone zone("step sparse", CurrentGameState.get_count_of_iterations() + 1);
+            sparse.step(next_sparse, births, survivals);
+            std::swap(sparse, next_sparse);
+            CurrentGameState.set_count_of_iterations(CurrentGameState.get_count_of_iterations() + 1);
+        }
+        else
+        {
+            advance(births, survivals);
+        }
+    }
+
+    if (is_sparse)
+    {
+        // Everything outside the engine reads the packed field; the storage stays sparse for the next run
+        PackedField dense(size);
+        sparse.to_packed(dense);
+        CurrentGameState.swap_field(dense);
+    }
+    return true;
+}
+
+void GameEngine::get_rule_tables(const GameState &state, std::array<bool, 9> &births, std::array<bool, 9> &survivals)
+{
+    births.fill(false);
+    survivals.fill(false);
+    for (int condition : state.get_B_conditions())
+    {
+        if (condition >= 0 && condition <= 8)
+        {
+            births[condition] = true;
+        }
+    }
+    for (int condition : state.get_S_conditions())
+    {
+        if (condition >= 0 && condition <= 8)
+        {
+            survivals[condition] = true;
+        }
+    }
+}
+
+void GameEngine::step(const PackedField &current, PackedField &next,
+                      const std::array<bool, 9> &births, const std::array<bool, 9> &survivals)
+{
+    int size = current.get_size();
+    int stride = current.get_stride();
+    const uint64_t *cells = current.get_words().data();
+    uint64_t *out = next.get_words().data();
+
+    for (int r = 0; r < size; ++r)
+    {
+        const uint64_t *up = cells + static_cast<size_t>((r + size - 1) % size) * stride;
+        const uint64_t *mid = cells + static_cast<size_t>(r) * stride;
+        const uint64_t *down = cells + static_cast<size_t>((r + 1) % size) * stride;
+        step_row(up, mid, down, out + static_cast<size_t>(r) * stride, size, births, survivals);
+    }
+}
+
+void GameEngine::step_row(const uint64_t *up, const uint64_t *mid, const uint64_t *down, uint64_t *result, int size,
+                          const std::array<bool, 9> &births, const std::array<bool, 9> &survivals)
+{
+    int stride = (size + 63) / 64;
+    int last = stride - 1;
+    int last_bit = (size - 1) & 63;
+    uint64_t last_mask = last_bit == 63 ? ~uint64_t(0) : (uint64_t(2) << last_bit) - 1;
+    RuleCounts rule = get_rule_counts(births, survivals);
+
+    // Neighbors on the left and on the right of 64 cells, wrapping around the row
+    auto west = [&](const uint64_t *row, int w)
+    {
+        uint64_t carry = w > 0 ? row[w - 1] >> 63 : (row[last] >> last_bit) & 1;
+        return (row[w] << 1) | carry;
+    };
+    auto east = [&](const uint64_t *row, int w)
+    {
+        uint64_t carry = w < last ? row[w + 1] << 63 : (row[0] & 1) << last_bit;
+        return (row[w] >> 1) | carry;
+    };
+
+    for (int w = 0; w < stride; ++w)
+    {
+        result[w] = step_word(west(up, w), up[w], east(up, w), west(mid, w), east(mid, w), west(down, w), down[w],
+                              east(down, w), mid[w], rule);
+    }
+    if (size > 0)
+    {
+        result[last] &= last_mask;
+    }
+}
+
+GameEngine::RuleCounts GameEngine::get_rule_counts(const std::array<bool, 9> &births,
+                                                   const std::array<bool, 9> &survivals)
+{
+    RuleCounts rule{births, survivals, {}, 0};
+    for (int n = 0; n <= 8; ++n)
+    {
+        if (births[n] || survivals[n])
+        {
+            rule.counts[rule.count_total++] = n;
+        }
+    }
+    return rule;
+}
+
+uint64_t GameEngine::step_word(uint64_t a, uint64_t b, uint64_t c, uint64_t d, uint64_t e, uint64_t f, uint64_t g,
+                               uint64_t h, uint64_t alive, const RuleCounts &rule)
+{
+    // Carry-save adders: ones, twos, fours and eights of the neighbor count
+    uint64_t s0 = a ^ b ^ c, c0 = (a & b) | (c & (a ^ b));
+    uint64_t s1 = d ^ e ^ f, c1 = (d & e) | (f & (d ^ e));
+    uint64_t s2 = g ^ h, c2 = g & h;
+    uint64_t ones = s0 ^ s1 ^ s2, c3 = (s0 & s1) | (s2 & (s0 ^ s1));
+    uint64_t t0 = c0 ^ c1 ^ c2, k0 = (c0 & c1) | (c2 & (c0 ^ c1));
+    uint64_t twos = t0 ^ c3, k1 = t0 & c3;
+    uint64_t fours = k0 ^ k1, eights = k0 & k1;
+
+    // Only the neighbor counts named by the rule are compared
+    uint64_t born = 0, survive = 0;
+    for (int i = 0; i < rule.count_total; ++i)
+    {
+        int n = rule.counts[i];
+        uint64_t equal = (n & 1 ? ones : ~ones) & (n & 2 ? twos : ~twos) &
+                         (n & 4 ? fours : ~fours) & (n & 8 ? eights : ~eights);
+        born |= rule.births[n] ? equal : 0;
+        survive |= rule.survivals[n] ? equal : 0;
     }
-    CurrentGameState.set_count_of_iterations(
-        CurrentGameState.get_count_of_iterations() + received_number_of_iterations);
+    return (born & ~alive) | (survive & alive);
+}
+
+void GameEngine::add_generation_callback(const std::function<void(const GameState &)> &callback)
+{
+    generation_callbacks.push_back(callback);
+}
+
+void GameEngine::set_cancel_flag(const std::atomic<bool> *flag)
+{
+    cancel_flag = flag;
+}
+
+bool GameEngine::is_cancelled() const
+{
+    return cancel_flag != nullptr && cancel_flag->load(std::memory_order_relaxed);
 }
 
 // Counts the number of alive neighbors for the cell at (x, y)
@@ -79,3 +424,84 @@ int GameEngine::countNeighbors(const Field &field, int x, int y)
 
     return count;
 }
+
+void GameEngine::step_states(const std::vector<uint8_t> &current, std::vector<uint8_t> &next, int size, int state_count,
+                             const std::array<bool, 9> &births, const std::array<bool, 9> &survivals,
+                             std::vector<uint8_t> &sums)
+{
+    // Every count is compared with the neighbors of every cell instead of a table lookup, which would not vectorize
+    uint8_t born[9];
+    uint8_t kept[9];
+    for (int n = 0; n <= 8; ++n)
+    {
+        born[n] = births[n] ? 1 : 0;
+        kept[n] = survivals[n] ? 1 : 0;
+    }
+    uint8_t last_state = static_cast<uint8_t>(state_count - 1);
+
+    sums.resize(static_cast<size_t>(size) + 2);
+    uint8_t *sum = sums.data();
+    for (int r = 0; r < size; ++r)
+    {
+        const uint8_t *up = &current[static_cast<size_t>((r + size - 1) % size) * size];
+        const uint8_t *mid = &current[static_cast<size_t>(r) * size];
+        const uint8_t *down = &current[static_cast<size_t>((r + 1) % size) * size];
+        uint8_t *out = &next[static_cast<size_t>(r) * size];
+
+        // Alive cells of the three rows per column, with the column of the other edge on both sides
+        for (int c = 0; c < size; ++c)
+        {
+            sum[c + 1] = static_cast<uint8_t>((up[c] == 1) + (mid[c] == 1) + (down[c] == 1));
+        }
+        sum[0] = sum[size];
+        sum[size + 1] = sum[1];
+
+        for (int c = 0; c < size; ++c)
+        {
+            uint8_t state = mid[c];
+            uint8_t alive = state == 1;
+            uint8_t neighbors = static_cast<uint8_t>(sum[c] + sum[c + 1] + sum[c + 2] - alive);
+
+            uint8_t birth = 0;
+            uint8_t survival = 0;
+            for (int n = 0; n <= 8; ++n)
+            {
+                uint8_t match = neighbors == n;
+                birth |= match & born[n];
+                survival |= match & kept[n];
+            }
+
+            // Alive cells that do not survive and dying cells move to the next state until they are dead
+            uint8_t aged = state >= last_state ? 0 : static_cast<uint8_t>(state + 1);
+            out[c] = state == 0 ? birth : (alive & survival) ? 1 : aged;
+        }
+    }
+}
+
+void GameEngine::pack_alive(const std::vector<uint8_t> &states, PackedField &field)
+{
+    int size = field.get_size();
+    int stride = field.get_stride();
+    uint64_t *words = field.get_words().data();
+    for (int row = 0; row < size; ++row)
+    {
+        const uint8_t *cells = &states[static_cast<size_t>(row) * size];
+        uint64_t *out = words + static_cast<size_t>(row) * stride;
+        std::fill(out, out + stride, 0);
+
+        // Eight states at a time: bytes equal to 1 become their high bit, which a multiplication gathers into one byte
+        int col = 0;
+        for (; col + 8 <= size; col += 8)
+        {
+            uint64_t bytes;
+            std::memcpy(&bytes, cells + col, 8);
+            uint64_t other = bytes ^ 0x0101010101010101ULL;
+            uint64_t ones = ~(((other & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL) | other) & 0x8080808080808080ULL;
+            out[col >> 6] |= (((ones >> 7) * 0x0102040810204080ULL) >> 56) << (col & 63);
+        }
+        for (; col < size; ++col)
+        {
+            out[col >> 6] |= static_cast<uint64_t>(cells[col] == 1) << (col & 63);
+        }
+    }
+}
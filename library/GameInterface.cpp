@@ -1,17 +1,134 @@
 #include "GameOfLife.hpp"
 
+namespace
+{
+    volatile std::sig_atomic_t interrupted = 0; // Set by Ctrl-C during a continuous run
+
+    void handle_interrupt(int)
+    {
+        interrupted = 1;
+    }
+
+    // Loads the pattern of --pattern, or one of the bundled games, for the mode without an input file
+    void load_start_pattern(const ParserCommandLine &parser_command_line, GameState &game)
+    {
+        if (parser_command_line.get_pattern_name().empty())
+        {
+            PatternLibrary::load(PatternLibrary::random_game(), game);
+        }
+        else
+        {
+            PatternLibrary::load(parser_command_line.get_pattern_name(), game);
+        }
+    }
+}
+
 GameInterface::GameInterface(int argc, char **argv)
+    : is_it_exit(1), recorder(), is_recording(false), exit_code(EXIT_OK), renderer(),
+      viewport(), is_viewport_active(false), undo_history(), heat_map(), trace_file(),
+      queued_commands()
 {
     start_game(argc, argv);
     is_it_exit = 1;
+
+    if (!trace_file.empty())
+    {
+        try
+        {
+            Tracer::instance().write_to_file(trace_file);
+        }
+        catch (const std::runtime_error &e)
+        {
+            std::cerr << "Error: " << e.what() << "\n";
+            exit_code = exit_code == EXIT_OK ? EXIT_OUTPUT_ERROR : exit_code;
+        }
+    }
 }
 
 void GameInterface::start_game(int argc, char **argv)
 {
     GameState game;
-    ParserCommandLine parser_command_line(argc, argv);
+    std::optional<ParserCommandLine> parsed_command_line;
+    try
+    {
+        parsed_command_line.emplace(argc, argv);
+    }
+    catch (const std::invalid_argument &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        exit_code = EXIT_USAGE_ERROR;
+        return;
+    }
+    ParserCommandLine &parser_command_line = *parsed_command_line;
+
+    trace_file = parser_command_line.get_trace_file();
+    if (!trace_file.empty())
+    {
+        Tracer::instance().set_enabled(true);
+        Tracer::instance().set_thread_name("main");
+    }
 
     char mode = parser_command_line.get_mode();
+    FieldArena::instance().set_huge_pages(parser_command_line.get_huge_pages());
+
+    if (!parser_command_line.get_server_socket().empty())
+    {
+        exit_code = run_server(parser_command_line);
+        is_it_exit = 0;
+        return;
+    }
+
+    if (parser_command_line.is_topology_report() && mode == '2')
+    {
+        std::cout << NumaTopology().report();
+        is_it_exit = 0;
+        return;
+    }
+
+    if (mode == '4')
+    {
+        exit_code = run_batch_directory(parser_command_line);
+        is_it_exit = 0;
+        return;
+    }
+
+    if (!parser_command_line.get_store_file().empty())
+    {
+        exit_code = run_out_of_core(parser_command_line);
+        is_it_exit = 0;
+        return;
+    }
+
+    if (parser_command_line.is_quiet())
+    {
+        exit_code = run_batch(game, parser_command_line);
+        is_it_exit = 0;
+        return;
+    }
+
+    // Commands from a script or a pipe run without prompts
+    if ((mode == '1' || mode == '2') && (!parser_command_line.get_script_file().empty() || !isatty(STDIN_FILENO)))
+    {
+        if (parser_command_line.get_script_file().empty())
+        {
+            exit_code = run_script(game, parser_command_line, std::cin);
+        }
+        else
+        {
+            std::ifstream script(parser_command_line.get_script_file());
+            if (!script)
+            {
+                std::cerr << "Error: It couldn't open the script: " << parser_command_line.get_script_file() << "\n";
+                exit_code = EXIT_INPUT_ERROR;
+            }
+            else
+            {
+                exit_code = run_script(game, parser_command_line, script);
+            }
+        }
+        is_it_exit = 0;
+        return;
+    }
 
     if (mode == '1')
     {
@@ -19,7 +136,15 @@ void GameInterface::start_game(int argc, char **argv)
 
         parser_file.parse(game);
 
-        print_field(game.get_field());
+        if (!parser_command_line.get_record_file().empty())
+        {
+            start_recording(game, 32);
+        }
+
+        undo_history = UndoHistory(static_cast<size_t>(parser_command_line.get_undo_budget()) << 20);
+        undo_history.reset(game);
+
+        show_field(game);
 
         while (is_it_exit)
         {
@@ -45,20 +170,17 @@ void GameInterface::start_game(int argc, char **argv)
     }
     else if (mode == '2')
     {
-        const std::string filenames[] = {"games/game1.live", "games/game2.live", "games/game3.live", "games/game4.live", "games/game5.live"};
-
-        std::random_device rd;
-        std::mt19937 gen(rd());
-
-        std::uniform_int_distribution<> distrib(0, 4);
-        int random_number = distrib(gen);
+        load_start_pattern(parser_command_line, game);
 
-        std::string generated_file = filenames[random_number];
+        if (!parser_command_line.get_record_file().empty())
+        {
+            start_recording(game, 32);
+        }
 
-        ParserFile parser_file(generated_file);
-        parser_file.parse(game);
+        undo_history = UndoHistory(static_cast<size_t>(parser_command_line.get_undo_budget()) << 20);
+        undo_history.reset(game);
 
-        print_field(game.get_field());
+        show_field(game);
 
         while (is_it_exit)
         {
@@ -92,17 +214,581 @@ void GameInterface::start_game(int argc, char **argv)
 
         GameEngine engine(game, parser_command_line.get_iterations());
 
-        engine.UpdateGameState();
+        if (!parser_command_line.get_record_file().empty())
+        {
+            start_recording(game, 32);
+            engine.add_generation_callback([this](const GameState &state)
+                                           { recorder.record(state); });
+        }
+
+        if (!parser_command_line.get_heat_map_file().empty())
+        {
+            heat_map = std::make_unique<HeatMap>(parser_command_line.get_heat_mode(), game);
+            engine.add_generation_callback([this](const GameState &state)
+                                           { heat_map->add(state.get_packed_field()); });
+        }
+
+        if (parser_command_line.get_thread_count() > 0)
+        {
+            run_parallel(game, parser_command_line, std::cout);
+        }
+        else
+        {
+            engine.UpdateGameState();
+        }
 
         std::cout << "The field after " << parser_command_line.get_iterations() << " iterations:\n";
         print_field(game.get_field());
         save_to_file(game, parser_command_line.get_output_file());
+        if (!parser_command_line.get_census_file().empty())
+        {
+            write_census(game, parser_command_line.get_census_file());
+        }
+        if (heat_map)
+        {
+            heat_map->write_to_file(parser_command_line.get_heat_map_file());
+        }
         is_it_exit = 0;
     }
+
+    if (is_recording && !parser_command_line.get_record_file().empty())
+    {
+        recorder.save(parser_command_line.get_record_file());
+    }
+}
+
+int GameInterface::run_batch(GameState &game, ParserCommandLine &parser_command_line)
+{
+    try
+    {
+        ParserFile parser_file(parser_command_line.get_input_file());
+        parser_file.parse(game);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << parser_command_line.get_input_file() << ": " << e.what() << "\n";
+        return EXIT_INPUT_ERROR;
+    }
+
+    try
+    {
+        GameEngine engine(game, parser_command_line.get_iterations());
+
+        if (!parser_command_line.get_record_file().empty())
+        {
+            start_recording(game, 32);
+            engine.add_generation_callback([this](const GameState &state)
+                                           { recorder.record(state); });
+        }
+
+        if (!parser_command_line.get_heat_map_file().empty())
+        {
+            heat_map = std::make_unique<HeatMap>(parser_command_line.get_heat_mode(), game);
+            engine.add_generation_callback([this](const GameState &state)
+                                           { heat_map->add(state.get_packed_field()); });
+        }
+
+        int frame_interval = parser_command_line.get_frame_interval();
+        int frame_scale = parser_command_line.get_frame_scale();
+        FrameExporter exporter(frame_scale, frame_scale > 1);
+        if (frame_interval > 0)
+        {
+            exporter.write_to_fd(game.get_packed_field(), STDOUT_FILENO);
+            engine.add_generation_callback([&exporter, frame_interval](const GameState &state)
+                                           {
+                                               if (state.get_count_of_iterations() % frame_interval == 0)
+                                               {
+                                                   exporter.write_to_fd(state.get_packed_field(), STDOUT_FILENO);
+                                               } });
+        }
+
+        if (parser_command_line.get_thread_count() > 0)
+        {
+            // Quiet runs keep stdout free, so the report goes to stderr
+            run_parallel(game, parser_command_line, std::cerr);
+        }
+        else
+        {
+            engine.UpdateGameState();
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return EXIT_RUNTIME_ERROR;
+    }
+
+    try
+    {
+        LiveFileWriter writer(parser_command_line.get_output_file());
+        writer.write(game);
+
+        if (is_recording)
+        {
+            recorder.save(parser_command_line.get_record_file());
+        }
+        if (!parser_command_line.get_census_file().empty())
+        {
+            write_census(game, parser_command_line.get_census_file());
+        }
+        if (heat_map)
+        {
+            heat_map->write_to_file(parser_command_line.get_heat_map_file());
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return EXIT_OUTPUT_ERROR;
+    }
+
+    return EXIT_OK;
+}
+
+int GameInterface::run_script(GameState &game, ParserCommandLine &parser_command_line, std::istream &script)
+{
+    if (parser_command_line.get_mode() == '1')
+    {
+        std::string input_file = parser_command_line.get_input_file();
+        try
+        {
+            ParserFile parser_file(input_file);
+            parser_file.parse(game);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error: " << input_file << ": " << e.what() << "\n";
+            return EXIT_INPUT_ERROR;
+        }
+    }
+    else
+    {
+        load_start_pattern(parser_command_line, game);
+    }
+
+    ScriptRunner runner(game, std::cout);
+    if (!parser_command_line.get_record_file().empty())
+    {
+        start_recording(game, 32);
+        runner.add_generation_callback([this](const GameState &state)
+                                       { recorder.record(state); });
+    }
+
+    try
+    {
+        runner.run(script);
+        if (is_recording)
+        {
+            recorder.save(parser_command_line.get_record_file());
+        }
+    }
+    catch (const InvalidCommandException &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return EXIT_USAGE_ERROR;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return EXIT_RUNTIME_ERROR;
+    }
+
+    return EXIT_OK;
+}
+
+int GameInterface::run_batch_directory(ParserCommandLine &parser_command_line)
+{
+    std::vector<std::string> input_files;
+    try
+    {
+        input_files = BatchRunner::find_patterns(parser_command_line.get_input_file());
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return EXIT_INPUT_ERROR;
+    }
+    if (input_files.empty())
+    {
+        std::cerr << "Error: No pattern files found: " << parser_command_line.get_input_file() << "\n";
+        return EXIT_INPUT_ERROR;
+    }
+
+    int threads = parser_command_line.get_worker_count();
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::string output_dir = parser_command_line.get_output_file();
+    std::string summary_file = (std::filesystem::path(output_dir) / "summary.csv").string();
+    BatchRunner runner(parser_command_line.get_iterations(), output_dir, threads);
+    try
+    {
+        std::filesystem::create_directories(output_dir);
+        auto started = std::chrono::steady_clock::now();
+        runner.run(input_files);
+        runner.write_summary(summary_file);
+
+        if (!parser_command_line.is_quiet())
+        {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+            std::cout << input_files.size() << " patterns in " << seconds << " s with " << threads
+                      << " threads, summary: " << summary_file << "\n";
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return EXIT_OUTPUT_ERROR;
+    }
+
+    int failed = 0;
+    for (const BatchRunner::Job &job : runner.get_jobs())
+    {
+        if (!job.error.empty())
+        {
+            std::cerr << "Error: " << job.input_file << ": " << job.error << "\n";
+            ++failed;
+        }
+    }
+    return failed == 0 ? EXIT_OK : EXIT_RUNTIME_ERROR;
+}
+
+int GameInterface::run_out_of_core(ParserCommandLine &parser_command_line)
+{
+    const std::string &store_file = parser_command_line.get_store_file();
+    try
+    {
+        OutOfCoreEngine::import_live(parser_command_line.get_input_file(), store_file);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << parser_command_line.get_input_file() << ": " << e.what() << "\n";
+        return EXIT_INPUT_ERROR;
+    }
+
+    std::optional<OutOfCoreEngine> engine;
+    try
+    {
+        engine.emplace(store_file);
+        engine->run(parser_command_line.get_iterations());
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return EXIT_RUNTIME_ERROR;
+    }
+
+    try
+    {
+        engine->export_live(parser_command_line.get_output_file());
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return EXIT_OUTPUT_ERROR;
+    }
+
+    if (!parser_command_line.is_quiet())
+    {
+        std::cout << "The field after " << parser_command_line.get_iterations() << " iterations was saved to: "
+                  << parser_command_line.get_output_file() << "\n";
+    }
+    return EXIT_OK;
+}
+
+int GameInterface::run_server(ParserCommandLine &parser_command_line)
+{
+    int workers = parser_command_line.get_worker_count();
+    if (workers == 0)
+    {
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    SimulationServer server(parser_command_line.get_server_socket(), workers);
+    try
+    {
+        server.start();
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return EXIT_OUTPUT_ERROR;
+    }
+    std::cerr << "Serving on " << parser_command_line.get_server_socket() << " with " << workers << " workers.\n";
+
+    struct sigaction action{};
+    action.sa_handler = handle_interrupt;
+    sigemptyset(&action.sa_mask);
+    interrupted = 0;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    while (!interrupted)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    server.stop();
+    return EXIT_OK;
+}
+
+int GameInterface::get_exit_code() const
+{
+    return exit_code;
+}
+
+void GameInterface::observe_generation(const GameState &game)
+{
+    undo_history.record(game);
+    if (is_recording)
+    {
+        recorder.record(game);
+    }
+    if (heat_map)
+    {
+        heat_map->add(game.get_packed_field());
+    }
+}
+
+
+void GameInterface::start_recording(const GameState &game, int keyframe_interval)
+{
+    recorder = HistoryRecorder(keyframe_interval);
+    recorder.record(game);
+    is_recording = true;
+}
+
+void GameInterface::refresh_field(const GameState &game, int lines_below)
+{
+    draw_frame(game.get_packed_field(), lines_below);
+}
+
+void GameInterface::draw_frame(const PackedField &field, int lines_below)
+{
+    TraceZone zone("draw_frame");
+    if (is_viewport_active)
+    {
+        // Viewport lines have a fixed width, so the new frame covers the old one
+        std::string frame;
+        for (int i = 0; i < lines_below; ++i)
+        {
+            frame += "\033[F\033[K";
+        }
+        frame += "\033[" + std::to_string(viewport.get_height()) + "F";
+        frame += viewport.render(field);
+        std::cout << frame << std::flush;
+    }
+    else
+    {
+        renderer.update(field, lines_below);
+    }
+}
+
+void GameInterface::run_continuously(GameState &game, int fps)
+{
+    ContinuousRunner runner(game, fps);
+    runner.add_generation_callback([this](const GameState &state)
+                                   { observe_generation(state); });
+
+    // Lines entered below the field since the last frame, starting with the run command
+    std::atomic<int> lines_below(1);
+    runner.start([this, &lines_below](const PackedField &field, int)
+                 { draw_frame(field, lines_below.exchange(0)); });
+
+    struct sigaction action{};
+    struct sigaction previous{};
+    action.sa_handler = handle_interrupt;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = 0; // No SA_RESTART: Ctrl-C must wake up the poll below
+    interrupted = 0;
+    sigaction(SIGINT, &action, &previous);
+
+    while (!interrupted)
+    {
+        if (std::cin.rdbuf()->in_avail() <= 0)
+        {
+            pollfd input{STDIN_FILENO, POLLIN, 0};
+            if (poll(&input, 1, 100) <= 0)
+            {
+                continue;
+            }
+        }
+
+        std::string line;
+        if (!std::getline(std::cin, line))
+        {
+            std::cin.clear();
+            break;
+        }
+        ++lines_below;
+
+        try
+        {
+            ParserCommands parser_command;
+            parser_command.parse_command(line.substr(0, line.find_last_not_of(" \t\r") + 1));
+            if (parser_command.get_command() == 'a')
+            {
+                break;
+            }
+        }
+        catch (const InvalidCommandException &)
+        {
+            // Other commands are not available while running
+        }
+    }
+
+    runner.stop();
+    sigaction(SIGINT, &previous, nullptr);
+
+    draw_frame(game.get_packed_field(), lines_below);
+    std::cout << "\033[K" << std::flush;
+}
+
+void GameInterface::run_ticks(GameState &game, int generations)
+{
+    TickRunner runner(game);
+    runner.add_generation_callback([this](const GameState &state)
+                                   { observe_generation(state); });
+    runner.start(generations);
+
+    // Short ticks finish before anything is shown
+    int lines_below = 1;
+    if (!runner.wait_for(std::chrono::milliseconds(300)))
+    {
+        struct sigaction action{};
+        struct sigaction previous{};
+        action.sa_handler = handle_interrupt;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = 0; // No SA_RESTART: Ctrl-C must wake up the poll below
+        interrupted = 0;
+        sigaction(SIGINT, &action, &previous);
+
+        while (!runner.wait_for(std::chrono::milliseconds(0)))
+        {
+            if (interrupted)
+            {
+                runner.cancel();
+            }
+            std::cout << "\r\033[K" << runner.format_progress()
+                      << (runner.is_cancelled() ? " - stopping" : " - enter stop or press Ctrl-C to cancel") << std::flush;
+
+            if (std::cin.rdbuf()->in_avail() <= 0)
+            {
+                pollfd input{STDIN_FILENO, POLLIN, 0};
+                if (poll(&input, 1, 250) <= 0)
+                {
+                    continue;
+                }
+            }
+
+            std::string line;
+            if (!std::getline(std::cin, line))
+            {
+                std::cin.clear();
+                runner.cancel();
+                continue;
+            }
+            ++lines_below;
+
+            std::string command_line = line.substr(0, line.find_last_not_of(" \t\r") + 1);
+            try
+            {
+                ParserCommands parser_command;
+                parser_command.parse_command(command_line);
+                if (parser_command.get_command() == 'a')
+                {
+                    runner.cancel();
+                    continue;
+                }
+            }
+            catch (const InvalidCommandException &)
+            {
+                // The main loop reports the error when it takes the line
+            }
+            if (!command_line.empty())
+            {
+                // Other commands run in order once the tick is over
+                queued_commands.push_back(command_line);
+            }
+        }
+        sigaction(SIGINT, &previous, nullptr);
+        std::cout << "\r\033[K" << std::flush;
+    }
+
+    try
+    {
+        runner.wait();
+    }
+    catch (const std::exception &)
+    {
+        refresh_field(game, lines_below);
+        throw;
+    }
+    refresh_field(game, lines_below);
+    if (runner.is_cancelled() && runner.get_completed() < generations)
+    {
+        std::cout << "Stopped at generation " << game.get_count_of_iterations() << " after "
+                  << runner.get_completed() << " of " << generations << " steps.\n"
+                  << "Press ENTER to continue...";
+
+        std::string input2;
+        std::getline(std::cin, input2);
+        clear_lines(2);
+    }
+}
+
+void GameInterface::show_field(const GameState &game)
+{
+    TraceZone zone("show_field");
+    int columns = 80;
+    int lines = 24;
+    winsize terminal{};
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &terminal) == 0 && terminal.ws_col > 0 && terminal.ws_row > 2)
+    {
+        columns = terminal.ws_col;
+        lines = terminal.ws_row;
+    }
+
+    // Leave room for the command line and the messages below the field
+    viewport.set_dimensions(columns, lines - 2);
+    is_viewport_active = game.get_size() * 2 > columns || game.get_size() > lines - 2;
+
+    if (is_viewport_active)
+    {
+        viewport.fit(game.get_size());
+        std::cout << viewport.render(game.get_packed_field()) << std::flush;
+    }
+    else
+    {
+        renderer.draw(game.get_packed_field());
+    }
+}
+
+void GameInterface::switch_view(const GameState &game, bool use_viewport)
+{
+    if (use_viewport == is_viewport_active)
+    {
+        refresh_field(game);
+        return;
+    }
+
+    clear_lines((is_viewport_active ? viewport.get_height() : game.get_size()) + 1);
+    is_viewport_active = use_viewport;
+    if (is_viewport_active)
+    {
+        std::cout << viewport.render(game.get_packed_field()) << std::flush;
+    }
+    else
+    {
+        renderer.draw(game.get_packed_field());
+    }
 }
 
 void GameInterface::print_field(const Field &field) const
 {
+    TraceZone zone("print_field");
 
     for (const auto &row : field)
     {
@@ -125,13 +811,7 @@ void GameInterface::game_process(GameState &game, ParserCommandLine &parser_comm
     }
     else if (command == '2')
     {
-        GameEngine engine(game, parser_command.get_iterations());
-        engine.UpdateGameState();
-        int tmp = game.get_size() + 1;
-
-        clear_lines(tmp);
-        print_field(game.get_field());
-        std::cout << "";
+        run_ticks(game, parser_command.get_iterations());
     }
 
     else if (command == '3')
@@ -144,6 +824,254 @@ void GameInterface::game_process(GameState &game, ParserCommandLine &parser_comm
     {
         print_help();
     }
+
+    else if (command == '5')
+    {
+        start_recording(game, parser_command.get_keyframe_interval());
+        std::cout << "Recording from generation " << game.get_count_of_iterations()
+                  << " with a keyframe every " << parser_command.get_keyframe_interval() << " generations.\n";
+        std::cout << "Press ENTER to continue...";
+
+        std::string input2;
+        std::getline(std::cin, input2);
+        clear_lines(3);
+    }
+
+    else if (command == '6')
+    {
+        if (!is_recording || recorder.empty())
+        {
+            throw InvalidCommandException("Nothing is recorded. Use the record command first.");
+        }
+
+        try
+        {
+            recorder.seek(parser_command.get_generation(), game);
+        }
+        catch (const std::out_of_range &)
+        {
+            throw InvalidCommandException("Only generations " + std::to_string(recorder.get_first_generation()) +
+                                          " to " + std::to_string(recorder.get_last_generation()) + " are recorded.");
+        }
+
+        undo_history.reset(game);
+        refresh_field(game);
+    }
+
+    else if (command == '7')
+    {
+        viewport.pan(parser_command.get_pan_rows(), parser_command.get_pan_cols());
+        switch_view(game, true);
+    }
+
+    else if (command == '8')
+    {
+        if (parser_command.get_zoom() > 0)
+        {
+            viewport.set_zoom(parser_command.get_zoom());
+        }
+        switch_view(game, parser_command.get_zoom() > 0);
+    }
+
+    else if (command == '9')
+    {
+        run_continuously(game, parser_command.get_frame_rate());
+    }
+
+    else if (command == 'a')
+    {
+        throw InvalidCommandException("The simulation is not running.");
+    }
+
+    else if (command == 'b')
+    {
+        const std::string &image_file = parser_command.get_filename();
+        bool grayscale = image_file.substr(image_file.size() - 4) == ".pgm";
+
+        FrameExporter exporter(parser_command.get_scale(), grayscale);
+        try
+        {
+            exporter.write_to_file(game.get_packed_field(), image_file);
+        }
+        catch (const std::runtime_error &e)
+        {
+            throw InvalidCommandException(e.what());
+        }
+
+        std::cout << "The image was saved to: " << image_file << ". Press ENTER to continue..." << "\n";
+
+        std::string input2;
+        std::getline(std::cin, input2);
+        clear_lines(3);
+    }
+
+    else if (command == 'c')
+    {
+        if (undo_history.undo(parser_command.get_undo_steps(), game) == 0)
+        {
+            throw InvalidCommandException("Nothing to undo.");
+        }
+        refresh_field(game);
+    }
+
+    else if (command == 'd')
+    {
+        try
+        {
+            undo_history.rewind(parser_command.get_generation(), game);
+        }
+        catch (const std::out_of_range &)
+        {
+            throw InvalidCommandException("Only generations " + std::to_string(undo_history.get_oldest_generation()) +
+                                          " to " + std::to_string(game.get_count_of_iterations()) + " can be restored.");
+        }
+        refresh_field(game);
+    }
+
+    else if (command == 'e')
+    {
+        GameState loaded;
+        try
+        {
+            if (parser_command.is_builtin_pattern())
+            {
+                PatternLibrary::load(parser_command.get_filename(), loaded);
+            }
+            else
+            {
+                ParserFile parser_file(parser_command.get_filename());
+                parser_file.parse(loaded);
+            }
+        }
+        catch (const std::exception &e)
+        {
+            throw InvalidCommandException(e.what());
+        }
+
+        // Erase the old field and the command line, then show the new field
+        clear_lines((is_viewport_active ? viewport.get_height() : game.get_size()) + 1);
+        game = loaded;
+        if (is_recording)
+        {
+            // The recording starts over on the new field, so --record saves the last loaded pattern
+            start_recording(game, recorder.get_keyframe_interval());
+        }
+        heat_map.reset();
+        undo_history.reset(game);
+        show_field(game);
+    }
+
+    else if (command == 'f')
+    {
+        std::cout << game.get_stats() << "\n";
+        std::cout << "Press ENTER to continue...";
+
+        std::string input2;
+        std::getline(std::cin, input2);
+        clear_lines(3);
+    }
+
+    else if (command == 'g')
+    {
+        const std::array<int, 4> &region = parser_command.get_region();
+        std::cout << game.get_region(region[0], region[1], region[2], region[3]);
+        std::cout << "Press ENTER to continue...";
+
+        std::string input2;
+        std::getline(std::cin, input2);
+        clear_lines(region[2] + 2);
+    }
+
+    else if (command == 'h')
+    {
+        Census census;
+        census.take(game.get_packed_field(), game.get_B_conditions(), game.get_S_conditions());
+        std::string report = census.format(15);
+        std::cout << report;
+        std::cout << "Press ENTER to continue...";
+
+        std::string input2;
+        std::getline(std::cin, input2);
+        clear_lines(static_cast<int>(std::count(report.begin(), report.end(), '\n')) + 1);
+    }
+
+    else if (command == 'i')
+    {
+        std::optional<HeatMap::Mode> mode = parser_command.get_heat_mode();
+        if (mode)
+        {
+            heat_map = std::make_unique<HeatMap>(*mode, game);
+            std::cout << "Counting " << (*mode == HeatMap::Mode::ALIVE ? "live cells" : "changes")
+                      << " from generation " << game.get_count_of_iterations() << ".\n";
+        }
+        else
+        {
+            heat_map.reset();
+            std::cout << "The heat map is off.\n";
+        }
+        std::cout << "Press ENTER to continue...";
+
+        std::string input2;
+        std::getline(std::cin, input2);
+        clear_lines(3);
+    }
+
+    else if (command == 'j')
+    {
+        if (!heat_map)
+        {
+            throw InvalidCommandException("Nothing is counted. Use the heat command first.");
+        }
+
+        const std::string &heat_map_file = parser_command.get_filename();
+        try
+        {
+            heat_map->write_to_file(heat_map_file);
+        }
+        catch (const std::runtime_error &e)
+        {
+            throw InvalidCommandException(e.what());
+        }
+
+        std::cout << "The heat map of " << heat_map->get_generations() << " generations was saved to: "
+                  << heat_map_file << ". Press ENTER to continue..." << "\n";
+
+        std::string input2;
+        std::getline(std::cin, input2);
+        clear_lines(3);
+    }
+
+    else if (command == 'k')
+    {
+        std::optional<bool> trace_switch = parser_command.get_trace_switch();
+        Tracer &tracer = Tracer::instance();
+        if (trace_switch)
+        {
+            tracer.set_enabled(*trace_switch);
+            tracer.set_thread_name("main");
+            std::cout << (*trace_switch ? "Tracing the following generations."
+                                        : "Tracing stopped, the recorded zones are kept.");
+        }
+        else
+        {
+            size_t zones = tracer.get_events().size();
+            try
+            {
+                tracer.write_to_file(parser_command.get_filename());
+            }
+            catch (const std::runtime_error &e)
+            {
+                throw InvalidCommandException(e.what());
+            }
+            tracer.clear();
+            std::cout << "The trace of " << zones << " zones was saved to: " << parser_command.get_filename() << ".";
+        }
+        std::cout << " Press ENTER to continue..." << "\n";
+
+        std::string input2;
+        std::getline(std::cin, input2);
+        clear_lines(3);
+    }
 }
 
 void GameInterface::print_help()
@@ -156,14 +1084,35 @@ void GameInterface::print_help()
               << "For example:\n"
               << "./build/game game1.live --iterations=2 --output=./out3.live\n\n"
               << "Alternatively, you can play step by step. At startup, you can provide a file\n"
-              << "that describes the field in Life 1.06 format. If no file is provided, the default\n"
-              << "field will be loaded.\n\n"
+              << "that describes the field in Life 1.06 format. If no file is provided, a built-in\n"
+              << "game is loaded, or the built-in pattern given with --pattern=NAME.\n\n"
 
               << "\033[32m" << "Commands for step-by-step play:\n"
               << "\033[0m"
               << " - dump <output file>: Saves the current field to the specified file.\n"
               << "   By default, the file is saved as 'out.live'.\n"
-              << " - tick <n>: Advances the game by n steps (default is 1).\n"
+              << " - tick <n>: Advances the game by n steps (default is 1). Long ticks show\n"
+              << "   their progress and stop early when stop is entered or Ctrl-C is pressed.\n"
+              << " - load <file|name>: Loads a .live file or a built-in pattern, e.g. glider.\n"
+              << " - stats: Shows the generation, population, size, rule and storage.\n"
+              << " - region <row> <col> <height> <width>: Shows a part of the field.\n"
+              << " - census: Counts the still lifes, oscillators and spaceships of the field.\n"
+              << " - heat <alive|flips|off>: Counts per cell the following generations alive\n"
+              << "   or the changes (default is alive).\n"
+              << " - heatmap <file.pgm|file.csv>: Saves the counts of the heat command.\n"
+              << " - trace <on|off|file.json>: Records when stepping, rendering and I/O happen,\n"
+              << "   or saves the recorded zones as a Chrome trace to view in Perfetto.\n"
+              << " - export <file.pbm|file.pgm> <k>: Saves the field as an image with\n"
+              << "   k x k cells per pixel (default is 1).\n"
+              << " - record <k>: Records the following generations with a keyframe\n"
+              << "   every k generations (default is 32).\n"
+              << " - goto <gen>: Returns to a recorded generation.\n"
+              << " - undo <n>: Undoes the last n steps (default is 1).\n"
+              << " - rewind <gen>: Undoes the steps back to the given generation.\n"
+              << " - pan <rows> <cols>: Moves the view over a large field.\n"
+              << " - zoom <k>: Shows k x k cells per dot (a power of two), 0 shows the full field.\n"
+              << " - run <fps>: Runs the game continuously, drawing at most fps frames per\n"
+              << "   second (default is 30), until stop is entered or Ctrl-C is pressed.\n"
               << " - exit: Exits the game.\n\n"
 
               << "\033[32m" << "Additional Information:\n"
@@ -174,54 +1123,48 @@ void GameInterface::print_help()
 
     std::string input2;
     std::getline(std::cin, input2);
-    clear_lines(25);
+    clear_lines(46);
 }
 
-void GameInterface::clear_lines(int count_lines)
+void GameInterface::write_census(const GameState &game, const std::string &census_file)
 {
-    for (int i = 0; i < count_lines; ++i)
-        std::cout << "\033[F\033[K";
-}
+    Census census;
+    census.take(game.get_packed_field(), game.get_B_conditions(), game.get_S_conditions());
 
-void GameInterface::save_to_file(const GameState &game, const std::string &output_file)
-{
-    std::ofstream file(output_file);
-    if (!file.is_open())
+    std::ofstream out(census_file);
+    out << census.format();
+    if (!out)
     {
-        throw std::runtime_error("It couldn't open file for read: " + output_file);
+        throw std::runtime_error("Unable to write the census to " + census_file + ".");
     }
+}
 
-    file << "#Life " << game.get_game_version() << "\n";
-
-    file << "#N " << game.get_universe_name() << "\n";
-
-    file << "#Size " << game.get_size() << "\n";
+void GameInterface::run_parallel(GameState &game, const ParserCommandLine &parser_command_line, std::ostream &report)
+{
+    NumaTopology topology;
+    ParallelEngine engine(game, parser_command_line.get_thread_count(), parser_command_line.get_numa_policy(), topology);
+    engine.run(parser_command_line.get_iterations());
 
-    file << "#R B";
-    for (int condition : game.get_B_conditions())
+    if (parser_command_line.is_topology_report())
     {
-        file << condition;
+        report << topology.report() << engine.report_placement();
     }
-    file << "/S";
-    for (int condition : game.get_S_conditions())
-    {
-        file << condition;
-    }
-    file << "\n";
+}
 
-    const auto &field = game.get_field();
-    for (int row = 0; row < field.size(); ++row)
+void GameInterface::clear_lines(int count_lines)
+{
+    for (int i = 0; i < count_lines; ++i)
+        std::cout << "\033[F\033[K";
+}
+
+void GameInterface::save_to_file(const GameState &game, const std::string &output_file)
+{
     {
-        for (int col = 0; col < field[row].size(); ++col)
-        {
-            if (field[row][col])
-            {
-                file << row + 1 << " " << col + 1 << "\n";
-            }
-        }
+        TraceZone zone("save_to_file");
+        LiveFileWriter writer(output_file);
+        writer.write(game);
     }
 
-    file.close();
     std::cout << "The data was saved to: " << output_file << ". Press ENTER to continue..." << "\n";
 
     std::string input2;
@@ -232,6 +1175,12 @@ void GameInterface::save_to_file(const GameState &game, const std::string &outpu
 std::string GameInterface::manage_input()
 {
     std::string input;
+    if (!queued_commands.empty())
+    {
+        input = queued_commands.front();
+        queued_commands.pop_front();
+        return input;
+    }
     std::getline(std::cin, input);
 
     size_t end_pos = input.find_last_not_of(" \t\n\r");
@@ -0,0 +1,150 @@
+/**
+ * C interface of the Game of Life library for programs embedding the
+ * simulator. It is exported by the shared library (libgameoflife.so); no C++
+ * type or exception crosses it, so it stays usable from C and other
+ * languages. Functions returning an int status give GOL_OK on success; the
+ * message of the last failure of a universe is available from
+ * gol_last_error().
+ */
+#ifndef GAME_OF_LIFE_H
+#define GAME_OF_LIFE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define GOL_API __declspec(dllexport)
+#elif defined(__GNUC__)
+#define GOL_API __attribute__((visibility("default")))
+#else
+#define GOL_API
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define GOL_API_VERSION 1 /* Incremented on incompatible changes of this interface */
+
+    enum gol_status
+    {
+        GOL_OK = 0,             /* Success */
+        GOL_ERROR_ARGUMENT = 1, /* Null pointer or value out of range */
+        GOL_ERROR_PARSE = 2,    /* The buffer is not a valid .live file */
+        GOL_ERROR_RUNTIME = 3   /* Out of memory or another failure */
+    };
+
+    /** Opaque universe: a field with its rule and generation counter. */
+    typedef struct gol_universe gol_universe;
+
+    /**
+     * Function called after every generation computed by gol_step().
+     *
+     * @param universe The universe, whose cells may be read during the call.
+     * @param generation The number of the generation just computed.
+     * @param user_data The pointer given to gol_set_callback().
+     */
+    typedef void (*gol_generation_callback)(const gol_universe *universe, long long generation, void *user_data);
+
+    /**
+     * Gets the version of the interface implemented by the loaded library.
+     *
+     * @return GOL_API_VERSION of the library.
+     */
+    GOL_API int gol_api_version(void);
+
+    /**
+     * Creates an empty universe with the B3/S23 rule.
+     *
+     * @param size The number of rows and columns, at least 1.
+     * @return The universe, or NULL if the size is invalid or memory is exhausted.
+     */
+    GOL_API gol_universe *gol_create(int size);
+
+    /**
+     * Destroys a universe. NULL is ignored.
+     *
+     * @param universe The universe.
+     */
+    GOL_API void gol_destroy(gol_universe *universe);
+
+    /**
+     * Replaces the universe with the contents of a .live file held in memory,
+     * including its size, rule and name. The universe is unchanged on failure.
+     *
+     * @param universe The universe.
+     * @param data The file contents; they need not be null-terminated.
+     * @param length The number of bytes of data.
+     * @return GOL_OK, GOL_ERROR_ARGUMENT or GOL_ERROR_PARSE.
+     */
+    GOL_API int gol_load(gol_universe *universe, const char *data, size_t length);
+
+    /**
+     * Computes the following generations, calling the callback after each one.
+     *
+     * @param universe The universe.
+     * @param generations The number of generations, at least 0.
+     * @return GOL_OK, GOL_ERROR_ARGUMENT or GOL_ERROR_RUNTIME.
+     */
+    GOL_API int gol_step(gol_universe *universe, int generations);
+
+    /**
+     * Sets the function called after every generation, replacing the previous one.
+     *
+     * @param universe The universe.
+     * @param callback The function, or NULL to remove it.
+     * @param user_data A pointer passed to the function unchanged.
+     * @return GOL_OK or GOL_ERROR_ARGUMENT.
+     */
+    GOL_API int gol_set_callback(gol_universe *universe, gol_generation_callback callback, void *user_data);
+
+    /**
+     * Gets the number of rows and columns.
+     *
+     * @param universe The universe.
+     * @return The size, or 0 for NULL.
+     */
+    GOL_API int gol_size(const gol_universe *universe);
+
+    /**
+     * Gets the number of computed generations.
+     *
+     * @param universe The universe.
+     * @return The generation, or 0 for NULL.
+     */
+    GOL_API long long gol_generation(const gol_universe *universe);
+
+    /**
+     * Counts the live cells.
+     *
+     * @param universe The universe.
+     * @return The population, or 0 for NULL.
+     */
+    GOL_API long long gol_population(const gol_universe *universe);
+
+    /**
+     * Gets the cells without copying them. Row r starts at word r * stride;
+     * bit (c % 64) of word (c / 64) of a row is the cell in column c, and the
+     * bits past the last column are 0. The pointer stays valid until the next
+     * gol_step(), gol_load() or gol_destroy() on the universe.
+     *
+     * @param universe The universe.
+     * @param stride Receives the number of 64-bit words per row; may be NULL.
+     * @return The first word of the first row, or NULL for NULL.
+     */
+    GOL_API const uint64_t *gol_cells(const gol_universe *universe, size_t *stride);
+
+    /**
+     * Gets the message of the last failed call on the universe.
+     *
+     * @param universe The universe.
+     * @return The message, empty if no call failed; valid until the next call.
+     */
+    GOL_API const char *gol_last_error(const gol_universe *universe);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,4 +1,3 @@
-#include <set>
 #include <vector>
 #include <stdexcept>
 #include <iostream>
@@ -9,418 +8,3894 @@
 #include <array>
 #include <cstdlib>
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <random>
 #include <regex>
+#include <cstdint>
+#include <functional>
+#include <bit>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <cstdio>
+#include <limits>
+#include <optional>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <poll.h>
+#include <csignal>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <set>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#include <unordered_map>
+#include <coroutine>
+#include <utility>
+#include <fcntl.h>
+#include <span>
+#include <glob.h>
+#include <filesystem>
+#include <memory>
+#include <barrier>
+#include <sched.h>
+#include <sys/syscall.h>
 
 using Field = std::vector<std::vector<bool> >; // Grid field representing the game state
 
 /**
- * Class representing the state of the game.
+ * Process-wide pool of memory blocks for packed fields. Every block is one
+ * contiguous allocation aligned to a cache line; blocks of at least 2 MiB are
+ * mapped with huge pages when the system allows it. Released blocks are kept
+ * for the next field of the same size, so the buffers of successive ticks and
+ * engines are recycled instead of being allocated again.
+ */
+class FieldArena
+{
+public:
+    /**
+     * How large blocks are backed by huge pages.
+     */
+    enum class HugePages
+    {
+        NONE,        // Regular pages only
+        TRANSPARENT, // madvise(MADV_HUGEPAGE), used by the kernel when it can
+        EXPLICIT     // MAP_HUGETLB from the reserved pool, then transparent, then regular pages
+    };
+
+    /**
+     * Counters of the arena since the start of the program.
+     */
+    struct Stats
+    {
+        size_t allocations = 0;     // Blocks obtained from the system
+        size_t reuses = 0;          // Requests served from released blocks
+        size_t huge_tlb_blocks = 0; // Blocks mapped from the reserved huge page pool
+        size_t advised_blocks = 0;  // Blocks advised to use transparent huge pages
+        size_t cached_bytes = 0;    // Bytes of released blocks kept for reuse
+    };
+
+    /**
+     * Gets the arena shared by all fields.
+     *
+     * @return The arena.
+     */
+    static FieldArena &instance();
+
+    /**
+     * Frees all cached blocks.
+     */
+    ~FieldArena();
+
+    /**
+     * Allocates a block, reusing a released block of the same size class.
+     *
+     * @param bytes The number of bytes.
+     * @return The block, aligned to at least 64 bytes.
+     * @throws std::bad_alloc If the memory cannot be allocated.
+     */
+    void *allocate(size_t bytes);
+
+    /**
+     * Releases a block obtained from allocate().
+     *
+     * @param block The block.
+     * @param bytes The number of bytes passed to allocate().
+     */
+    void deallocate(void *block, size_t bytes);
+
+    /**
+     * Sets how blocks allocated from now on use huge pages.
+     *
+     * @param policy The huge page policy.
+     */
+    void set_huge_pages(HugePages policy);
+
+    /**
+     * Frees the cached blocks and returns their memory to the system.
+     */
+    void release_cache();
+
+    /**
+     * Gets the counters of the arena.
+     *
+     * @return A copy of the counters.
+     */
+    Stats get_stats() const;
+
+private:
+    static constexpr size_t CACHE_LINE = 64;               // Alignment of every block
+    static constexpr size_t HUGE_PAGE = 2 << 20;           // Blocks of this size or more are mapped
+    static constexpr size_t CACHE_LIMIT = size_t(1) << 30; // Bytes of released blocks kept for reuse
+
+    mutable std::mutex mutex;                      // Guards the fields below
+    HugePages huge_pages = HugePages::TRANSPARENT; // Policy for new blocks
+    std::multimap<size_t, void *> cache;           // Released blocks by size class
+    Stats stats;                                   // Counters
+
+    FieldArena() = default;
+
+    /**
+     * Rounds a request up to its size class.
+     *
+     * @param bytes The number of bytes.
+     * @return The size of the block.
+     */
+    static size_t size_class(size_t bytes);
+
+    /**
+     * Obtains a new block from the system.
+     *
+     * @param bytes The size of the block, a size class.
+     * @return The block.
+     */
+    void *map_block(size_t bytes);
+
+    /**
+     * Returns a block to the system.
+     *
+     * @param block The block.
+     * @param bytes The size of the block, a size class.
+     */
+    static void unmap_block(void *block, size_t bytes);
+};
+
+/**
+ * Allocator placing containers in the FieldArena.
+ */
+template <typename T>
+struct ArenaAllocator
+{
+    using value_type = T;
+
+    ArenaAllocator() = default;
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &) {}
+
+    T *allocate(size_t count)
+    {
+        return static_cast<T *>(FieldArena::instance().allocate(count * sizeof(T)));
+    }
+
+    void deallocate(T *block, size_t count)
+    {
+        FieldArena::instance().deallocate(block, count * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &) const
+    {
+        return true;
+    }
+};
+
+using PackedWords = std::vector<uint64_t, ArenaAllocator<uint64_t> >; // Words of a packed field
+
+/**
+ * Process-wide recorder of timed zones for a timeline of a run. Every thread
+ * writes into its own ring buffer, so recording takes no lock: the owner
+ * stores the event and publishes it by advancing the head, and a full ring
+ * overwrites its oldest events. The rings of finished threads are reused by
+ * new ones, which get tracks of their own. The events are written as Chrome trace-event JSON, which Perfetto
+ * and chrome://tracing show with one track per thread.
+ */
+class Tracer
+{
+public:
+    static constexpr size_t RING_CAPACITY = size_t(1) << 15; // Event slots per thread, the newest RING_CAPACITY - 1 events are kept
+
+    /**
+     * Zone recorded by a thread.
+     */
+    struct Event
+    {
+        const char *name;     // Name of the zone, a string literal
+        int64_t start;        // Start in nanoseconds of the steady clock
+        int64_t duration;     // Duration in nanoseconds
+        long long generation; // Generation the zone belongs to, -1 if none
+    };
+
+    /**
+     * Gets the tracer of the process.
+     *
+     * @return The tracer.
+     */
+    static Tracer &instance();
+
+    /**
+     * Checks whether zones are recorded. A zone reads the flag once, when it starts.
+     *
+     * @return True if tracing is on.
+     */
+    static bool is_enabled()
+    {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Starts or stops recording. Events recorded so far are kept.
+     *
+     * @param on Whether zones are recorded.
+     */
+    void set_enabled(bool on);
+
+    /**
+     * Records a zone of the calling thread.
+     *
+     * @param name The name of the zone, a string literal.
+     * @param start The start from now().
+     * @param end The end from now().
+     * @param generation The generation the zone belongs to, -1 if none.
+     */
+    void record(const char *name, int64_t start, int64_t end, long long generation);
+
+    /**
+     * Names the track of the calling thread, e.g. "band 3".
+     *
+     * @param name The name shown for the thread.
+     */
+    void set_thread_name(const std::string &name);
+
+    /**
+     * Copies the events of every thread that are still in the rings.
+     *
+     * @return The events with the track number of their thread, oldest first per thread.
+     */
+    std::vector<std::pair<int, Event> > get_events() const;
+
+    /**
+     * Formats the events as Chrome trace-event JSON.
+     *
+     * @return The JSON document.
+     */
+    std::string to_json() const;
+
+    /**
+     * Writes the events as Chrome trace-event JSON.
+     *
+     * @param file_name The .json file.
+     * @throws std::runtime_error If the file cannot be written.
+     */
+    void write_to_file(const std::string &file_name) const;
+
+    /**
+     * Drops every recorded event.
+     */
+    void clear();
+
+    /**
+     * Reads the clock of the events.
+     *
+     * @return Nanoseconds of the steady clock.
+     */
+    static int64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+private:
+    /**
+     * Event slot, read by get_events() while the owner may overwrite it.
+     */
+    struct Slot
+    {
+        std::atomic<const char *> name{nullptr}; // Name of the zone
+        std::atomic<int64_t> start{0};           // Start in nanoseconds of the steady clock
+        std::atomic<int64_t> duration{0};        // Duration in nanoseconds
+        std::atomic<long long> generation{0};    // Generation the zone belongs to, -1 if none
+    };
+
+    /**
+     * Thread that owned a ring from one of its events on.
+     */
+    struct Track
+    {
+        uint64_t first;          // First event of the thread in the ring
+        int number;              // Number of the track, from 1
+        std::string thread_name; // Name of the track
+    };
+
+    /**
+     * Ring buffer written by one thread at a time.
+     */
+    struct Ring
+    {
+        std::unique_ptr<Slot[]> slots;    // RING_CAPACITY slots
+        std::atomic<uint64_t> head{0};    // Number of events ever recorded; the owner alone advances it
+        std::atomic<uint64_t> cleared{0}; // Events before this one were dropped by clear()
+        std::vector<Track> tracks;        // Owners of the ring whose events are kept, oldest first
+        bool in_use = false;              // Whether a running thread owns the ring
+    };
+
+    /**
+     * Returns the rings of finished threads for reuse.
+     */
+    struct RingOwner
+    {
+        Ring *ring = nullptr; // Ring of the thread, nullptr until it records
+
+        ~RingOwner();
+    };
+
+    static std::atomic<bool> enabled; // Whether zones are recorded
+
+    mutable std::mutex rings_mutex;            // Guards the list of rings and their tracks, not their events
+    std::vector<std::unique_ptr<Ring> > rings; // Every ring ever handed out
+    int track_count = 0;                       // Tracks handed out so far
+    std::atomic<int64_t> origin{0};            // Time the trace starts at
+
+    Tracer() = default;
+
+    /**
+     * Gets the ring of the calling thread, taking a free one on the first call.
+     *
+     * @return The ring.
+     */
+    Ring &local_ring();
+
+    /**
+     * Forgets the previous owners of a ring whose events were all overwritten or cleared.
+     *
+     * @param ring The ring, with rings_mutex held.
+     */
+    static void drop_old_tracks(Ring &ring);
+};
+
+/**
+ * Scoped zone of a trace: records the time between its construction and its
+ * destruction on the calling thread. The constructor reads the tracing flag
+ * once and both ends branch on that copy, so while tracing is off a zone
+ * costs one load and a branch taken the same way at every zone boundary.
+ */
+class TraceZone
+{
+public:
+    /**
+     * Starts the zone.
+     *
+     * @param name The name of the zone, a string literal.
+     * @param generation The generation the zone belongs to, -1 if none.
+     */
+    explicit TraceZone(const char *name, long long generation = -1)
+        : name(name), generation(generation), active(Tracer::is_enabled()), start(active ? Tracer::now() : 0)
+    {
+    }
+
+    /**
+     * Ends the zone and records it if tracing was on at its start.
+     */
+    ~TraceZone()
+    {
+        if (active)
+        {
+            Tracer::instance().record(name, start, Tracer::now(), generation);
+        }
+    }
+
+    TraceZone(const TraceZone &) = delete;
+    TraceZone &operator=(const TraceZone &) = delete;
+
+private:
+    const char *name;     // Name of the zone
+    long long generation; // Generation the zone belongs to
+    bool active;          // Whether tracing was on at the start of the zone
+    int64_t start;        // Start of the zone, 0 if tracing was off
+};
+
+/**
+ * Class representing the field packed into 64-bit words, one bit per cell.
+ * Bit (col % 64) of word (col / 64) in a row holds the cell at column col.
+ */
+class PackedField
+{
+private:
+    int size;                    // Size of the grid
+    int stride;                  // Number of 64-bit words per row
+    PackedWords words;           // Packed rows stored one after another
+
+public:
+    /**
+     * Default constructor creating an empty field.
+     */
+    PackedField();
+
+    /**
+     * Constructs a field of the given size with all cells dead.
+     *
+     * @param size The size of the grid.
+     */
+    explicit PackedField(int size);
+
+    /**
+     * Packs an unpacked field.
+     *
+     * @param field The field to pack.
+     */
+    explicit PackedField(const Field &field);
+
+    /**
+     * Unpacks the field.
+     *
+     * @return The field as a 2D vector.
+     */
+    Field to_field() const;
+
+    /**
+     * Gets the size of the grid.
+     *
+     * @return The size of the grid.
+     */
+    int get_size() const;
+
+    /**
+     * Gets the number of words per row.
+     *
+     * @return The row stride in 64-bit words.
+     */
+    int get_stride() const;
+
+    /**
+     * Gets the state of a cell.
+     *
+     * @param row The row of the cell.
+     * @param col The column of the cell.
+     * @return True if the cell is alive.
+     */
+    bool get(int row, int col) const;
+
+    /**
+     * Sets the state of a cell.
+     *
+     * @param row The row of the cell.
+     * @param col The column of the cell.
+     * @param alive The new state of the cell.
+     */
+    void set(int row, int col, bool alive);
+
+    /**
+     * Gets the packed words of the whole field.
+     *
+     * @return A reference to the word storage.
+     */
+    const PackedWords &get_words() const;
+
+    /**
+     * Gets the packed words of the whole field for modification.
+     *
+     * @return A reference to the word storage.
+     */
+    PackedWords &get_words();
+
+    /**
+     * Counts the live cells.
+     *
+     * @return The number of live cells.
+     */
+    long long population() const;
+
+    /**
+     * Counts the live cells in a part of a row without wrapping.
+     *
+     * @param row The row.
+     * @param start The first column.
+     * @param length The number of columns, start + length must not exceed the size.
+     * @return The number of live cells.
+     */
+    int count_range(int row, int start, int length) const;
+};
+
+/**
+ * Class representing the state of the game.
+ */
+class GameState
+{
+public:
+    /**
+     * Form in which the engine keeps the cells while it runs generations.
+     */
+    enum class Storage
+    {
+        DENSE, // Packed grid of every cell
+        SPARSE // Tiles with live cells only
+    };
+
+private:
+    std::string game_version;    // Version of the game
+    std::string universe_name;   // Name of the universe
+    int size;                    // Size of the grid
+    int count_of_iterations;     // Number of iterations to simulate
+    std::set<int> B_conditions;  // Birth conditions
+    std::set<int> S_conditions;  // Survival conditions
+    int state_count;             // Number of cell states, more than 2 for Generations rules
+    PackedField field;           // Cells packed into one contiguous buffer
+    std::vector<uint8_t> states; // State of every cell row by row under Generations rules, empty until needed
+    Storage storage;             // Form the engine runs the generations in
+    std::string storage_reason;  // Why the engine switched to that form, empty before the first switch
+
+public:
+    /**
+     * Default constructor for initializing the game state.
+     */
+    GameState();
+
+    /**
+     * Destructor for the GameState class.
+     */
+    ~GameState();
+
+    /**
+     * Gets the game version.
+     *
+     * @return The version of the game as a string.
+     */
+    std::string get_game_version() const;
+
+    /**
+     * Gets the universe name.
+     *
+     * @return The name of the universe as a string.
+     */
+    std::string get_universe_name() const;
+
+    /**
+     * Gets the size of the grid.
+     *
+     * @return The size of the grid as an integer.
+     */
+    int get_size() const;
+
+    /**
+     * Gets the number of iterations.
+     *
+     * @return The number of iterations as an integer.
+     */
+    int get_count_of_iterations() const;
+
+    /**
+     * Gets the birth conditions.
+     *
+     * @return A set of integers representing birth conditions.
+     */
+    std::set<int> get_B_conditions() const;
+
+    /**
+     * Gets the survival conditions.
+     *
+     * @return A set of integers representing survival conditions.
+     */
+    std::set<int> get_S_conditions() const;
+
+    /**
+     * Gets the number of cell states: 2 for alive and dead, more for a
+     * Generations rule, where a cell that stops surviving passes through the
+     * dying states 2 to count - 1 before it is dead. Dying cells are neither
+     * alive nor dead: they are not counted as neighbors and cannot be born.
+     *
+     * @return The number of states.
+     */
+    int get_state_count() const;
+
+    /**
+     * Gets the state of a cell.
+     *
+     * @param row The row of the cell.
+     * @param col The column of the cell.
+     * @return 0 for dead, 1 for alive, 2 to get_state_count() - 1 for dying.
+     */
+    int get_cell_state(int row, int col) const;
+
+    /**
+     * Gets the state of every cell under a Generations rule, one byte per cell
+     * row by row. The live cells are in the packed field as well.
+     *
+     * @return The states, or an empty array if there is no dying cell state.
+     */
+    const std::vector<uint8_t> &get_cell_states() const;
+
+    /**
+     * Copies the state of every cell under a Generations rule, one byte per
+     * cell row by row, also while no cell is dying yet.
+     *
+     * @return The states, or an empty array for a rule without dying states.
+     */
+    std::vector<uint8_t> copy_cell_states() const;
+
+    /**
+     * Gets the field representing the game state.
+     *
+     * @return A 2D vector representing the grid.
+     */
+    std::vector<std::vector<bool> > get_field() const;
+
+    /**
+     * Gets a read-only reference to the packed field without copying it.
+     *
+     * @return A constant reference to the packed grid.
+     */
+    const PackedField &get_packed_field() const;
+
+    /**
+     * Counts the live cells of the field.
+     *
+     * @return The number of live cells.
+     */
+    long long get_population() const;
+
+    /**
+     * Formats the birth and survival conditions.
+     *
+     * @return The rule in B/S notation, e.g. "B3/S23".
+     */
+    std::string get_rule_string() const;
+
+    /**
+     * Gets the form the engine runs the generations in.
+     *
+     * @return The storage of the cells.
+     */
+    Storage get_storage() const;
+
+    /**
+     * Gets why the engine switched to the current storage.
+     *
+     * @return The reason, empty if the storage never changed.
+     */
+    const std::string &get_storage_reason() const;
+
+    /**
+     * Formats the statistics of the game.
+     *
+     * @return A single line with the generation, population, size, rule and storage.
+     */
+    std::string get_stats() const;
+
+    /**
+     * Formats a rectangular region of the field with toroidal wrapping.
+     *
+     * @param row The top row of the region.
+     * @param col The left column of the region.
+     * @param height The number of rows, at most the field size; larger values are clamped.
+     * @param width The number of columns, at most the field size; larger values are clamped.
+     * @return One line of 'O' and '.' characters per row.
+     */
+    std::string get_region(int row, int col, int height, int width) const;
+
+    /**
+     * Sets the game version.
+     *
+     * @param version The new version of the game.
+     */
+    void set_game_version(const std::string &version);
+
+    /**
+     * Sets the universe name.
+     *
+     * @param name The new universe name.
+     */
+    void set_universe_name(const std::string &name);
+
+    /**
+     * Sets the size of the grid.
+     *
+     * @param new_size The new size of the grid.
+     */
+    void set_size(int new_size);
+
+    /**
+     * Sets the number of iterations.
+     *
+     * @param iterations The number of iterations to set.
+     */
+    void set_count_of_iterations(int iterations);
+
+    /**
+     * Sets the birth conditions.
+     *
+     * @param conditions A set of integers representing new birth conditions.
+     */
+    void set_B_conditions(const std::set<int> &conditions);
+
+    /**
+     * Sets the survival conditions.
+     *
+     * @param conditions A set of integers representing new survival conditions.
+     */
+    void set_S_conditions(const std::set<int> &conditions);
+
+    /**
+     * Sets the number of cell states; 2 removes the dying states of the cells.
+     *
+     * @param count The number of states, from 2 to 256.
+     * @throws std::invalid_argument If the count is out of range.
+     */
+    void set_state_count(int count);
+
+    /**
+     * Sets the field representing the game state.
+     *
+     * @param new_field A 2D vector representing the new grid.
+     */
+    void set_field(const Field &new_field);
+
+    /**
+     * Sets the field from a packed grid.
+     *
+     * @param new_field The new packed grid.
+     */
+    void set_field(const PackedField &new_field);
+
+    /**
+     * Sets the state of one cell.
+     *
+     * @param row The row of the cell.
+     * @param col The column of the cell.
+     * @param alive The new state of the cell.
+     * @throws std::out_of_range If the cell is outside the grid.
+     */
+    void set_cell(int row, int col, bool alive);
+
+    /**
+     * Exchanges the field with another buffer without copying any cells.
+     *
+     * @param other The buffer receiving the old field.
+     */
+    void swap_field(PackedField &other);
+
+    /**
+     * Sets the state of a cell, allocating the state array if needed.
+     *
+     * @param row The row of the cell.
+     * @param col The column of the cell.
+     * @param state The state, below get_state_count().
+     * @throws std::out_of_range If the cell is outside the field or the state is invalid.
+     */
+    void set_cell_state(int row, int col, int state);
+
+    /**
+     * Exchanges the field and the cell states with other buffers without
+     * copying any cells; the live cells of both must agree.
+     *
+     * @param other_field The buffer receiving the old field.
+     * @param other_states The buffer receiving the old cell states.
+     */
+    void swap_cells(PackedField &other_field, std::vector<uint8_t> &other_states);
+
+    /**
+     * Fills the state array from the packed field if it is not in use yet, so
+     * that get_cell_states() covers every cell.
+     */
+    void allocate_cell_states();
+
+    /**
+     * Records a switch of the engine to another storage.
+     *
+     * @param new_storage The storage the engine continues in.
+     * @param reason Why the engine switched.
+     */
+    void set_storage(Storage new_storage, const std::string &reason);
+};
+
+/**
+ * Lazy sequence produced by a coroutine, in the manner of C++23 std::generator.
+ * Every co_yield suspends the coroutine and hands a reference to the yielded
+ * value to the consumer without copying it; the coroutine resumes when the
+ * consumer asks for the next value. The coroutine frame is allocated once per
+ * sequence, and leaving a range-for loop early destroys it.
+ */
+template <typename T>
+class Generator
+{
+public:
+    using value_type = std::remove_cvref_t<T>;
+    using reference = std::conditional_t<std::is_reference_v<T>, T, const T &>;
+
+    struct promise_type
+    {
+        const value_type *current = nullptr; // Value of the last co_yield
+        std::exception_ptr error;            // Exception thrown by the coroutine
+
+        Generator get_return_object()
+        {
+            return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_always final_suspend() noexcept
+        {
+            return {};
+        }
+
+        // The yielded object outlives the suspension, so keeping its address is enough
+        std::suspend_always yield_value(reference value) noexcept
+        {
+            current = std::addressof(value);
+            return {};
+        }
+
+        void return_void() {}
+
+        void unhandled_exception()
+        {
+            error = std::current_exception();
+        }
+    };
+
+    /**
+     * Input iterator resuming the coroutine on every increment.
+     */
+    class iterator
+    {
+    public:
+        using value_type = Generator::value_type;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+
+        explicit iterator(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+        reference operator*() const
+        {
+            return static_cast<reference>(*handle.promise().current);
+        }
+
+        iterator &operator++()
+        {
+            resume(handle);
+            return *this;
+        }
+
+        void operator++(int)
+        {
+            ++*this;
+        }
+
+        bool operator==(std::default_sentinel_t) const
+        {
+            return !handle || handle.done();
+        }
+
+    private:
+        std::coroutine_handle<promise_type> handle; // Coroutine of the generator
+    };
+
+    Generator(Generator &&other) noexcept : handle(std::exchange(other.handle, {})) {}
+
+    Generator &operator=(Generator &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (handle)
+            {
+                handle.destroy();
+            }
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+
+    Generator(const Generator &) = delete;
+    Generator &operator=(const Generator &) = delete;
+
+    ~Generator()
+    {
+        if (handle)
+        {
+            handle.destroy();
+        }
+    }
+
+    /**
+     * Runs the coroutine up to its first value.
+     *
+     * @return An iterator at the first value, or at the end if there is none.
+     */
+    iterator begin()
+    {
+        resume(handle);
+        return iterator(handle);
+    }
+
+    std::default_sentinel_t end() const noexcept
+    {
+        return {};
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle; // Coroutine of the generator
+
+    explicit Generator(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    // Resumes the coroutine and rethrows an exception it did not handle
+    static void resume(std::coroutine_handle<promise_type> handle)
+    {
+        handle.resume();
+        if (handle.promise().error)
+        {
+            std::rethrow_exception(std::exchange(handle.promise().error, nullptr));
+        }
+    }
+};
+
+/**
+ * Class for simulating and updating the game state.
+ */
+class GameEngine
+{
+public:
+    /**
+     * Constructor for the GameEngine class.
+     *
+     * @param ReceivedGameState A reference to the GameState object.
+     * @param iterations The number of iterations to simulate.
+     */
+    GameEngine(GameState &ReceivedGameState, int iterations);
+
+    /**
+     * Constructor computing generations into a caller-owned buffer, so that the
+     * buffer is reused by the following engines instead of being allocated again.
+     *
+     * @param ReceivedGameState A reference to the GameState object.
+     * @param iterations The number of iterations to simulate.
+     * @param buffer The scratch field; it holds an old generation afterwards.
+     */
+    GameEngine(GameState &ReceivedGameState, int iterations, PackedField &buffer);
+
+    /**
+     * Updates the game state by computing the next state of the field.
+     */
+    void UpdateGameState();
+
+    /**
+     * Counts the number of neighboring cells that are alive.
+     *
+     * @param field The current field as a 2D vector.
+     * @param x The x-coordinate of the cell.
+     * @param y The y-coordinate of the cell.
+     * @return The count of live neighbors.
+     */
+    int countNeighbors(const Field &field, int x, int y);
+
+    /**
+     * Registers a callback invoked after every computed generation.
+     *
+     * @param callback The function receiving the updated game state.
+     */
+    void add_generation_callback(const std::function<void(const GameState &)> &callback);
+
+    /**
+     * Lets another thread stop UpdateGameState() between two generations. The
+     * game state then holds the last computed generation and its number.
+     *
+     * @param flag The flag checked before every generation, or nullptr.
+     */
+    void set_cancel_flag(const std::atomic<bool> *flag);
+
+    /**
+     * Computes the generations lazily, one per step of the returned sequence.
+     * The yielded field is the field of the game state, valid until the next
+     * step; the sequence ends after the number of iterations of the engine.
+     * Apart from the coroutine frame, no step allocates memory once the
+     * scratch field has the size of the game.
+     *
+     * @return The sequence of generations.
+     */
+    Generator<const PackedField &> generations();
+
+    /**
+     * Translates the birth and survival conditions of a game into lookup tables.
+     *
+     * @param state The game state with the conditions.
+     * @param births Receives whether a dead cell with n live neighbors is born, for n = 0..8.
+     * @param survivals Receives whether a live cell with n live neighbors survives, for n = 0..8.
+     */
+    static void get_rule_tables(const GameState &state, std::array<bool, 9> &births, std::array<bool, 9> &survivals);
+
+    /**
+     * Computes the next generation of one packed row 64 cells at a time: the
+     * eight neighbors of every cell are added as bit planes of a 4-bit count.
+     *
+     * @param up The row above, wrapping around the field.
+     * @param mid The row to compute.
+     * @param down The row below, wrapping around the field.
+     * @param result The row receiving the next generation.
+     * @param size The number of cells per row.
+     * @param births Whether a dead cell with n live neighbors is born, for n = 0..8.
+     * @param survivals Whether a live cell with n live neighbors survives, for n = 0..8.
+     */
+    static void step_row(const uint64_t *up, const uint64_t *mid, const uint64_t *down, uint64_t *result, int size,
+                         const std::array<bool, 9> &births, const std::array<bool, 9> &survivals);
+
+    /**
+     * Computes the next generation of a Generations rule with one byte per
+     * cell. Only alive cells are counted as neighbors; alive cells that do not
+     * survive and dying cells age by one state in the same pass. The loops are
+     * branch-free so that the compiler vectorizes them.
+     *
+     * @param current The current cell states, row by row.
+     * @param next The array receiving the next cell states, of the same size.
+     * @param size The number of rows and columns.
+     * @param state_count The number of cell states.
+     * @param births Whether a dead cell with n live neighbors is born, for n = 0..8.
+     * @param survivals Whether a live cell with n live neighbors survives, for n = 0..8.
+     * @param sums Scratch array for the live cells per column.
+     */
+    static void step_states(const std::vector<uint8_t> &current, std::vector<uint8_t> &next, int size, int state_count,
+                            const std::array<bool, 9> &births, const std::array<bool, 9> &survivals,
+                            std::vector<uint8_t> &sums);
+
+    /**
+     * Rule prepared for step_word(): the neighbor counts that give a birth or
+     * a survival, so that only those are compared.
+     */
+    struct RuleCounts
+    {
+        std::array<bool, 9> births;    // Whether a dead cell with n live neighbors is born
+        std::array<bool, 9> survivals; // Whether a live cell with n live neighbors survives
+        std::array<int, 9> counts;     // The neighbor counts with a birth or a survival
+        int count_total;               // Number of entries of counts in use
+    };
+
+    /**
+     * Prepares a rule for step_word().
+     *
+     * @param births Whether a dead cell with n live neighbors is born, for n = 0..8.
+     * @param survivals Whether a live cell with n live neighbors survives, for n = 0..8.
+     * @return The prepared rule.
+     */
+    static RuleCounts get_rule_counts(const std::array<bool, 9> &births, const std::array<bool, 9> &survivals);
+
+    /**
+     * Computes the next generation of 64 cells from the words of their eight
+     * neighbors, each shifted so that bit i is the neighbor of cell i. This is
+     * the kernel of step_row() and of the sparse field.
+     *
+     * @param a The neighbors above on the left.
+     * @param b The neighbors above.
+     * @param c The neighbors above on the right.
+     * @param d The neighbors on the left.
+     * @param e The neighbors on the right.
+     * @param f The neighbors below on the left.
+     * @param g The neighbors below.
+     * @param h The neighbors below on the right.
+     * @param alive The cells themselves.
+     * @param rule The rule from get_rule_counts().
+     * @return The next generation of the cells.
+     */
+    static uint64_t step_word(uint64_t a, uint64_t b, uint64_t c, uint64_t d, uint64_t e, uint64_t f, uint64_t g,
+                              uint64_t h, uint64_t alive, const RuleCounts &rule);
+
+private:
+    static constexpr int STORAGE_MIN_SIZE = 256;      // Smaller fields always stay dense
+    static constexpr int STORAGE_CHECK_INTERVAL = 16; // Generations between two looks at the tile occupancy
+    static constexpr double SPARSE_BELOW = 0.04;      // Occupied tile fraction below which dense fields turn sparse
+    static constexpr double DENSE_ABOVE = 0.12;       // Occupied tile fraction above which sparse fields turn dense
+
+    GameState &CurrentGameState;          // Reference to GameState object
+    int received_number_of_iterations;    // Number of iterations to perform
+    PackedField own_buffer;               // Scratch field when no buffer is given
+    PackedField *next_field;              // Field receiving the next generation
+    std::vector<uint8_t> next_states;     // Cell states receiving the next generation of a Generations rule
+    std::vector<uint8_t> column_sums;     // Scratch of step_states
+    const std::atomic<bool> *cancel_flag; // Flag stopping UpdateGameState() between generations, may be null
+    std::vector<std::function<void(const GameState &)> > generation_callbacks; // Per-generation observers
+
+    /**
+     * Checks whether another thread asked to stop.
+     *
+     * @return True if the cancel flag is set.
+     */
+    bool is_cancelled() const;
+
+    /**
+     * Computes the next generation of a packed field row by row.
+     *
+     * @param current The current generation.
+     * @param next The field receiving the next generation, of the same size.
+     * @param births Whether a dead cell with n live neighbors is born, for n = 0..8.
+     * @param survivals Whether a live cell with n live neighbors survives, for n = 0..8.
+     */
+    static void step(const PackedField &current, PackedField &next,
+                     const std::array<bool, 9> &births, const std::array<bool, 9> &survivals);
+
+    /**
+     * Gives the game state a field of its size and gets its rule tables.
+     *
+     * @param births Receives whether a dead cell with n live neighbors is born, for n = 0..8.
+     * @param survivals Receives whether a live cell with n live neighbors survives, for n = 0..8.
+     */
+    void prepare(std::array<bool, 9> &births, std::array<bool, 9> &survivals);
+
+    /**
+     * Computes one generation into the game state and notifies the observers.
+     *
+     * @param births Whether a dead cell with n live neighbors is born, for n = 0..8.
+     * @param survivals Whether a live cell with n live neighbors survives, for n = 0..8.
+     */
+    void advance(const std::array<bool, 9> &births, const std::array<bool, 9> &survivals);
+
+    /**
+     * Packs the alive cells of a state array into a field.
+     *
+     * @param states The cell states, row by row.
+     * @param field The field receiving the alive cells, of the same size.
+     */
+    static void pack_alive(const std::vector<uint8_t> &states, PackedField &field);
+
+    /**
+     * Computes all iterations on a FixedUniverse when one is instantiated for
+     * the size and rule of the game and no observer needs the generations in
+     * between.
+     *
+     * @param births Whether a dead cell with n live neighbors is born, for n = 0..8.
+     * @param survivals Whether a live cell with n live neighbors survives, for n = 0..8.
+     * @return True if the generations were computed, false if the packed kernel has to run them.
+     */
+    bool run_fixed(const std::array<bool, 9> &births, const std::array<bool, 9> &survivals);
+
+    /**
+     * Computes all iterations in the storage that suits the field, looking at
+     * the fraction of occupied tiles every few generations: a field whose
+     * live cells shrink to a few tiles continues as a SparseField, and a
+     * sparse field that grows returns to the packed kernel. The thresholds
+     * lie apart, so that a field near one of them does not switch back and
+     * forth. The game state keeps the storage and the reason of the last
+     * switch for the next run.
+     *
+     * @param births Whether a dead cell with n live neighbors is born, for n = 0..8.
+     * @param survivals Whether a live cell with n live neighbors survives, for n = 0..8.
+     * @return True if the generations were computed, false if observers or the rule need every generation packed.
+     */
+    bool run_adaptive(const std::array<bool, 9> &births, const std::array<bool, 9> &survivals);
+};
+
+/**
+ * Life-like rule fixed at compile time.
+ *
+ * @tparam Births Bit n is set if a dead cell with n live neighbors is born.
+ * @tparam Survivals Bit n is set if a live cell with n live neighbors survives.
+ */
+template <unsigned Births, unsigned Survivals>
+struct LifeRule
+{
+    static constexpr unsigned births = Births;       // Neighbor counts giving birth
+    static constexpr unsigned survivals = Survivals; // Neighbor counts keeping a cell alive
+};
+
+using ConwayRule = LifeRule<1u << 3, (1u << 2) | (1u << 3)>;                 // B3/S23
+using HighLifeRule = LifeRule<(1u << 3) | (1u << 6), (1u << 2) | (1u << 3)>; // B36/S23
+
+/**
+ * Toroidal universe whose size and rule are compile-time constants, for the
+ * billions of generations of small boards in soup searches. Every row is one
+ * word of a std::array, and the step is unrolled over the rows and the
+ * neighbor counts with the rule folded in, so nothing is looked up, branched
+ * on or allocated per generation. Everything but the conversion from and to
+ * packed fields is constexpr.
+ *
+ * @tparam N The number of rows and columns, at most 64.
+ * @tparam Rule The rule, such as ConwayRule.
+ */
+template <int N, typename Rule>
+class FixedUniverse
+{
+    static_assert(N >= 1 && N <= 64, "A fixed universe has between 1 and 64 rows");
+
+public:
+    /**
+     * Creates an empty universe.
+     */
+    constexpr FixedUniverse() : rows{} {}
+
+    /**
+     * Copies the cells of a packed field.
+     *
+     * @param field The field, with N rows and columns.
+     * @throws std::invalid_argument If the field has another size.
+     */
+    explicit FixedUniverse(const PackedField &field) : rows{}
+    {
+        if (field.get_size() != N)
+        {
+            throw std::invalid_argument("The field does not have the size of the universe");
+        }
+        // Rows of at most 64 cells are one word each
+        std::copy_n(field.get_words().begin(), N, rows.begin());
+    }
+
+    /**
+     * Copies the cells into a packed field.
+     *
+     * @param field The field receiving the cells; it gets N rows and columns.
+     */
+    void to_field(PackedField &field) const
+    {
+        if (field.get_size() != N)
+        {
+            field = PackedField(N);
+        }
+        std::copy(rows.begin(), rows.end(), field.get_words().begin());
+    }
+
+    /**
+     * Checks whether a cell is alive.
+     *
+     * @param row The row of the cell.
+     * @param col The column of the cell.
+     * @return True if the cell is alive.
+     */
+    constexpr bool get(int row, int col) const
+    {
+        return (rows[row] >> col) & 1;
+    }
+
+    /**
+     * Sets a cell alive or dead.
+     *
+     * @param row The row of the cell.
+     * @param col The column of the cell.
+     * @param alive Whether the cell is alive.
+     */
+    constexpr void set(int row, int col, bool alive)
+    {
+        uint64_t mask = uint64_t(1) << col;
+        rows[row] = alive ? (rows[row] | mask) : (rows[row] & ~mask);
+    }
+
+    /**
+     * Counts the live cells.
+     *
+     * @return The population.
+     */
+    constexpr int population() const
+    {
+        int count = 0;
+        for (uint64_t row : rows)
+        {
+            count += std::popcount(row);
+        }
+        return count;
+    }
+
+    /**
+     * Computes the next generation.
+     */
+    constexpr void step()
+    {
+        rows = next_rows(std::make_integer_sequence<int, N>());
+    }
+
+    /**
+     * Computes a number of generations.
+     *
+     * @param generations The number of generations.
+     */
+    constexpr void run(long long generations)
+    {
+        for (long long i = 0; i < generations; ++i)
+        {
+            step();
+        }
+    }
+
+    constexpr bool operator==(const FixedUniverse &other) const = default;
+
+private:
+    static constexpr uint64_t MASK = N == 64 ? ~uint64_t(0) : (uint64_t(1) << N) - 1; // Cells of a row
+
+    std::array<uint64_t, N> rows; // One word per row, column c in bit c
+
+    // Neighbors on the left and on the right, wrapping around the row
+    static constexpr uint64_t west(uint64_t row)
+    {
+        return ((row << 1) | (row >> (N - 1))) & MASK;
+    }
+    static constexpr uint64_t east(uint64_t row)
+    {
+        return (row >> 1) | ((row & 1) << (N - 1));
+    }
+
+    template <int... Row>
+    constexpr std::array<uint64_t, N> next_rows(std::integer_sequence<int, Row...>) const
+    {
+        return {next_row(rows[(Row + N - 1) % N], rows[Row], rows[(Row + 1) % N])...};
+    }
+
+    static constexpr uint64_t next_row(uint64_t up, uint64_t mid, uint64_t down)
+    {
+        uint64_t a = west(up), b = up, c = east(up);
+        uint64_t d = west(mid), e = east(mid);
+        uint64_t f = west(down), g = down, h = east(down);
+
+        // Carry-save adders: ones, twos, fours and eights of the neighbor count
+        uint64_t s0 = a ^ b ^ c, c0 = (a & b) | (c & (a ^ b));
+        uint64_t s1 = d ^ e ^ f, c1 = (d & e) | (f & (d ^ e));
+        uint64_t s2 = g ^ h, c2 = g & h;
+        uint64_t ones = s0 ^ s1 ^ s2, c3 = (s0 & s1) | (s2 & (s0 ^ s1));
+        uint64_t t0 = c0 ^ c1 ^ c2, k0 = (c0 & c1) | (c2 & (c0 ^ c1));
+        uint64_t twos = t0 ^ c3, k1 = t0 & c3;
+        uint64_t fours = k0 ^ k1, eights = k0 & k1;
+
+        return apply_rule(ones, twos, fours, eights, mid, std::make_integer_sequence<int, 9>());
+    }
+
+    template <int... Count>
+    static constexpr uint64_t apply_rule(uint64_t ones, uint64_t twos, uint64_t fours, uint64_t eights, uint64_t alive,
+                                         std::integer_sequence<int, Count...>)
+    {
+        // Counts outside the rule contribute a constant zero and vanish
+        uint64_t born = ((((Rule::births >> Count) & 1) ? equal<Count>(ones, twos, fours, eights) : 0) | ...);
+        uint64_t survive = ((((Rule::survivals >> Count) & 1) ? equal<Count>(ones, twos, fours, eights) : 0) | ...);
+        return ((born & ~alive) | (survive & alive)) & MASK;
+    }
+
+    template <int Count>
+    static constexpr uint64_t equal(uint64_t ones, uint64_t twos, uint64_t fours, uint64_t eights)
+    {
+        return (Count & 1 ? ones : ~ones) & (Count & 2 ? twos : ~twos) &
+               (Count & 4 ? fours : ~fours) & (Count & 8 ? eights : ~eights);
+    }
+};
+
+/**
+ * Field stored as 64 x 64 cell tiles of which only the tiles with live cells
+ * exist, for the phases of a run in which the live cells cover a small part
+ * of the area, such as ash and a few gliders. A tile holds one word per row
+ * in the layout of a packed field, so converting between the forms copies
+ * words, and a generation only visits the occupied tiles and their
+ * neighbors.
+ */
+class SparseField
+{
+public:
+    static constexpr int TILE = 64; // Rows and columns of a tile
+
+    /**
+     * Creates an empty field of size 0.
+     */
+    SparseField();
+
+    /**
+     * Copies the tiles with live cells of a packed field.
+     *
+     * @param field The packed field.
+     */
+    explicit SparseField(const PackedField &field);
+
+    /**
+     * Copies the cells into a packed field.
+     *
+     * @param field The field receiving the cells; it gets the size of this field.
+     */
+    void to_packed(PackedField &field) const;
+
+    /**
+     * Gets the number of rows and columns.
+     *
+     * @return The size of the field.
+     */
+    int get_size() const;
+
+    /**
+     * Gets the number of tiles with live cells.
+     *
+     * @return The occupied tiles.
+     */
+    size_t get_tile_count() const;
+
+    /**
+     * Gets the number of tiles covering the whole field.
+     *
+     * @return The occupied and empty tiles.
+     */
+    size_t get_tile_capacity() const;
+
+    /**
+     * Counts the live cells.
+     *
+     * @return The population.
+     */
+    long long population() const;
+
+    /**
+     * Estimates the heap memory of the tiles and of the table finding them.
+     *
+     * @return The number of bytes.
+     */
+    size_t memory_bytes() const;
+
+    /**
+     * Counts the tiles of a packed field that contain live cells.
+     *
+     * @param field The packed field.
+     * @return The occupied tiles.
+     */
+    static size_t count_occupied_tiles(const PackedField &field);
+
+    /**
+     * Computes the next generation into another sparse field.
+     *
+     * @param next The field receiving the next generation; its tiles are replaced.
+     * @param births Whether a dead cell with n live neighbors is born, for n = 0..8.
+     * @param survivals Whether a live cell with n live neighbors survives, for n = 0..8.
+     */
+    void step(SparseField &next, const std::array<bool, 9> &births, const std::array<bool, 9> &survivals);
+
+private:
+    using Tile = std::array<uint64_t, TILE>;
+
+    int size;                                 // Rows and columns of the field
+    int tiles_per_side;                       // Tiles per row of tiles, the stride of a packed field
+    std::unordered_map<uint32_t, Tile> tiles; // Tiles with live cells by row of tiles * tiles_per_side + column
+    std::vector<uint32_t> candidates;         // Scratch of step: tiles that may have live cells next
+
+    /**
+     * Computes the next generation of one tile.
+     *
+     * @param tile_row The row of tiles.
+     * @param tile_col The column of tiles.
+     * @param rule The rule from GameEngine::get_rule_counts().
+     * @param result The tile receiving the next generation.
+     * @return True if the tile has live cells.
+     */
+    bool step_tile(int tile_row, int tile_col, const GameEngine::RuleCounts &rule, Tile &result) const;
+};
+
+/**
+ * Class recording the history of generations with periodic keyframes and
+ * compressed XOR deltas between them, allowing random access to any
+ * recorded generation.
+ */
+class HistoryRecorder
+{
+public:
+    /**
+     * Constructor for the HistoryRecorder class.
+     *
+     * @param keyframe_interval The number of generations between keyframes.
+     */
+    explicit HistoryRecorder(int keyframe_interval = 32);
+
+    /**
+     * Records the current generation of the game state.
+     * Recording an already recorded generation discards the history after it.
+     *
+     * @param game The game state to record.
+     */
+    void record(const GameState &game);
+
+    /**
+     * Restores a recorded generation into the game state.
+     *
+     * @param generation The generation to restore.
+     * @param game The game state to update.
+     * @throws std::out_of_range If the generation was not recorded.
+     */
+    void seek(int generation, GameState &game) const;
+
+    /**
+     * Checks whether anything was recorded.
+     *
+     * @return True if there are no records.
+     */
+    bool empty() const;
+
+    /**
+     * Gets the first recorded generation.
+     *
+     * @return The generation number.
+     */
+    int get_first_generation() const;
+
+    /**
+     * Gets the last recorded generation.
+     *
+     * @return The generation number.
+     */
+    int get_last_generation() const;
+
+    /**
+     * Gets the number of generations between keyframes.
+     *
+     * @return The keyframe interval.
+     */
+    int get_keyframe_interval() const;
+
+    /**
+     * Gets the total size of the compressed records.
+     *
+     * @return The size in bytes.
+     */
+    size_t get_compressed_bytes() const;
+
+    /**
+     * Writes the recorded history to a file.
+     *
+     * @param file_name The name of the history file.
+     */
+    void save(const std::string &file_name) const;
+
+    /**
+     * Replaces the recorded history with the one stored in a file. The file is
+     * checked completely before anything is replaced.
+     *
+     * @param file_name The name of the history file.
+     * @param game The game the history will be restored into.
+     * @throws std::runtime_error If the file cannot be read, is corrupted or was recorded on another field or rule.
+     */
+    void load(const std::string &file_name, const GameState &game);
+
+    /**
+     * Compresses words with a run-length code for zero words.
+     *
+     * @param words The words to compress.
+     * @return The compressed bytes.
+     */
+    static std::vector<uint8_t> compress(std::span<const uint64_t> words);
+
+    /**
+     * Decompresses bytes produced by compress().
+     *
+     * @param data The compressed bytes.
+     * @param words The output words, already sized to the expected length.
+     */
+    static void decompress(const std::vector<uint8_t> &data, std::span<uint64_t> words);
+
+private:
+    struct Record
+    {
+        int generation;              // Generation number
+        bool keyframe;               // Whether data holds the full field or an XOR delta
+        std::vector<uint8_t> data;   // Compressed words
+        std::vector<uint8_t> states; // Compressed cell states under Generations rules, like data, else empty
+    };
+
+    int keyframe_interval;       // Number of generations between keyframes
+    int size;                    // Size of the recorded grid
+    std::vector<Record> records; // Records ordered by generation
+    PackedField previous;        // Last recorded generation
+    PackedWords previous_states; // Cell states of the last recorded generation, 8 per word
+
+    /**
+     * Reconstructs a recorded generation.
+     *
+     * @param generation The generation to reconstruct.
+     * @param states The array receiving the cell states, 8 per word, empty for two-state rules.
+     * @return The packed field of that generation.
+     */
+    PackedField reconstruct(int generation, PackedWords &states) const;
+};
+
+/**
+ * Class counting for every cell how many generations it was alive or how many
+ * times it changed. The counters are bit-sliced: bit plane k of a 64-cell word
+ * holds bit k of the 64 counters, so one generation adds a whole word of cells
+ * with a few word operations. Counters saturate at 65535.
+ */
+class HeatMap
+{
+public:
+    /**
+     * What the counters count.
+     */
+    enum class Mode
+    {
+        ALIVE, // Generations a cell was alive
+        FLIPS  // Generations a cell was born or died
+    };
+
+    static constexpr int PLANES = 16; // Bits per counter
+
+    /**
+     * Constructor starting the counts at the current generation of a game,
+     * which is not counted itself.
+     *
+     * @param mode What the counters count.
+     * @param start The game state.
+     */
+    HeatMap(Mode mode, const GameState &start);
+
+    /**
+     * Counts a computed generation.
+     *
+     * @param field The field of the generation, of the size of the start field.
+     * @throws std::invalid_argument If the field has another size.
+     */
+    void add(const PackedField &field);
+
+    /**
+     * Gets the counter of a cell.
+     *
+     * @param row The row of the cell.
+     * @param col The column of the cell.
+     * @return The count.
+     */
+    int get(int row, int col) const;
+
+    /**
+     * Gets the largest counter.
+     *
+     * @return The largest count.
+     */
+    int get_max() const;
+
+    /**
+     * Gets the number of counted generations.
+     *
+     * @return The number of generations.
+     */
+    long long get_generations() const;
+
+    /**
+     * Gets what the counters count.
+     *
+     * @return The mode.
+     */
+    Mode get_mode() const;
+
+    /**
+     * Writes the counters as a PGM image scaled to the largest count, or as
+     * CSV with one line per row if the file name ends with .csv.
+     *
+     * @param file_name The name of the .pgm or .csv file.
+     * @throws std::runtime_error If the file cannot be written.
+     */
+    void write_to_file(const std::string &file_name) const;
+
+private:
+    Mode mode;                    // What the counters count
+    int size;                     // Number of rows and columns
+    int stride;                   // Words per row
+    long long generations;        // Number of counted generations
+    std::vector<uint64_t> planes; // PLANES bit planes per word of the field
+    PackedField previous;         // Last counted generation in FLIPS mode
+};
+
+/**
+ * NUMA nodes of the machine with the CPUs the process may run on, read from
+ * sysfs. Nodes without such CPUs are left out; a machine without NUMA
+ * information is one node with every allowed CPU.
+ */
+class NumaTopology
+{
+public:
+    struct Node
+    {
+        int id;                // Number of the node
+        std::vector<int> cpus; // CPUs of the node the process may run on
+        long long memory_kib;  // Memory of the node, 0 if unknown
+    };
+
+    /**
+     * Reads the topology.
+     *
+     * @param root The directory with the node<n> directories.
+     */
+    explicit NumaTopology(const std::string &root = "/sys/devices/system/node");
+
+    /**
+     * Gets the nodes in the order of their numbers.
+     *
+     * @return The nodes, at least one.
+     */
+    const std::vector<Node> &get_nodes() const;
+
+    /**
+     * Formats the nodes, one line per node.
+     *
+     * @return The report.
+     */
+    std::string report() const;
+
+    /**
+     * Parses a CPU list of sysfs such as "0-3,8,10-11".
+     *
+     * @param list The CPU list.
+     * @return The CPUs in ascending order.
+     * @throws std::invalid_argument If the list is malformed.
+     */
+    static std::vector<int> parse_cpu_list(const std::string &list);
+
+private:
+    std::vector<Node> nodes; // Nodes with at least one CPU
+};
+
+/**
+ * Engine stepping a field on several threads, each owning a band of rows.
+ * Every worker keeps its band in two buffers of its own with a halo row above
+ * and below. Per generation it copies the two halo rows from the bands next
+ * to it and computes its rows with GameEngine::step_row, so the halo rows are
+ * the only data one worker reads from another; one barrier per generation
+ * separates the generations. With a NUMA policy, consecutive bands go to the
+ * same node, each worker is pinned to a CPU of its node and its buffers are
+ * placed on that node's memory.
+ */
+class ParallelEngine
+{
+public:
+    enum class NumaPolicy
+    {
+        OFF,         // Threads are not pinned and pages go wherever the kernel puts them
+        FIRST_TOUCH, // Threads are pinned and write their buffers first, which places them on their node
+        BIND         // Like FIRST_TOUCH, and the buffers are bound to the node with mbind before
+    };
+
+    struct Worker
+    {
+        int first_row; // First row of the band
+        int row_count; // Rows of the band
+        int node;      // NUMA node the band is meant for, -1 without a policy
+        int cpu;       // CPU the thread was pinned to in the last run, -1 if not pinned
+        bool bound;    // Whether mbind placed the buffers on the node in the last run
+    };
+
+    /**
+     * Constructor splitting the field into bands.
+     *
+     * @param state The game state to step.
+     * @param threads The number of worker threads; fields with fewer rows get one thread per row.
+     * @param policy How threads and buffers are placed.
+     * @param topology The NUMA nodes to place them on.
+     * @throws std::invalid_argument If the thread count is not positive or the rule has more than two states.
+     */
+    ParallelEngine(GameState &state, int threads, NumaPolicy policy, const NumaTopology &topology);
+
+    /**
+     * Computes a number of generations.
+     *
+     * @param generations The number of generations.
+     * @throws std::runtime_error If the buffers of a band cannot be allocated.
+     */
+    void run(int generations);
+
+    /**
+     * Gets the bands and their placement.
+     *
+     * @return One entry per worker.
+     */
+    const std::vector<Worker> &get_workers() const;
+
+    /**
+     * Formats the placement of the bands, one line per worker.
+     *
+     * @return The report.
+     */
+    std::string report_placement() const;
+
+private:
+    GameState &state;                         // State being stepped
+    NumaPolicy policy;                        // Placement of threads and buffers
+    std::vector<Worker> workers;              // Bands and their placement
+    std::vector<std::vector<int> > node_cpus; // CPUs of the node of every worker
+
+    /**
+     * Computes the generations of one band.
+     *
+     * @param index The index of the worker.
+     * @param generations The number of generations.
+     * @param bands The two buffers of every band, published by their workers.
+     * @param sync The barrier between generations.
+     * @param failed Set by a worker whose buffers could not be allocated.
+     * @param result The field receiving the rows of every band after the last generation.
+     */
+    void run_band(int index, int generations, std::vector<std::array<uint64_t *, 2> > &bands,
+                  std::barrier<> &sync, std::atomic<bool> &failed, PackedField &result);
+};
+
+/**
+ * Class for parsing command-line arguments.
+ */
+class ParserCommandLine
+{
+public:
+    /**
+     * Constructor for the ParserCommandLine class.
+     *
+     * @param argc The argument count.
+     * @param argv The argument vector.
+     */
+    ParserCommandLine(int argc, char **argv);
+
+    /**
+     * Parses the command-line arguments.
+     *
+     * @param argc The argument count.
+     * @param argv The argument vector.
+     */
+    void parse(int argc, char **argv);
+
+    /**
+     * Gets the mode of the program.
+     *
+     * @return The mode as a character.
+     */
+    char get_mode() const;
+
+    /**
+     * Gets the input file name.
+     *
+     * @return The input file name as a string, or the pattern directory or glob in batch mode.
+     */
+    std::string get_input_file() const;
+
+    /**
+     * Gets the output file name.
+     *
+     * @return The output file name as a string, or the output directory in batch mode.
+     */
+    std::string get_output_file() const;
+
+    /**
+     * Gets the number of iterations.
+     *
+     * @return The number of iterations as an integer.
+     */
+    int get_iterations() const;
+
+    /**
+     * Gets the history file name given with --record.
+     *
+     * @return The history file name, or an empty string if recording was not requested.
+     */
+    std::string get_record_file() const;
+
+    /**
+     * Checks whether the quiet batch mode was requested with -q or --quiet.
+     *
+     * @return True if the program must run without terminal I/O.
+     */
+    bool is_quiet() const;
+
+    /**
+     * Gets the interval of frames streamed to stdout with --frames.
+     *
+     * @return The number of generations between frames, or 0 if streaming was not requested.
+     */
+    int get_frame_interval() const;
+
+    /**
+     * Gets the downscaling factor of streamed frames given with --scale.
+     *
+     * @return The side of the cell block covered by one pixel.
+     */
+    int get_frame_scale() const;
+
+    /**
+     * Gets the memory budget of the undo history given with --undo-budget.
+     *
+     * @return The budget in megabytes, 0 disables undo.
+     */
+    int get_undo_budget() const;
+
+    /**
+     * Gets the socket path given with --serve.
+     *
+     * @return The socket path, or an empty string if the server mode was not requested.
+     */
+    std::string get_server_socket() const;
+
+    /**
+     * Gets the number of worker threads given with --workers.
+     *
+     * @return The number of workers, 0 means one per hardware thread.
+     */
+    int get_worker_count() const;
+
+    /**
+     * Gets the command script given with --script.
+     *
+     * @return The script file name, or an empty string if no script was given.
+     */
+    std::string get_script_file() const;
+
+    /**
+     * Gets the huge page policy given with --huge-pages.
+     *
+     * @return The policy for field buffers, transparent huge pages by default.
+     */
+    FieldArena::HugePages get_huge_pages() const;
+
+    /**
+     * Gets the store file given with --out-of-core.
+     *
+     * @return The store file name, or an empty string if the field is kept in memory.
+     */
+    std::string get_store_file() const;
+
+    /**
+     * Gets the report file given with --census.
+     *
+     * @return The census report file name, or an empty string if no census was requested.
+     */
+    std::string get_census_file() const;
+
+    /**
+     * Gets the heat map file given with --heat-map.
+     *
+     * @return The .pgm or .csv file name, or an empty string if no heat map was requested.
+     */
+    std::string get_heat_map_file() const;
+
+    /**
+     * Gets what the heat map counts, given with --heat-mode.
+     *
+     * @return The heat map mode, ALIVE by default.
+     */
+    HeatMap::Mode get_heat_mode() const;
+
+    /**
+     * Gets the number of threads stepping the field in bands, given with --threads.
+     *
+     * @return The thread count, 0 to step the field on the calling thread.
+     */
+    int get_thread_count() const;
+
+    /**
+     * Gets how the threads of --threads and their bands are placed, given with --numa.
+     *
+     * @return The NUMA policy, FIRST_TOUCH by default.
+     */
+    ParallelEngine::NumaPolicy get_numa_policy() const;
+
+    /**
+     * Checks whether the NUMA topology is to be reported, with --topology.
+     *
+     * @return True if the topology is reported.
+     */
+    bool is_topology_report() const;
+
+    /**
+     * Gets the built-in pattern given with --pattern, which replaces the random game.
+     *
+     * @return The name of the pattern, or an empty string to pick one of the bundled games.
+     */
+    std::string get_pattern_name() const;
+
+    /**
+     * Gets the trace file given with --trace, which is written when the program exits.
+     *
+     * @return The .json file name, or an empty string if the run is not traced.
+     */
+    std::string get_trace_file() const;
+
+private:
+    char mode;                              // Mode of the program (1, 2, 3, or 4 for batch)
+    std::string input_file;                 // Input file name
+    std::string output_file;                // Output file name
+    int iterations;                         // Number of iterations
+    std::string record_file;                // History file name for --record
+    bool quiet;                             // Batch mode without terminal I/O
+    int frame_interval;                     // Generations between streamed frames
+    int frame_scale;                        // Downscaling factor of streamed frames
+    int undo_budget;                        // Memory budget of the undo history in megabytes
+    std::string server_socket;              // Socket path for the server mode
+    int worker_count;                       // Number of worker threads
+    std::string script_file;                // Command script for --script
+    FieldArena::HugePages huge_pages;       // Huge page policy for field buffers
+    std::string store_file;                 // Field store for --out-of-core
+    std::string census_file;                // Object census report for --census
+    std::string heat_map_file;              // Heat map image or table for --heat-map
+    HeatMap::Mode heat_mode;                // Counters of the heat map
+    int thread_count;                       // Threads stepping the field in bands, 0 for the calling thread
+    ParallelEngine::NumaPolicy numa_policy; // Placement of the stepping threads and their bands
+    bool topology_report;                   // Whether --topology was given
+    std::string pattern_name;               // Built-in pattern for --pattern
+    std::string trace_file;                 // Chrome trace for --trace
+
+    /**
+     * Parses a positive integer value of an optional argument.
+     *
+     * @param value The value string.
+     * @param name The argument name used in error messages.
+     * @return The parsed number.
+     */
+    int parse_positive(const std::string &value, const std::string &name);
+
+    /**
+     * Parses an optional argument that is accepted in every mode.
+     *
+     * @param arg The argument to check.
+     * @return True if the argument was an optional one and has been consumed.
+     */
+    bool parse_extra_option(const std::string &arg);
+
+    /**
+     * Checks if the given file name has a .live extension.
+     *
+     * @param filename The file name to check.
+     * @return True if the file has a .live extension, false otherwise.
+     */
+    bool has_live_extension(const std::string &filename);
+
+    /**
+     * Parses the iterations argument.
+     *
+     * @param argc The argument count.
+     * @param argv The argument vector.
+     * @return True if parsing was successful, false otherwise.
+     */
+    bool parse_args_iterations(int argc, char **argv);
+
+    /**
+     * Parses the output file argument.
+     *
+     * @param argc The argument count.
+     * @param argv The argument vector.
+     * @return True if parsing was successful, false otherwise.
+     */
+    bool parse_args_output(int argc, char **argv);
+};
+
+/**
+ * Exception class for handling invalid commands.
+ */
+class InvalidCommandException : public std::runtime_error
+{
+public:
+    /**
+     * Constructor for the InvalidCommandException class.
+     *
+     * @param msg The error message.
+     */
+    explicit InvalidCommandException(const std::string &msg) : std::runtime_error(msg) {}
+};
+
+/**
+ * Class for parsing user input commands.
+ */
+class ParserCommands
+{
+public:
+    static const int MAX_REGION = 1 << 16; // Largest height and width of the region command
+
+private:
+    char command;                           // Command character
+    std::string filename;                   // File name for the dump, export, load and heatmap commands, or pattern name for load
+    int iterations;                         // Number of iterations
+    int keyframe_interval;                  // Keyframe interval for the record command
+    int generation;                         // Target generation for the goto command
+    int pan_rows;                           // Vertical shift for the pan command
+    int pan_cols;                           // Horizontal shift for the pan command
+    int zoom;                               // Zoom level for the zoom command
+    int frame_rate;                         // Frame rate for the run command
+    int scale;                              // Downscaling factor for the export command
+    int undo_steps;                         // Number of steps for the undo command
+    std::array<int, 4> region;              // Row, column, height and width for the region command
+    std::optional<HeatMap::Mode> heat_mode; // Counters of the heat command, empty to stop counting
+    std::optional<bool> trace_switch;       // Tracing on or off for the trace command, empty to write the trace
+
+    /**
+     * Parses an integer argument of a command.
+     *
+     * @param argument The argument string.
+     * @param command_name The command name used in error messages.
+     * @param allow_negative Whether negative numbers are accepted.
+     * @return The parsed number.
+     * @throws InvalidCommandException If the argument is not a valid number.
+     */
+    int parse_number(const std::string &argument, const std::string &command_name, bool allow_negative = false);
+
+    /**
+     * Checks if the given file name has a .live extension.
+     *
+     * @param filename The file name to check.
+     * @return True if the file has a .live extension, false otherwise.
+     */
+    static bool has_live_extension(const std::string &filename);
+
+public:
+    /**
+     * Constructor for the ParserCommands class.
+     */
+    ParserCommands();
+
+    /**
+     * Parses a user input command.
+     *
+     * @param input The input command as a string.
+     */
+    void parse_command(const std::string &input);
+
+    /**
+     * Gets the command character.
+     *
+     * @return The command as a character.
+     */
+    char get_command() const;
+
+    /**
+     * Gets the filename for the dump, export or load command.
+     *
+     * @return The filename as a string.
+     * @throws InvalidCommandException If the command is not 'dump', 'export' or 'load'.
+     */
+    const std::string &get_filename() const;
+
+    /**
+     * Checks whether the load command names a built-in pattern instead of a .live file.
+     *
+     * @return True if get_filename() is the name of a PatternLibrary pattern.
+     */
+    bool is_builtin_pattern() const;
+
+    /**
+     * Gets the number of iterations.
+     *
+     * @return The number of iterations as an integer.
+     * @throws InvalidCommandException If the command is not 'tick'.
+     */
+    int get_iterations() const;
+
+    /**
+     * Gets the keyframe interval.
+     *
+     * @return The keyframe interval as an integer.
+     * @throws InvalidCommandException If the command is not 'record'.
+     */
+    int get_keyframe_interval() const;
+
+    /**
+     * Gets the target generation.
+     *
+     * @return The generation as an integer.
+     * @throws InvalidCommandException If the command is not 'goto' or 'rewind'.
+     */
+    int get_generation() const;
+
+    /**
+     * Gets the number of steps to undo.
+     *
+     * @return The number of steps as an integer.
+     * @throws InvalidCommandException If the command is not 'undo'.
+     */
+    int get_undo_steps() const;
+
+    /**
+     * Gets the region to show.
+     *
+     * @return The row, column, height and width of the region.
+     * @throws InvalidCommandException If the command is not 'region'.
+     */
+    const std::array<int, 4> &get_region() const;
+
+    /**
+     * Gets what the heat command counts.
+     *
+     * @return The heat map mode, or nothing for "heat off".
+     * @throws InvalidCommandException If the command is not 'heat'.
+     */
+    std::optional<HeatMap::Mode> get_heat_mode() const;
+
+    /**
+     * Gets whether the trace command turns tracing on or off.
+     *
+     * @return True for "trace on", false for "trace off", or nothing when the trace is written to get_filename().
+     * @throws InvalidCommandException If the command is not 'trace'.
+     */
+    std::optional<bool> get_trace_switch() const;
+
+    /**
+     * Gets the vertical shift of the view.
+     *
+     * @return The number of cells to move down.
+     * @throws InvalidCommandException If the command is not 'pan'.
+     */
+    int get_pan_rows() const;
+
+    /**
+     * Gets the horizontal shift of the view.
+     *
+     * @return The number of cells to move right.
+     * @throws InvalidCommandException If the command is not 'pan'.
+     */
+    int get_pan_cols() const;
+
+    /**
+     * Gets the zoom level.
+     *
+     * @return The side of the cell block shown by one dot, or 0 for the full field view.
+     * @throws InvalidCommandException If the command is not 'zoom'.
+     */
+    int get_zoom() const;
+
+    /**
+     * Gets the frame rate of the continuous run.
+     *
+     * @return The maximal number of frames per second.
+     * @throws InvalidCommandException If the command is not 'run'.
+     */
+    int get_frame_rate() const;
+
+    /**
+     * Gets the downscaling factor of the exported image.
+     *
+     * @return The side of the cell block covered by one pixel.
+     * @throws InvalidCommandException If the command is not 'export'.
+     */
+    int get_scale() const;
+
+    /**
+     * Parses the dump command from the input.
+     *
+     * @param input The input string.
+     */
+    void parse_dump(const std::string &input);
+
+    /**
+     * Parses the tick command from the input.
+     *
+     * @param input The input string.
+     */
+    void parse_tick(const std::string &input);
+
+    /**
+     * Parses the exit command.
+     *
+     * @param input The input string.
+     */
+    void parse_exit(const std::string &input);
+
+    /**
+     * Parses the help command.
+     *
+     * @param input The input string.
+     */
+    void parse_help(const std::string &input);
+
+    /**
+     * Parses the record command from the input.
+     *
+     * @param input The input string.
+     */
+    void parse_record(const std::string &input);
+
+    /**
+     * Parses the goto command from the input.
+     *
+     * @param input The input string.
+     */
+    void parse_goto(const std::string &input);
+
+    /**
+     * Parses the pan command from the input.
+     *
+     * @param input The input string.
+     */
+    void parse_pan(const std::string &input);
+
+    /**
+     * Parses the zoom command from the input.
+     *
+     * @param input The input string.
+     */
+    void parse_zoom(const std::string &input);
+
+    /**
+     * Parses the run command from the input.
+     *
+     * @param input The input string.
+     */
+    void parse_run(const std::string &input);
+
+    /**
+     * Parses the stop command.
+     *
+     * @param input The input string.
+     */
+    void parse_stop(const std::string &input);
+
+    /**
+     * Parses the export command from the input.
+     *
+     * @param input The input string.
+     */
+    void parse_export(const std::string &input);
+
+    /**
+     * Parses the undo command from the input.
+     *
+     * @param input The input string.
+     */
+    void parse_undo(const std::string &input);
+
+    /**
+     * Parses the rewind command from the input.
+     *
+     * @param input The input string.
+     */
+    void parse_rewind(const std::string &input);
+
+    /**
+     * Parses the load command from the input.
+     *
+     * @param input The input string.
+     */
+    void parse_load(const std::string &input);
+
+    /**
+     * Parses the stats command.
+     *
+     * @param input The input string.
+     */
+    void parse_stats(const std::string &input);
+
+    /**
+     * Parses the region command from the input.
+     *
+     * @param input The input string.
+     */
+    void parse_region(const std::string &input);
+
+    /**
+     * Parses the census command.
+     *
+     * @param input The input string.
+     */
+    void parse_census(const std::string &input);
+
+    /**
+     * Parses the heat command from the input.
+     *
+     * @param input The input string.
+     */
+    void parse_heat(const std::string &input);
+
+    /**
+     * Parses the heatmap command from the input.
+     *
+     * @param input The input string.
+     */
+    void parse_heatmap(const std::string &input);
+
+    /**
+     * Parses the trace command from the input.
+     *
+     * @param input The input string.
+     */
+    void parse_trace(const std::string &input);
+};
+
+/**
+ * Class for parsing input from files.
+ */
+class ParserFile
+{
+private:
+    std::string file_name; // Name of the file
+
+public:
+    /**
+     * Constructor for the ParserFile class.
+     *
+     * @param file_name The name of the file to parse.
+     */
+    ParserFile(const std::string &file_name);
+
+    /**
+     * Parses the file and updates the game state.
+     *
+     * @param game_state A reference to the GameState object to be updated.
+     */
+    void parse(GameState &game_state);
+
+    /**
+     * Parses the file, passing the live cells to a callback instead of storing
+     * them in the game state, e.g. to fill a field that does not fit in memory.
+     *
+     * @param game_state A reference to the GameState object receiving the metadata.
+     * @param add_cell The function receiving the zero-based row and column of every live cell.
+     */
+    void parse(GameState &game_state, const std::function<void(int, int)> &add_cell);
+
+    /**
+     * Parses .live contents from a stream instead of the file, e.g. from memory.
+     *
+     * @param input The stream with the contents.
+     * @param game_state A reference to the GameState object receiving the metadata.
+     * @param add_cell The function receiving the zero-based row and column of every live cell.
+     */
+    void parse(std::istream &input, GameState &game_state, const std::function<void(int, int)> &add_cell);
+
+private:
+    /**
+     * Parses the B/S conditions from a line in the file.
+     *
+     * @param conditions The conditions string.
+     * @param game_state A reference to the GameState object to be updated.
+     */
+    void parse_conditions(const std::string &conditions, GameState &game_state);
+
+    /**
+     * Parses a condition string (e.g., B3 or S23) and updates the given condition set.
+     *
+     * @param condition_str The condition string.
+     * @param condition_set A set of integers to be updated.
+     */
+    void parse_condition_set(const std::string &condition_str, std::set<int> &condition_set);
+
+    /**
+     * Parses the coordinates from a line in the file.
+     *
+     * @param line The line containing the coordinates.
+     * @param add_cell The function receiving the zero-based row and column of every cell.
+     */
+    void parse_coordinates(const std::string &line, const std::function<void(int, int)> &add_cell);
+
+    /**
+     * Parses a "#D <row> <col> <state>" line with a dying cell of a Generations rule.
+     *
+     * @param line The line after "#D".
+     * @param game_state A reference to the GameState object to be updated.
+     */
+    void parse_dying_cell(const std::string &line, GameState &game_state);
+};
+
+/**
+ * Class for writing a game state to a .live file through a large buffer.
+ */
+class LiveFileWriter
+{
+public:
+    /**
+     * Constructor for the LiveFileWriter class.
+     *
+     * @param file_name The name of the file to write.
+     * @param buffer_size The size of the output buffer in bytes.
+     * @throws std::runtime_error If the file cannot be opened.
+     */
+    explicit LiveFileWriter(const std::string &file_name, size_t buffer_size = 1 << 20);
+
+    /**
+     * Destructor flushing the remaining buffered data.
+     */
+    ~LiveFileWriter();
+
+    /**
+     * Writes the game state in Life 1.06 format.
+     *
+     * @param game The game state to write.
+     * @throws std::runtime_error If writing fails.
+     */
+    void write(const GameState &game);
+
+    /**
+     * Writes the header lines: version, name, size and rule.
+     *
+     * @param game The game state with the metadata.
+     */
+    void write_header(const GameState &game);
+
+    /**
+     * Writes the live cells of consecutive packed rows, e.g. one band of a field
+     * kept on disk.
+     *
+     * @param rows The packed rows, stride words each.
+     * @param first_row The index of the first row in the field.
+     * @param row_count The number of rows.
+     * @param stride The number of words per row.
+     */
+    void write_rows(const uint64_t *rows, long long first_row, int row_count, int stride);
+
+    /**
+     * Writes the dying cells of a Generations rule as "#D <row> <col> <state>" lines.
+     *
+     * @param game The game state.
+     */
+    void write_dying_cells(const GameState &game);
+
+    /**
+     * Writes the buffered data to the file.
+     *
+     * @throws std::runtime_error If writing fails.
+     */
+    void flush();
+
+private:
+    std::string file_name;    // Name of the output file
+    std::ofstream file;       // Output file
+    std::vector<char> buffer; // Output buffer
+    size_t used;              // Number of bytes used in the buffer
+
+    /**
+     * Appends text to the buffer.
+     *
+     * @param text The text to append.
+     */
+    void append(const std::string &text);
+
+    /**
+     * Appends a number to the buffer.
+     *
+     * @param number The number to append.
+     */
+    void append_number(long long number);
+
+    /**
+     * Appends a coordinate line to the buffer.
+     *
+     * @param row The row of the cell.
+     * @param col The column of the cell.
+     */
+    void append_coordinates(long long row, long long col);
+};
+
+/**
+ * Patterns built into the program: the bundled games and a catalogue of
+ * well-known objects. The build turns their .live files into constexpr cell
+ * lists, which pack() lays out as the words of a packed field at compile
+ * time, so loading a pattern copies words and does not touch the filesystem.
+ */
+class PatternLibrary
+{
+public:
+    /**
+     * Pattern as it is stored in the program.
+     */
+    struct Pattern
+    {
+        std::string_view name;           // Name given to load and --pattern=, the stem of the file
+        std::string_view title;          // Universe name of the #N line
+        std::string_view version;        // Version of the #Life line
+        bool is_game;                    // Whether the pattern is one of the bundled games
+        int size;                        // Number of rows and columns
+        unsigned births;                 // Bit n is set if a dead cell with n live neighbors is born
+        unsigned survivals;              // Bit n is set if a live cell with n live neighbors survives
+        std::span<const uint64_t> words; // Rows in the layout of a packed field
+    };
+
+    /**
+     * Packs zero-based cell coordinates into the words of a packed field.
+     *
+     * @tparam Size The number of rows and columns of the field.
+     * @param cells The row and column of every live cell.
+     * @return The words of the rows, one after another.
+     * @throws std::out_of_range If a cell lies outside the field, which fails a constant evaluation.
+     */
+    template <int Size, size_t Count>
+    static constexpr std::array<uint64_t, static_cast<size_t>(Size) * ((Size + 63) / 64)>
+    pack(const std::array<std::array<int, 2>, Count> &cells)
+    {
+        constexpr int stride = (Size + 63) / 64;
+        std::array<uint64_t, static_cast<size_t>(Size) * stride> words{};
+        for (const std::array<int, 2> &cell : cells)
+        {
+            if (cell[0] < 0 || cell[0] >= Size || cell[1] < 0 || cell[1] >= Size)
+            {
+                throw std::out_of_range("A cell of the pattern lies outside the field");
+            }
+            words[static_cast<size_t>(cell[0]) * stride + (cell[1] >> 6)] |= uint64_t(1) << (cell[1] & 63);
+        }
+        return words;
+    }
+
+    /**
+     * Gets every built-in pattern, the games first, each group sorted by name.
+     *
+     * @return The patterns.
+     */
+    static std::span<const Pattern> get_patterns();
+
+    /**
+     * Finds a pattern by name.
+     *
+     * @param name The name, e.g. "glider".
+     * @return The pattern, or nullptr if there is none with this name.
+     */
+    static const Pattern *find(std::string_view name);
+
+    /**
+     * Replaces a game state with a built-in pattern.
+     *
+     * @param name The name of the pattern.
+     * @param game The game state receiving the pattern at generation 0.
+     * @throws std::invalid_argument If there is no pattern with this name.
+     */
+    static void load(std::string_view name, GameState &game);
+
+    /**
+     * Replaces a game state with a built-in pattern.
+     *
+     * @param pattern The pattern.
+     * @param game The game state receiving the pattern at generation 0.
+     */
+    static void load(const Pattern &pattern, GameState &game);
+
+    /**
+     * Picks one of the bundled games at random.
+     *
+     * @return The game.
+     */
+    static const Pattern &random_game();
+
+    /**
+     * Lists the names of the patterns, e.g. for error messages.
+     *
+     * @return The names separated by commas.
+     */
+    static std::string list_names();
+};
+
+/**
+ * Class keeping a bounded history of reverse deltas for undoing generations.
+ * Every step stores only the changed words of the packed field, so memory is
+ * proportional to the activity; the oldest steps are dropped when the memory
+ * budget is exceeded.
+ */
+class UndoHistory
+{
+public:
+    /**
+     * Constructor for the UndoHistory class.
+     *
+     * @param budget_bytes The maximal memory used by the deltas, 0 disables the history.
+     */
+    explicit UndoHistory(size_t budget_bytes = 64 << 20);
+
+    /**
+     * Forgets the history and starts it from the current generation.
+     *
+     * @param game The current game state.
+     */
+    void reset(const GameState &game);
+
+    /**
+     * Records a step to the current generation of the game state.
+     *
+     * @param game The game state after the step.
+     */
+    void record(const GameState &game);
+
+    /**
+     * Undoes the last steps.
+     *
+     * @param steps The number of steps to undo.
+     * @param game The game state to update.
+     * @return The number of steps undone, less than requested if the history ran out.
+     */
+    int undo(int steps, GameState &game);
+
+    /**
+     * Undoes the steps back to a generation.
+     *
+     * @param generation The generation to return to.
+     * @param game The game state to update.
+     * @throws std::out_of_range If the generation is not in the history.
+     */
+    void rewind(int generation, GameState &game);
+
+    /**
+     * Gets the oldest generation that can be restored.
+     *
+     * @return The generation number.
+     */
+    int get_oldest_generation() const;
+
+    /**
+     * Gets the memory used by the stored deltas.
+     *
+     * @return The size in bytes.
+     */
+    size_t get_memory_usage() const;
+
+private:
+    struct Entry
+    {
+        int generation;                // Generation restored by undoing the step
+        std::vector<uint32_t> indexes; // Indexes of the changed words
+        std::vector<uint64_t> bits;    // Flipped bits of the changed words
+        std::vector<uint32_t> cells;   // Indexes of the cells whose state changed under Generations rules
+        std::vector<uint8_t> states;   // XOR of the old and new states of those cells
+    };
+
+    size_t budget_bytes;                 // Maximal memory of the deltas
+    size_t used_bytes;                   // Memory used by the deltas
+    std::deque<Entry> entries;           // Steps from the oldest to the newest
+    PackedField current;                 // Field of the current generation
+    std::vector<uint8_t> current_states; // Cell states of the current generation, empty for two-state rules
+    int current_generation;              // Current generation
+
+    /**
+     * Computes the memory used by a step.
+     *
+     * @param entry The step.
+     * @return The size in bytes.
+     */
+    static size_t entry_bytes(const Entry &entry);
+};
+
+/**
+ * Class drawing the field on the terminal and redrawing only the cells that
+ * changed since the previous frame. Every frame is sent with a single write().
+ */
+class DiffRenderer
+{
+public:
+    /**
+     * Constructor for the DiffRenderer class.
+     *
+     * @param fd The file descriptor of the terminal.
+     */
+    explicit DiffRenderer(int fd = STDOUT_FILENO);
+
+    /**
+     * Draws the whole field starting at the cursor position.
+     * The cursor is left on the line below the field.
+     *
+     * @param field The field to draw.
+     */
+    void draw(const PackedField &field);
+
+    /**
+     * Redraws the cells that changed since the last drawn frame.
+     *
+     * @param field The new field.
+     * @param lines_below The number of lines between the line below the field and the cursor.
+     */
+    void update(const PackedField &field, int lines_below);
+
+    /**
+     * Builds the escape sequence drawing the whole field.
+     *
+     * @param field The field to draw.
+     * @return The frame to be written to the terminal.
+     */
+    const std::string &build_full(const PackedField &field);
+
+    /**
+     * Builds the escape sequence redrawing the changed cells and remembers the frame.
+     *
+     * @param field The new field.
+     * @param lines_below The number of lines between the line below the field and the cursor.
+     * @return The frame to be written to the terminal.
+     */
+    const std::string &build_update(const PackedField &field, int lines_below);
+
+private:
+    int fd;            // Terminal file descriptor
+    PackedField last;  // Last drawn field
+    bool has_last;     // Whether a frame has been drawn
+    std::string frame; // Output buffer for one frame
+
+    /**
+     * Writes the frame to the terminal with a single write() call.
+     */
+    void flush();
+
+    /**
+     * Appends a cursor movement escape sequence to the frame.
+     *
+     * @param count The number of lines or the column.
+     * @param code The final character of the sequence.
+     */
+    void append_escape(int count, char code);
+};
+
+/**
+ * Class mapping a region of the universe onto the terminal. Every character
+ * shows 2x4 dots in Unicode braille, and at zoom levels coarser than 1:1
+ * every dot pools a square block of cells.
+ */
+class Viewport
+{
+public:
+    /**
+     * Constructor for the Viewport class.
+     *
+     * @param width The width of the viewport in characters.
+     * @param height The height of the viewport in lines.
+     */
+    Viewport(int width = 80, int height = 24);
+
+    /**
+     * Sets the size of the viewport.
+     *
+     * @param new_width The width in characters.
+     * @param new_height The height in lines.
+     */
+    void set_dimensions(int new_width, int new_height);
+
+    /**
+     * Gets the width of the viewport.
+     *
+     * @return The width in characters.
+     */
+    int get_width() const;
+
+    /**
+     * Gets the height of the viewport.
+     *
+     * @return The height in lines.
+     */
+    int get_height() const;
+
+    /**
+     * Moves the viewport.
+     *
+     * @param rows The number of cells to move down (negative moves up).
+     * @param cols The number of cells to move right (negative moves left).
+     */
+    void pan(int rows, int cols);
+
+    /**
+     * Sets the zoom level keeping the center of the view in place.
+     *
+     * @param new_zoom The side of the cell block shown by one dot, a power of two.
+     * @throws std::invalid_argument If the zoom is not a power of two.
+     */
+    void set_zoom(int new_zoom);
+
+    /**
+     * Gets the zoom level.
+     *
+     * @return The side of the cell block shown by one dot.
+     */
+    int get_zoom() const;
+
+    /**
+     * Chooses the finest zoom level that shows the whole universe.
+     *
+     * @param field_size The size of the universe.
+     */
+    void fit(int field_size);
+
+    /**
+     * Sets the number of live cells a block needs to light its dot.
+     *
+     * @param cells The number of live cells.
+     */
+    void set_threshold(int cells);
+
+    /**
+     * Renders the visible region of the field.
+     *
+     * @param field The field to render.
+     * @return The frame as UTF-8 text, one line per viewport row.
+     */
+    const std::string &render(const PackedField &field);
+
+private:
+    int width;            // Width in characters
+    int height;           // Height in lines
+    long long origin_row; // Row of the top-left cell
+    long long origin_col; // Column of the top-left cell
+    int zoom;             // Side of the cell block shown by one dot
+    int threshold;        // Live cells needed to light a dot
+    std::string frame;    // Output buffer for one frame
+
+    /**
+     * Counts the live cells of a block with toroidal wrapping.
+     *
+     * @param field The field.
+     * @param row The top row of the block.
+     * @param col The left column of the block.
+     * @return The number of live cells.
+     */
+    int count_block(const PackedField &field, long long row, long long col) const;
+};
+
+/**
+ * Lock-free single-producer single-consumer triple buffer. The producer
+ * always has a slot to write into, and the consumer always gets the most
+ * recently published value; values published in between are dropped.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    /**
+     * Gets the slot the producer writes into.
+     *
+     * @return A reference to the back slot.
+     */
+    T &write_buffer()
+    {
+        return slots[back];
+    }
+
+    /**
+     * Publishes the back slot to the consumer.
+     */
+    void publish()
+    {
+        back = middle.exchange(back | DIRTY, std::memory_order_acq_rel) & INDEX;
+    }
+
+    /**
+     * Checks whether a published value has not been taken by the consumer yet.
+     *
+     * @return True if a value is pending.
+     */
+    bool has_pending() const
+    {
+        return (middle.load(std::memory_order_acquire) & DIRTY) != 0;
+    }
+
+    /**
+     * Takes the most recently published value, if there is a new one.
+     *
+     * @return True if read_buffer() now holds a new value.
+     */
+    bool acquire()
+    {
+        if (!has_pending())
+        {
+            return false;
+        }
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    /**
+     * Gets the slot the consumer reads from.
+     *
+     * @return A reference to the front slot.
+     */
+    const T &read_buffer() const
+    {
+        return slots[front];
+    }
+
+private:
+    static const int INDEX = 3; // Mask of the slot index
+    static const int DIRTY = 4; // Flag of an unread middle slot
+
+    std::array<T, 3> slots;     // Storage of the three slots
+    std::atomic<int> middle{1}; // Shared slot with the dirty flag
+    int back = 0;               // Slot owned by the producer
+    int front = 2;              // Slot owned by the consumer
+};
+
+/**
+ * Class running the simulation on one thread and drawing the published
+ * generations on another one at a capped frame rate, so that the simulation
+ * never waits on the terminal.
+ */
+class ContinuousRunner
+{
+public:
+    /**
+     * Constructor for the ContinuousRunner class.
+     *
+     * @param game The game state to simulate.
+     * @param fps The maximal number of frames drawn per second.
+     */
+    ContinuousRunner(GameState &game, int fps);
+
+    /**
+     * Destructor stopping the threads.
+     */
+    ~ContinuousRunner();
+
+    /**
+     * Registers a callback invoked on the simulation thread after every generation.
+     *
+     * @param callback The function receiving the updated game state.
+     */
+    void add_generation_callback(const std::function<void(const GameState &)> &callback);
+
+    /**
+     * Starts the simulation and rendering threads.
+     *
+     * @param render The function drawing a published generation.
+     */
+    void start(const std::function<void(const PackedField &, int)> &render);
+
+    /**
+     * Stops both threads and waits for them. The game state is left at the
+     * last computed generation.
+     */
+    void stop();
+
+    /**
+     * Gets the number of generations computed since start().
+     *
+     * @return The number of generations.
+     */
+    long long get_computed_generations() const;
+
+private:
+    struct Snapshot
+    {
+        PackedField field; // Packed copy of the field
+        int generation;    // Generation of the copy
+    };
+
+    GameState &game;                  // Simulated game state
+    int fps;                          // Maximal frame rate
+    std::atomic<bool> running;        // Whether the threads must keep running
+    std::atomic<long long> computed;  // Generations computed since start()
+    TripleBuffer<Snapshot> snapshots; // Generations handed to the renderer
+    std::thread simulation_thread;    // Thread computing generations
+    std::thread rendering_thread;     // Thread drawing generations
+    std::vector<std::function<void(const GameState &)> > generation_callbacks; // Per-generation observers
+
+    /**
+     * Computes generations until stopped.
+     */
+    void simulate();
+
+    /**
+     * Draws the published generations until stopped.
+     *
+     * @param render The function drawing a generation.
+     */
+    void render_frames(const std::function<void(const PackedField &, int)> &render);
+};
+
+/**
+ * Class computing the generations of a tick on a worker thread, so that the
+ * caller stays responsive and can show progress or cancel the tick. A
+ * cancelled tick stops at the next generation boundary and leaves the game
+ * state at the last computed generation.
+ */
+class TickRunner
+{
+public:
+    /**
+     * Constructor for the TickRunner class.
+     *
+     * @param game The game state to step.
+     */
+    explicit TickRunner(GameState &game);
+
+    /**
+     * Destructor cancelling the tick and waiting for the worker.
+     */
+    ~TickRunner();
+
+    /**
+     * Registers a callback invoked on the worker thread after every generation.
+     *
+     * @param callback The function receiving the updated game state.
+     */
+    void add_generation_callback(const std::function<void(const GameState &)> &callback);
+
+    /**
+     * Starts computing generations on the worker thread.
+     *
+     * @param generations The number of generations.
+     */
+    void start(int generations);
+
+    /**
+     * Asks the worker to stop after the current generation.
+     */
+    void cancel();
+
+    /**
+     * Waits until the tick finishes or the timeout passes.
+     *
+     * @param timeout The longest time to wait.
+     * @return True if the tick has finished.
+     */
+    bool wait_for(std::chrono::milliseconds timeout);
+
+    /**
+     * Waits for the worker to finish.
+     *
+     * @throws std::exception Whatever the engine threw on the worker thread.
+     */
+    void wait();
+
+    /**
+     * Gets the number of generations computed since start().
+     *
+     * @return The number of generations.
+     */
+    long long get_completed() const;
+
+    /**
+     * Checks whether the tick was cancelled.
+     *
+     * @return True if cancel() was called.
+     */
+    bool is_cancelled() const;
+
+    /**
+     * Formats the progress of the tick.
+     *
+     * @return A line with the generation, generations per second and the expected time left.
+     */
+    std::string format_progress() const;
+
+private:
+    GameState &game;                               // Game state being stepped
+    int requested;                                 // Generations of the tick
+    int first_generation;                          // Generation of the game at start()
+    std::chrono::steady_clock::time_point started; // Time of start()
+    std::atomic<bool> cancelled;                   // Set by cancel()
+    std::atomic<long long> completed;              // Generations computed since start()
+    std::mutex mutex;                              // Guards finished and error
+    std::condition_variable finished_changed;      // Signalled when the worker finishes
+    bool finished;                                 // Whether the worker has finished
+    std::exception_ptr error;                      // Exception thrown by the engine
+    std::thread worker;                            // Thread computing the generations
+    std::vector<std::function<void(const GameState &)> > generation_callbacks; // Per-generation observers
+};
+
+/**
+ * Class encoding the field as binary PBM (P4) or PGM (P5) images, optionally
+ * downscaled so that every pixel covers a square block of cells.
+ */
+class FrameExporter
+{
+public:
+    /**
+     * Constructor for the FrameExporter class.
+     *
+     * @param scale The side of the cell block covered by one pixel.
+     * @param grayscale True for PGM images showing the density of every block,
+     *                  false for PBM images where a block with any live cell is black.
+     */
+    explicit FrameExporter(int scale = 1, bool grayscale = false);
+
+    /**
+     * Encodes the field as an image.
+     *
+     * @param field The field to encode.
+     * @return The image file contents.
+     */
+    const std::string &encode(const PackedField &field);
+
+    /**
+     * Writes the field as an image file.
+     *
+     * @param field The field to write.
+     * @param file_name The name of the image file.
+     */
+    void write_to_file(const PackedField &field, const std::string &file_name);
+
+    /**
+     * Writes the field as an image to a file descriptor, e.g. a pipe to a video encoder.
+     *
+     * @param field The field to write.
+     * @param fd The file descriptor.
+     */
+    void write_to_fd(const PackedField &field, int fd);
+
+private:
+    int scale;         // Side of the cell block covered by one pixel
+    bool grayscale;    // Whether PGM is written instead of PBM
+    std::string frame; // Output buffer for one image
+};
+
+/**
+ * Class serving many game sessions to other processes over a Unix domain
+ * socket. Every request line is "<session> <command>", where the command is
+ * parsed by ParserCommands: load, tick, stats, region, dump or exit.
+ * Sessions share a pool of workers; long ticks are split into slices and
+ * sessions take turns, so one session cannot starve the others.
+ */
+class SimulationServer
+{
+public:
+    /**
+     * Constructor for the SimulationServer class.
+     *
+     * @param socket_path The path of the Unix domain socket.
+     * @param worker_count The number of worker threads.
+     */
+    SimulationServer(const std::string &socket_path, int worker_count);
+
+    /**
+     * Destructor stopping the server.
+     */
+    ~SimulationServer();
+
+    /**
+     * Opens the socket and starts accepting connections.
+     *
+     * @throws std::runtime_error If the socket cannot be opened.
+     */
+    void start();
+
+    /**
+     * Closes the socket and all connections and waits for the threads.
+     */
+    void stop();
+
+    /**
+     * Executes a request and waits for its response.
+     *
+     * @param request The request line.
+     * @return The response: "OK ..." or "ERR <message>" terminated by a newline,
+     *         followed by the region lines for the region command.
+     */
+    std::string handle_request(const std::string &request);
+
+    /**
+     * Gets the number of open sessions.
+     *
+     * @return The number of sessions.
+     */
+    size_t get_session_count() const;
+
+private:
+    static const long long SLICE_CELLS = 1 << 20; // Cell updates per tick slice
+    static const size_t MAX_REQUEST = 64 << 10;   // Longest request line in bytes
+
+    struct Job
+    {
+        ParserCommands command;             // Parsed command
+        int remaining = 0;                  // Generations left for a tick
+        std::promise<std::string> response; // Response for the connection
+    };
+
+    struct Session
+    {
+        GameState game;                         // Game of the session
+        std::deque<std::shared_ptr<Job> > jobs; // Jobs in arrival order
+        bool queued = false;                    // Whether the session is in the ready queue
+    };
+
+    std::string socket_path;   // Path of the Unix domain socket
+    int worker_count;          // Number of worker threads
+    int listen_fd;             // Listening socket
+    std::atomic<bool> running; // Whether the server accepts requests
+
+    mutable std::mutex mutex;                                  // Guards the fields below
+    std::condition_variable work_ready;                        // Signals queued sessions
+    std::map<std::string, std::shared_ptr<Session> > sessions; // Open sessions by name
+    std::deque<std::shared_ptr<Session> > ready;               // Sessions with pending jobs
+    std::set<int> connection_fds;                              // Open client sockets
+    std::vector<std::thread> workers;                          // Worker pool
+    std::map<std::thread::id, std::thread> connections;        // Connection threads not joined yet
+    std::vector<std::thread::id> finished_connections;         // Connection threads that returned, joined by the acceptor
+    std::thread acceptor;                                      // Thread accepting connections
+
+    /**
+     * Takes sessions from the ready queue and executes their jobs.
+     */
+    void run_worker();
+
+    /**
+     * Executes a job or one slice of a long tick.
+     *
+     * @param session The session of the job.
+     * @param job The job.
+     * @return True if the job is finished and its response was set.
+     */
+    bool execute_slice(Session &session, Job &job);
+
+    /**
+     * Accepts connections until the server stops.
+     */
+    void accept_connections();
+
+    /**
+     * Reads requests from a connection and writes the responses.
+     *
+     * @param fd The client socket.
+     */
+    void serve_connection(int fd);
+};
+
+/**
+ * Class executing a sequence of commands from a script file or a pipe without
+ * prompts or screen clearing. Consecutive ticks are coalesced into one engine
+ * call, and dumps are written with LiveFileWriter.
+ */
+class ScriptRunner
+{
+public:
+    /**
+     * Constructor for the ScriptRunner class.
+     *
+     * @param game The game the script works on.
+     * @param output The stream receiving the stats and region output.
+     */
+    ScriptRunner(GameState &game, std::ostream &output);
+
+    /**
+     * Adds a callback invoked after every generation, e.g. to record the run,
+     * and with the new field after a load.
+     *
+     * @param callback The function to call with the updated game state.
+     */
+    void add_generation_callback(const std::function<void(const GameState &)> &callback);
+
+    /**
+     * Executes the script until its end or an exit command. Empty lines and
+     * lines starting with '#' are skipped.
+     *
+     * @param script The stream with one command per line.
+     * @throws InvalidCommandException If a command is invalid or not supported in scripts.
+     * @throws std::runtime_error If a file cannot be read or written.
+     */
+    void run(std::istream &script);
+
+    /**
+     * Gets the number of engine calls made so far.
+     *
+     * @return The number of engine calls.
+     */
+    long long get_engine_calls() const;
+
+private:
+    GameState &game;                                                           // Game the script works on
+    std::ostream &output;                                                      // Stream for the command output
+    std::vector<std::function<void(const GameState &)> > generation_callbacks; // Callbacks run after every generation
+    long long pending_ticks;                                                   // Ticks not yet passed to the engine
+    long long engine_calls;                                                    // Number of engine calls made
+    std::unique_ptr<HeatMap> heat_map;                                         // Counters of the heat command, null while off
+
+    /**
+     * Advances the game by all pending ticks in one engine call.
+     */
+    void flush_ticks();
+
+    /**
+     * Executes a parsed command other than tick.
+     *
+     * @param command The parsed command.
+     * @return False if the script must stop.
+     */
+    bool execute(const ParserCommands &command);
+};
+
+/**
+ * Class running one pattern file per job over a directory or glob of patterns
+ * on a pool of threads. Jobs are ordered from the largest field to the smallest
+ * and dealt to per-thread queues; an idle thread steals the smallest job from
+ * another queue, so a few big patterns do not leave cores idle at the tail.
  */
-class GameState
+class BatchRunner
 {
-private:
-    std::string game_version;   // Version of the game
-    std::string universe_name;  // Name of the universe
-    int size;                   // Size of the grid
-    int count_of_iterations;    // Number of iterations to simulate
-    std::set<int> B_conditions; // Birth conditions
-    std::set<int> S_conditions; // Survival conditions
-    Field field;
-
 public:
     /**
-     * Default constructor for initializing the game state.
+     * Result of one pattern of the batch.
      */
-    GameState();
+    struct Job
+    {
+        std::string input_file;   // Pattern file
+        std::string output_file;  // File with the final generation
+        long long cells = 0;      // Field cells, used to order the jobs
+        double seconds = 0;       // Time spent on loading, simulating and writing
+        long long population = 0; // Live cells of the final generation
+        std::string error;        // Error message, empty on success
+    };
 
     /**
-     * Destructor for the GameState class.
+     * Constructor for the BatchRunner class.
+     *
+     * @param generations The number of generations computed for every pattern.
+     * @param output_dir The directory receiving the final generations.
+     * @param thread_count The number of threads.
      */
-    ~GameState();
+    BatchRunner(int generations, const std::string &output_dir, int thread_count);
 
     /**
-     * Gets the game version.
+     * Lists the .live files of a directory, or the files matching a glob pattern.
      *
-     * @return The version of the game as a string.
+     * @param source The directory or glob pattern.
+     * @return The sorted file names.
+     * @throws std::runtime_error If the directory cannot be read.
      */
-    std::string get_game_version() const;
+    static std::vector<std::string> find_patterns(const std::string &source);
 
     /**
-     * Gets the universe name.
+     * Runs all patterns and waits for them.
      *
-     * @return The name of the universe as a string.
+     * @param input_files The pattern files.
+     * @throws std::invalid_argument If two pattern files have the same name, so their results would overwrite each other.
      */
-    std::string get_universe_name() const;
+    void run(const std::vector<std::string> &input_files);
 
     /**
-     * Gets the size of the grid.
+     * Gets the results in the order of the input files.
      *
-     * @return The size of the grid as an integer.
+     * @return The results of the last run.
      */
-    int get_size() const;
+    const std::vector<Job> &get_jobs() const;
 
     /**
-     * Gets the number of iterations.
+     * Writes the results as CSV: input, output, cells, seconds, population, error.
+     * The text columns are quoted, so file names and messages may contain commas and quotes.
      *
-     * @return The number of iterations as an integer.
+     * @param csv_file The name of the summary file.
+     * @throws std::runtime_error If the file cannot be written.
      */
-    int get_count_of_iterations() const;
+    void write_summary(const std::string &csv_file) const;
+
+private:
+    struct WorkQueue
+    {
+        std::mutex mutex;        // Guards the job indices
+        std::deque<size_t> jobs; // Indices of jobs, largest first
+    };
+
+    int generations;        // Generations per pattern
+    std::string output_dir; // Directory of the final generations
+    int thread_count;       // Number of threads
+    std::vector<Job> jobs;  // Results of the last run
 
     /**
-     * Gets the birth conditions.
+     * Quotes a text column of the summary, doubling the quotes inside.
      *
-     * @return A set of integers representing birth conditions.
+     * @param value The text.
+     * @return The quoted CSV field.
      */
-    std::set<int> get_B_conditions() const;
+    static std::string csv_field(const std::string &value);
 
     /**
-     * Gets the survival conditions.
+     * Reads the field size from the header of a pattern file without parsing the cells.
      *
-     * @return A set of integers representing survival conditions.
+     * @param file_name The pattern file.
+     * @return The number of cells, 0 if the header has no size.
      */
-    std::set<int> get_S_conditions() const;
+    static long long estimate_cells(const std::string &file_name);
 
     /**
-     * Gets the field representing the game state.
+     * Takes a job from the own queue, or steals one from another queue.
      *
-     * @return A 2D vector representing the grid.
+     * @param queues The queues of all threads.
+     * @param own The index of the calling thread.
+     * @param job Receives the job index.
+     * @return False when no job is left.
      */
-    std::vector<std::vector<bool> > get_field() const;
+    static bool take_job(std::vector<WorkQueue> &queues, size_t own, size_t &job);
 
     /**
-     * Sets the game version.
+     * Loads, simulates and writes one pattern.
      *
-     * @param version The new version of the game.
+     * @param job The job to run.
+     * @param buffer The scratch field of the calling thread.
      */
-    void set_game_version(const std::string &version);
+    void run_job(Job &job, PackedField &buffer) const;
+};
 
+/**
+ * Class simulating a field kept in a file instead of memory, for universes
+ * larger than RAM. The store holds a header with the metadata followed by the
+ * packed rows. Every generation sweeps the field in bands of rows into a new
+ * store: the next band is read ahead and the finished one is written behind on
+ * other threads, so only four bands are in memory at any time.
+ */
+class OutOfCoreEngine
+{
+public:
     /**
-     * Sets the universe name.
+     * Opens a store created by import_live() or create().
      *
-     * @param name The new universe name.
+     * @param store_file The name of the store.
+     * @param band_rows The number of rows per band, 0 for bands of about 8 MiB.
+     * @throws std::runtime_error If the store cannot be opened or is not a store.
      */
-    void set_universe_name(const std::string &name);
+    explicit OutOfCoreEngine(const std::string &store_file, int band_rows = 0);
 
     /**
-     * Sets the size of the grid.
+     * Destructor closing the store.
+     */
+    ~OutOfCoreEngine();
+
+    OutOfCoreEngine(const OutOfCoreEngine &) = delete;
+    OutOfCoreEngine &operator=(const OutOfCoreEngine &) = delete;
+
+    /**
+     * Creates a store from a .live file without loading the field into memory.
      *
-     * @param new_size The new size of the grid.
+     * @param live_file The name of the .live file.
+     * @param store_file The name of the store.
+     * @throws std::runtime_error If a file cannot be read or written.
      */
-    void set_size(int new_size);
+    static void import_live(const std::string &live_file, const std::string &store_file);
 
     /**
-     * Sets the number of iterations.
+     * Creates a store from a game in memory.
      *
-     * @param iterations The number of iterations to set.
+     * @param game The game to store.
+     * @param store_file The name of the store.
+     * @throws std::runtime_error If the store cannot be written.
      */
-    void set_count_of_iterations(int iterations);
+    static void create(const GameState &game, const std::string &store_file);
 
     /**
-     * Sets the birth conditions.
+     * Computes generations on disk.
      *
-     * @param conditions A set of integers representing new birth conditions.
+     * @param generations The number of generations.
+     * @throws std::runtime_error If reading or writing the store fails.
      */
-    void set_B_conditions(const std::set<int> &conditions);
+    void run(int generations);
 
     /**
-     * Sets the survival conditions.
+     * Writes the field as a .live file, one band at a time.
      *
-     * @param conditions A set of integers representing new survival conditions.
+     * @param live_file The name of the .live file.
+     * @throws std::runtime_error If a file cannot be read or written.
      */
-    void set_S_conditions(const std::set<int> &conditions);
+    void export_live(const std::string &live_file) const;
 
     /**
-     * Sets the field representing the game state.
+     * Gets the metadata of the field: size, rule and generation, without any cells.
      *
-     * @param new_field A 2D vector representing the new grid.
+     * @return The game state holding the metadata.
      */
-    void set_field(const Field &new_field);
-};
+    const GameState &get_state() const;
 
-/**
- * Class for simulating and updating the game state.
- */
-class GameEngine
-{
-public:
     /**
-     * Constructor for the GameEngine class.
+     * Gets the number of rows per band.
      *
-     * @param ReceivedGameState A reference to the GameState object.
-     * @param iterations The number of iterations to simulate.
+     * @return The number of rows per band.
      */
-    GameEngine(GameState &ReceivedGameState, int iterations);
+    int get_band_rows() const;
+
+private:
+    static constexpr size_t BAND_BYTES = 8 << 20; // Default size of a band
+
+    std::string store_file;        // Name of the store
+    int fd;                        // Open store
+    GameState state;               // Metadata of the field
+    int band_rows;                 // Rows per band
+    std::array<bool, 9> births;    // Birth lookup table
+    std::array<bool, 9> survivals; // Survival lookup table
 
     /**
-     * Updates the game state by computing the next state of the field.
+     * Writes the store header.
+     *
+     * @param fd The store.
+     * @param game The metadata to write.
      */
-    void UpdateGameState();
+    static void write_header(int fd, const GameState &game);
 
     /**
-     * Counts the number of neighboring cells that are alive.
+     * Reads rows from a store, wrapping around the field.
      *
-     * @param field The current field as a 2D vector.
-     * @param x The x-coordinate of the cell.
-     * @param y The y-coordinate of the cell.
-     * @return The count of live neighbors.
+     * @param fd The store.
+     * @param first_row The first row, may be -1 or past the end.
+     * @param row_count The number of rows.
+     * @param rows The buffer receiving the packed rows.
      */
-    int countNeighbors(const Field &field, int x, int y);
+    void read_rows(int fd, long long first_row, int row_count, uint64_t *rows) const;
 
-private:
-    GameState &CurrentGameState;       // Reference to GameState object
-    int received_number_of_iterations; // Number of iterations to perform
+    /**
+     * Computes one generation into a new store and replaces the old one.
+     */
+    void step_generation();
 };
 
 /**
- * Class for parsing command-line arguments.
+ * Class listing the objects of a field. Live cells are split into islands of
+ * 8-connected cells with a union-find over the runs of live cells of every
+ * row. Every island is brought to a canonical orientation under rotation and
+ * reflection, identical islands are counted together, and every distinct
+ * island is classified once by stepping it alone.
  */
-class ParserCommandLine
+class Census
 {
 public:
     /**
-     * Constructor for the ParserCommandLine class.
-     *
-     * @param argc The argument count.
-     * @param argv The argument vector.
+     * Behavior of an island stepped in isolation.
      */
-    ParserCommandLine(int argc, char **argv);
+    enum class Kind
+    {
+        STILL_LIFE, // Does not change
+        OSCILLATOR, // Returns to the same cells after the period
+        SPACESHIP,  // Returns to the same shape shifted after the period
+        OTHER       // Changes shape, grows or dies within the period limit
+    };
 
     /**
-     * Parses the command-line arguments.
-     *
-     * @param argc The argument count.
-     * @param argv The argument vector.
+     * Distinct object found in the field. Islands count together in any rotation or
+     * reflection, so dx and dy are the displacement of the canonical picture in rows,
+     * not the direction in which any island of the field moves.
      */
-    void parse(int argc, char **argv);
+    struct Object
+    {
+        std::string name;              // Common name, empty if unknown
+        Kind kind = Kind::OTHER;       // Behavior in isolation
+        int period = 0;                // Period of oscillators and spaceships
+        int dx = 0;                    // Column displacement of the canonical picture per period
+        int dy = 0;                    // Row displacement of the canonical picture per period
+        int population = 0;            // Live cells
+        long long count = 0;           // Number of islands with this shape
+        std::vector<std::string> rows; // Canonical picture of 'O' and '.' characters
+    };
 
     /**
-     * Gets the mode of the program.
+     * Constructor for the Census class.
      *
-     * @return The mode as a character.
+     * @param max_period The number of generations an island is stepped to classify it.
      */
-    char get_mode() const;
+    explicit Census(int max_period = 32);
 
     /**
-     * Gets the input file name.
+     * Counts the objects of a field, replacing the previous result.
      *
-     * @return The input file name as a string.
+     * @param field The field.
+     * @param B_conditions The birth conditions used to classify islands.
+     * @param S_conditions The survival conditions used to classify islands.
      */
-    std::string get_input_file() const;
+    void take(const PackedField &field, const std::set<int> &B_conditions, const std::set<int> &S_conditions);
 
     /**
-     * Gets the output file name.
+     * Gets the distinct objects, the most frequent first.
      *
-     * @return The output file name as a string.
+     * @return The objects.
      */
-    std::string get_output_file() const;
+    const std::vector<Object> &get_objects() const;
 
     /**
-     * Gets the number of iterations.
+     * Gets the number of islands.
      *
-     * @return The number of iterations as an integer.
+     * @return The number of islands.
      */
-    int get_iterations() const;
-
-private:
-    char mode;               // Mode of the program (1, 2, or 3)
-    std::string input_file;  // Input file name
-    std::string output_file; // Output file name
-    int iterations;          // Number of iterations
+    long long get_island_count() const;
 
     /**
-     * Checks if the given file name has a .live extension.
+     * Formats the result as a table.
      *
-     * @param filename The file name to check.
-     * @return True if the file has a .live extension, false otherwise.
+     * @param max_objects The number of objects listed, the rest is summarized in one line.
+     * @return One line per object after a header line.
      */
-    bool has_live_extension(const std::string &filename);
+    std::string format(size_t max_objects = std::numeric_limits<size_t>::max()) const;
 
     /**
-     * Parses the iterations argument.
+     * Gets the name of a kind.
      *
-     * @param argc The argument count.
-     * @param argv The argument vector.
-     * @return True if parsing was successful, false otherwise.
+     * @param kind The kind.
+     * @return The name, e.g. "still life".
      */
-    bool parse_args_iterations(int argc, char **argv);
+    static std::string kind_name(Kind kind);
+
+private:
+    int max_period;              // Generations an island is stepped
+    std::vector<Object> objects; // Distinct objects, the most frequent first
+    long long island_count;      // Number of islands
 
     /**
-     * Parses the output file argument.
+     * Steps an island alone and fills in its kind, period and displacement.
      *
-     * @param argc The argument count.
-     * @param argv The argument vector.
-     * @return True if parsing was successful, false otherwise.
+     * @param object The object with its canonical picture.
+     * @param B_conditions The birth conditions.
+     * @param S_conditions The survival conditions.
      */
-    bool parse_args_output(int argc, char **argv);
+    void classify(Object &object, const std::set<int> &B_conditions, const std::set<int> &S_conditions) const;
 };
 
 /**
- * Exception class for handling invalid commands.
+ * Engine for patterns with little activity, e.g. a glider gun in a large empty
+ * field. It keeps the number of live neighbors of every cell and the cells
+ * that changed in the last generation; a generation only looks at the
+ * neighborhoods of those cells and updates the counts around the cells that
+ * change, so its cost grows with the number of changes instead of the area.
+ * The counts stay valid between runs as long as only the engine changes the
+ * game state; they are rebuilt when the generation of the state differs.
  */
-class InvalidCommandException : public std::runtime_error
+class ChangeListEngine
 {
 public:
     /**
-     * Constructor for the InvalidCommandException class.
+     * Constructor building the neighbor counts of the game state.
      *
-     * @param msg The error message.
+     * @param game The game state, stepped in place.
+     * @throws std::invalid_argument If the rule has dying cell states or births without neighbors (B0).
      */
-    explicit InvalidCommandException(const std::string &msg) : std::runtime_error(msg) {}
-};
+    explicit ChangeListEngine(GameState &game);
 
-/**
- * Class for parsing user input commands.
- */
-class ParserCommands
-{
-private:
-    char command;         // Command character
-    std::string filename; // File name for the dump command
-    int iterations;       // Number of iterations
+    /**
+     * Computes generations of the game state.
+     *
+     * @param generations The number of generations.
+     */
+    void run(int generations);
 
     /**
-     * Checks if the given file name has a .live extension.
+     * Gets the number of cells that changed in the last generation.
      *
-     * @param filename The file name to check.
-     * @return True if the file has a .live extension, false otherwise.
+     * @return The number of changes.
      */
-    bool has_live_extension(const std::string &filename);
+    size_t get_change_count() const;
+
+private:
+    GameState &game;                // Game state stepped in place
+    int size;                       // Number of rows and columns
+    std::array<bool, 9> births;     // Whether a dead cell with n live neighbors is born
+    std::array<bool, 9> survivals;  // Whether a live cell with n live neighbors survives
+    std::vector<uint8_t> counts;    // Live neighbors of every cell, row by row
+    std::vector<uint64_t> alive;    // Bitmap of the live cells, row by row without padding
+    std::vector<uint64_t> queued;   // Bitmap of the cells already in candidates
+    std::vector<size_t> changes;    // Cells that changed in the last generation
+    std::vector<size_t> candidates; // Cells that may change in the next generation
+    std::vector<size_t> flips;      // Cells changing in the current generation
+    int counted_generation;         // Generation the counts belong to
 
-public:
     /**
-     * Constructor for the ParserCommands class.
+     * Rebuilds the neighbor counts and marks every live cell as changed.
      */
-    ParserCommands();
+    void rebuild();
 
     /**
-     * Parses a user input command.
-     *
-     * @param input The input command as a string.
+     * Computes one generation.
      */
-    void parse_command(const std::string &input);
+    void step();
 
     /**
-     * Gets the command character.
+     * Adds a value to the counts of the eight neighbors of a cell.
      *
-     * @return The command as a character.
+     * @param cell The index of the cell, row by row.
+     * @param delta 1 for a cell that was born, -1 for a cell that died.
      */
-    char get_command() const;
+    void add_to_neighbors(size_t cell, int delta);
+};
 
+/**
+ * @class GameInterface
+ * @brief Manages the interaction between the user and the Game of Life system.
+ */
+class GameInterface
+{
+private:
     /**
-     * Gets the filename for the dump command.
+     * @brief Starts the game with the provided command-line arguments.
      *
-     * @return The filename as a string.
-     * @throws InvalidCommandException If the command is not 'dump'.
+     * @param argc Number of command-line arguments.
+     * @param argv Array of command-line arguments.
      */
-    const std::string &get_filename() const;
+
+    void start_game(int argc, char **argv);
 
     /**
-     * Gets the number of iterations.
+     * @brief Starts recording the history of the game.
      *
-     * @return The number of iterations as an integer.
-     * @throws InvalidCommandException If the command is not 'tick'.
+     * @param game The game state whose current generation becomes the first record.
+     * @param keyframe_interval The number of generations between keyframes.
      */
-    int get_iterations() const;
+    void start_recording(const GameState &game, int keyframe_interval);
 
     /**
-     * Parses the dump command from the input.
+     * @brief Redraws the field in place after it has changed.
      *
-     * @param input The input string.
+     * @param game The game state to display.
+     * @param lines_below The number of lines printed below the field since the last frame.
      */
-    void parse_dump(const std::string &input);
+    void refresh_field(const GameState &game, int lines_below = 1);
 
     /**
-     * Parses the tick command from the input.
+     * @brief Draws a frame over the previous one with the active renderer.
      *
-     * @param input The input string.
+     * @param field The field to draw.
+     * @param lines_below The number of lines printed below the field since the last frame.
      */
-    void parse_tick(const std::string &input);
+    void draw_frame(const PackedField &field, int lines_below);
 
     /**
-     * Parses the exit command.
+     * @brief Runs the simulation continuously until the user enters stop or presses Ctrl-C.
      *
-     * @param input The input string.
+     * @param game The game state to simulate.
+     * @param fps The maximal number of frames drawn per second.
      */
-    void parse_exit(const std::string &input);
+    void run_continuously(GameState &game, int fps);
 
     /**
-     * Parses the help command.
+     * @brief Advances the game on a worker thread. A tick that takes longer than
+     * a moment shows a progress line until it finishes or the user enters stop
+     * or presses Ctrl-C, which leaves the game at the last computed generation.
+     * Other commands entered meanwhile run after the tick.
      *
-     * @param input The input string.
+     * @param game The game state to advance.
+     * @param generations The number of generations.
      */
-    void parse_help(const std::string &input);
-};
+    void run_ticks(GameState &game, int generations);
 
-/**
- * Class for parsing input from files.
- */
-class ParserFile
-{
-private:
-    std::string file_name; // Name of the file
+    /**
+     * @brief Passes a computed generation to the history and the recorder.
+     *
+     * @param game The game state after the generation.
+     */
+    void observe_generation(const GameState &game);
 
-public:
     /**
-     * Constructor for the ParserFile class.
+     * @brief Draws the field for the first time, through the viewport if it
+     * does not fit into the terminal.
      *
-     * @param file_name The name of the file to parse.
+     * @param game The game state to display.
      */
-    ParserFile(const std::string &file_name);
+    void show_field(const GameState &game);
 
     /**
-     * Parses the file and updates the game state.
+     * @brief Switches between the full field view and the viewport.
      *
-     * @param game_state A reference to the GameState object to be updated.
+     * @param game The game state to display.
+     * @param use_viewport True to show the field through the viewport.
      */
-    void parse(GameState &game_state);
+    void switch_view(const GameState &game, bool use_viewport);
 
-private:
     /**
-     * Parses the B/S conditions from a line in the file.
+     * @brief Runs the game without any terminal I/O.
      *
-     * @param conditions The conditions string.
-     * @param game_state A reference to the GameState object to be updated.
+     * @param game The game state to fill.
+     * @param parser_command_line Command-line arguments parser.
+     * @return The exit code of the run.
      */
-    void parse_conditions(const std::string &conditions, GameState &game_state);
+    int run_batch(GameState &game, ParserCommandLine &parser_command_line);
 
     /**
-     * Parses a condition string (e.g., B3 or S23) and updates the given condition set.
+     * @brief Serves game sessions over a socket until interrupted.
      *
-     * @param condition_str The condition string.
-     * @param condition_set A set of integers to be updated.
+     * @param parser_command_line Command-line arguments parser.
+     * @return The exit code of the server.
      */
-    void parse_condition_set(const std::string &condition_str, std::set<int> &condition_set);
+    int run_server(ParserCommandLine &parser_command_line);
 
     /**
-     * Parses the coordinates from a line in the file.
+     * @brief Executes commands from a script without prompts or screen clearing.
      *
-     * @param line The line containing the coordinates.
-     * @param game_state A reference to the GameState object to be updated.
+     * @param game The game state the commands work on.
+     * @param parser_command_line Command-line arguments parser.
+     * @param script The stream with the commands.
+     * @return The exit code of the script.
      */
-    void parse_coordinates(const std::string &line, GameState &game_state);
-};
+    int run_script(GameState &game, ParserCommandLine &parser_command_line, std::istream &script);
 
-/**
- * @class GameInterface
- * @brief Manages the interaction between the user and the Game of Life system.
- */
-class GameInterface
-{
-private:
     /**
-     * @brief Starts the game with the provided command-line arguments.
+     * @brief Runs the batch subcommand over a directory or glob of patterns.
      *
-     * @param argc Number of command-line arguments.
-     * @param argv Array of command-line arguments.
+     * @param parser_command_line Command-line arguments parser.
+     * @return The exit code of the batch.
      */
+    int run_batch_directory(ParserCommandLine &parser_command_line);
 
-    void start_game(int argc, char **argv);
+    /**
+     * @brief Runs the iterations on a field kept on disk instead of in memory.
+     *
+     * @param parser_command_line Command-line arguments parser.
+     * @return The exit code of the run.
+     */
+    int run_out_of_core(ParserCommandLine &parser_command_line);
 
-    int is_it_exit; // The flag for an exit
+    int is_it_exit;                          // The flag for an exit
+    HistoryRecorder recorder;                // History of the played generations
+    bool is_recording;                       // The flag for recording the history
+    int exit_code;                           // Exit code of the program
+    DiffRenderer renderer;                   // Renderer of the field in interactive modes
+    Viewport viewport;                       // Pan and zoom view for fields larger than the terminal
+    bool is_viewport_active;                 // The flag for showing the field through the viewport
+    UndoHistory undo_history;                // Reverse deltas for the undo and rewind commands
+    std::unique_ptr<HeatMap> heat_map;       // Activity counters, null while the heat command is off
+    std::string trace_file;                  // Chrome trace written on exit, empty without --trace
+    std::deque<std::string> queued_commands; // Commands typed during a tick, run after it
 
 public:
+    static const int EXIT_OK = 0;            // The run finished successfully
+    static const int EXIT_RUNTIME_ERROR = 1; // The simulation failed
+    static const int EXIT_USAGE_ERROR = 2;   // Invalid command-line arguments
+    static const int EXIT_INPUT_ERROR = 3;   // The input file is missing or malformed
+    static const int EXIT_OUTPUT_ERROR = 4;  // The output could not be written
+
     /**
      * @brief Constructs the GameInterface and initializes the game.
      *
@@ -465,10 +3940,35 @@ public:
      */
     void save_to_file(const GameState &game, const std::string &output_file);
 
+    /**
+     * @brief Writes the object census of the field to a file.
+     *
+     * @param game The game state.
+     * @param census_file The report file name.
+     * @throws std::runtime_error If the file cannot be written.
+     */
+    static void write_census(const GameState &game, const std::string &census_file);
+
+    /**
+     * @brief Runs the iterations of the command line on the threads of --threads.
+     *
+     * @param game The game state.
+     * @param parser_command_line The parsed command line.
+     * @param report The stream receiving the topology and band placement with --topology.
+     */
+    static void run_parallel(GameState &game, const ParserCommandLine &parser_command_line, std::ostream &report);
+
     /**
      * @brief Manages user input by reading and sanitizing it.
      *
      * @return A sanitized string of user input.
      */
     std::string manage_input();
+
+    /**
+     * @brief Gets the exit code of the program.
+     *
+     * @return One of the EXIT_* codes.
+     */
+    int get_exit_code() const;
 };
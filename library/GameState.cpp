@@ -8,7 +8,11 @@ GameState::GameState()
       count_of_iterations(0),
       B_conditions(),
       S_conditions(),
-      field() {}
+      state_count(2),
+      field(),
+      states(),
+      storage(Storage::DENSE),
+      storage_reason() {}
 
 // Destructor
 GameState::~GameState() {}
@@ -44,11 +48,128 @@ std::set<int> GameState::get_S_conditions() const
     return S_conditions;
 }
 
+int GameState::get_state_count() const
+{
+    return state_count;
+}
+
+int GameState::get_cell_state(int row, int col) const
+{
+    if (!states.empty())
+    {
+        return states[static_cast<size_t>(row) * size + col];
+    }
+    return field.get_size() == size && field.get(row, col) ? 1 : 0;
+}
+
+const std::vector<uint8_t> &GameState::get_cell_states() const
+{
+    return states;
+}
+
+std::vector<uint8_t> GameState::copy_cell_states() const
+{
+    if (state_count <= 2)
+    {
+        return {};
+    }
+    if (!states.empty())
+    {
+        return states;
+    }
+    std::vector<uint8_t> copy(static_cast<size_t>(size) * size);
+    for (int row = 0; row < size; ++row)
+    {
+        for (int col = 0; col < size; ++col)
+        {
+            copy[static_cast<size_t>(row) * size + col] = static_cast<uint8_t>(get_cell_state(row, col));
+        }
+    }
+    return copy;
+}
+
 std::vector<std::vector<bool> > GameState::get_field() const
+{
+    return field.to_field();
+}
+
+const PackedField &GameState::get_packed_field() const
 {
     return field;
 }
 
+long long GameState::get_population() const
+{
+    return field.population();
+}
+
+std::string GameState::get_rule_string() const
+{
+    std::string rule = "B";
+    for (int condition : B_conditions)
+    {
+        rule += std::to_string(condition);
+    }
+    rule += "/S";
+    for (int condition : S_conditions)
+    {
+        rule += std::to_string(condition);
+    }
+    if (state_count > 2)
+    {
+        rule += "/C" + std::to_string(state_count);
+    }
+    return rule;
+}
+
+GameState::Storage GameState::get_storage() const
+{
+    return storage;
+}
+
+const std::string &GameState::get_storage_reason() const
+{
+    return storage_reason;
+}
+
+std::string GameState::get_stats() const
+{
+    std::string stats = "generation=" + std::to_string(count_of_iterations) +
+                        " population=" + std::to_string(get_population()) +
+                        " size=" + std::to_string(size) +
+                        " rule=" + get_rule_string() +
+                        " storage=" + (storage == Storage::SPARSE ? "sparse" : "dense");
+    if (!storage_reason.empty())
+    {
+        stats += " (" + storage_reason + ")";
+    }
+    return stats;
+}
+
+std::string GameState::get_region(int row, int col, int height, int width) const
+{
+    std::string text;
+    if (size == 0 || field.get_size() != size)
+    {
+        return text;
+    }
+
+    // Wrapping repeats the field beyond its size
+    height = std::clamp(height, 0, size);
+    width = std::clamp(width, 0, size);
+    text.reserve(static_cast<size_t>(height) * (width + 1));
+    for (int r = 0; r < height; ++r)
+    {
+        int cells_row = ((row + r) % size + size) % size;
+        for (int c = 0; c < width; ++c)
+        {
+            text += field.get(cells_row, ((col + c) % size + size) % size) ? 'O' : '.';
+        }
+        text += '\n';
+    }
+    return text;
+}
+
 // Setters
 void GameState::set_game_version(const std::string &version)
 {
@@ -80,7 +201,104 @@ void GameState::set_S_conditions(const std::set<int> &conditions)
     S_conditions = conditions;
 }
 
+void GameState::set_state_count(int count)
+{
+    if (count < 2 || count > 256)
+    {
+        throw std::invalid_argument("Invalid state count " + std::to_string(count) + ": Must be from 2 to 256.");
+    }
+    state_count = count;
+
+    // Dying cells beyond the new count are dead
+    if (state_count == 2)
+    {
+        states.clear();
+    }
+    for (uint8_t &state : states)
+    {
+        state = state < state_count ? state : 0;
+    }
+}
+
+// A new field has no dying cells
 void GameState::set_field(const std::vector<std::vector<bool> > &new_field)
+{
+    field = PackedField(new_field);
+    states.clear();
+}
+
+void GameState::set_field(const PackedField &new_field)
 {
     field = new_field;
+    states.clear();
+}
+
+void GameState::set_cell(int row, int col, bool alive)
+{
+    if (row < 0 || row >= size || col < 0 || col >= size)
+    {
+        throw std::out_of_range("Cell " + std::to_string(row + 1) + " " + std::to_string(col + 1) + " is outside the field.");
+    }
+    if (field.get_size() != size)
+    {
+        field = PackedField(size);
+    }
+    field.set(row, col, alive);
+    if (!states.empty())
+    {
+        states[static_cast<size_t>(row) * size + col] = alive ? 1 : 0;
+    }
+}
+
+void GameState::swap_field(PackedField &other)
+{
+    std::swap(field, other);
+    states.clear();
+}
+
+void GameState::set_cell_state(int row, int col, int state)
+{
+    if (state < 0 || state >= state_count)
+    {
+        throw std::out_of_range("Invalid state " + std::to_string(state) + " of cell " + std::to_string(row + 1) + " " +
+                                std::to_string(col + 1) + " for " + std::to_string(state_count) + " states.");
+    }
+    set_cell(row, col, state == 1);
+    if (state_count > 2)
+    {
+        allocate_cell_states();
+        states[static_cast<size_t>(row) * size + col] = static_cast<uint8_t>(state);
+    }
+}
+
+void GameState::swap_cells(PackedField &other_field, std::vector<uint8_t> &other_states)
+{
+    std::swap(field, other_field);
+    std::swap(states, other_states);
+}
+
+void GameState::allocate_cell_states()
+{
+    if (states.size() == static_cast<size_t>(size) * size)
+    {
+        return;
+    }
+    if (field.get_size() != size)
+    {
+        field = PackedField(size);
+    }
+    states.assign(static_cast<size_t>(size) * size, 0);
+    for (int row = 0; row < size; ++row)
+    {
+        for (int col = 0; col < size; ++col)
+        {
+            states[static_cast<size_t>(row) * size + col] = field.get(row, col) ? 1 : 0;
+        }
+    }
+}
+
+void GameState::set_storage(Storage new_storage, const std::string &reason)
+{
+    storage = new_storage;
+    storage_reason = reason;
 }
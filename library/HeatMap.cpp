@@ -0,0 +1,153 @@
+#include "GameOfLife.hpp"
+
+// Constructor: starts with all counters at zero
+HeatMap::HeatMap(Mode mode, const GameState &start)
+    : mode(mode),
+      size(start.get_size()),
+      stride((start.get_size() + 63) / 64),
+      generations(0),
+      planes(static_cast<size_t>(size) * stride * PLANES, 0),
+      previous()
+{
+    if (mode == Mode::FLIPS)
+    {
+        // A field without any live cell has no storage yet
+        const PackedField &field = start.get_packed_field();
+        previous = field.get_size() == size ? field : PackedField(size);
+    }
+}
+
+void HeatMap::add(const PackedField &field)
+{
+    if (field.get_size() != size)
+    {
+        throw std::invalid_argument("The heat map has size " + std::to_string(size) + ", the field " +
+                                    std::to_string(field.get_size()) + ".");
+    }
+
+    const PackedWords &cells = field.get_words();
+    PackedWords &last = previous.get_words();
+    uint64_t *counters = planes.data();
+    for (size_t w = 0; w < cells.size(); ++w)
+    {
+        uint64_t carry = cells[w];
+        if (mode == Mode::FLIPS)
+        {
+            carry ^= last[w];
+            last[w] = cells[w];
+        }
+
+        // Ripple-carry addition of one to the 64 counters of the word selected by carry
+        uint64_t *bits = counters + w * PLANES;
+        for (int k = 0; k < PLANES && carry != 0; ++k)
+        {
+            uint64_t overflow = bits[k] & carry;
+            bits[k] ^= carry;
+            carry = overflow;
+        }
+
+        // Counters that wrapped around go back to the largest value
+        if (carry != 0)
+        {
+            for (int k = 0; k < PLANES; ++k)
+            {
+                bits[k] |= carry;
+            }
+        }
+    }
+    ++generations;
+}
+
+int HeatMap::get(int row, int col) const
+{
+    const uint64_t *bits = &planes[(static_cast<size_t>(row) * stride + (col >> 6)) * PLANES];
+    int count = 0;
+    for (int k = 0; k < PLANES; ++k)
+    {
+        count |= static_cast<int>((bits[k] >> (col & 63)) & 1) << k;
+    }
+    return count;
+}
+
+int HeatMap::get_max() const
+{
+    // The largest counter has the highest plane with a bit left among the candidates of the planes above
+    int max = 0;
+    for (size_t w = 0; w < planes.size(); w += PLANES)
+    {
+        uint64_t candidates = ~uint64_t(0);
+        int value = 0;
+        for (int k = PLANES - 1; k >= 0; --k)
+        {
+            uint64_t with_bit = candidates & planes[w + k];
+            if (with_bit != 0)
+            {
+                candidates = with_bit;
+                value |= 1 << k;
+            }
+        }
+        max = std::max(max, value);
+    }
+    return max;
+}
+
+long long HeatMap::get_generations() const
+{
+    return generations;
+}
+
+HeatMap::Mode HeatMap::get_mode() const
+{
+    return mode;
+}
+
+void HeatMap::write_to_file(const std::string &file_name) const
+{
+    std::ofstream file(file_name, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("It couldn't open file for write: " + file_name);
+    }
+
+    std::string out;
+    bool csv = file_name.size() > 4 && file_name.compare(file_name.size() - 4, 4, ".csv") == 0;
+    if (csv)
+    {
+        for (int row = 0; row < size; ++row)
+        {
+            for (int col = 0; col < size; ++col)
+            {
+                if (col > 0)
+                {
+                    out += ',';
+                }
+                out += std::to_string(get(row, col));
+            }
+            out += '\n';
+        }
+    }
+    else
+    {
+        // The largest count is white; more than 255 needs two bytes per pixel, most significant first
+        int max = std::max(get_max(), 1);
+        out = "P5\n" + std::to_string(size) + " " + std::to_string(size) + "\n" + std::to_string(max) + "\n";
+        for (int row = 0; row < size; ++row)
+        {
+            for (int col = 0; col < size; ++col)
+            {
+                int count = get(row, col);
+                if (max > 255)
+                {
+                    out += static_cast<char>(count >> 8);
+                }
+                out += static_cast<char>(count & 0xFF);
+            }
+        }
+    }
+
+    file.write(out.data(), static_cast<std::streamsize>(out.size()));
+    if (!file)
+    {
+        throw std::runtime_error("It couldn't write to file: " + file_name);
+    }
+}
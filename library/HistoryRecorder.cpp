@@ -0,0 +1,409 @@
+#include "GameOfLife.hpp"
+
+namespace
+{
+    const char HISTORY_MAGIC[4] = {'G', 'O', 'L', 'H'};
+
+    void write_varint(std::vector<uint8_t> &out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<uint8_t>(value) | 0x80);
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    uint64_t read_varint(const std::vector<uint8_t> &data, size_t &pos)
+    {
+        uint64_t value = 0;
+        for (int shift = 0; pos < data.size(); shift += 7)
+        {
+            uint8_t byte = data[pos++];
+            value |= uint64_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+            {
+                return value;
+            }
+        }
+        throw std::runtime_error("Corrupted history record.");
+    }
+
+    template <typename T>
+    void write_value(std::ofstream &file, T value)
+    {
+        file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    template <typename T>
+    T read_value(std::ifstream &file)
+    {
+        T value{};
+        if (!file.read(reinterpret_cast<char *>(&value), sizeof(value)))
+        {
+            throw std::runtime_error("Unexpected end of history file.");
+        }
+        return value;
+    }
+
+    // Reads a length and that many bytes, without trusting the length beyond the end of the file
+    std::vector<uint8_t> read_bytes(std::ifstream &file, uint64_t file_size)
+    {
+        uint64_t length = read_value<uint64_t>(file);
+        if (length > file_size - static_cast<uint64_t>(file.tellg()))
+        {
+            throw std::runtime_error("Unexpected end of history file.");
+        }
+        std::vector<uint8_t> bytes(length);
+        if (!file.read(reinterpret_cast<char *>(bytes.data()), bytes.size()))
+        {
+            throw std::runtime_error("Unexpected end of history file.");
+        }
+        return bytes;
+    }
+
+    // Puts 8 cell states in a word, so that they compress like the field
+    PackedWords pack_states(const std::vector<uint8_t> &states)
+    {
+        PackedWords words((states.size() + 7) / 8);
+        for (size_t i = 0; i < states.size(); ++i)
+        {
+            words[i / 8] |= uint64_t(states[i]) << (8 * (i % 8));
+        }
+        return words;
+    }
+
+    std::vector<uint8_t> unpack_states(const PackedWords &words, int size)
+    {
+        if (words.empty())
+        {
+            return {};
+        }
+        std::vector<uint8_t> states(static_cast<size_t>(size) * size);
+        for (size_t i = 0; i < states.size(); ++i)
+        {
+            states[i] = static_cast<uint8_t>(words[i / 8] >> (8 * (i % 8)));
+        }
+        return states;
+    }
+}
+
+// Constructor: sets the number of generations between keyframes
+HistoryRecorder::HistoryRecorder(int keyframe_interval)
+    : keyframe_interval(keyframe_interval),
+      size(0),
+      records(),
+      previous(),
+      previous_states()
+{
+    if (keyframe_interval <= 0)
+    {
+        throw std::invalid_argument("Keyframe interval must be a positive integer.");
+    }
+}
+
+void HistoryRecorder::record(const GameState &game)
+{
+    int generation = game.get_count_of_iterations();
+    PackedWords current_states = pack_states(game.copy_cell_states());
+
+    if (!records.empty())
+    {
+        if (game.get_size() != size || current_states.size() != previous_states.size() ||
+            generation <= records.front().generation ||
+            generation > records.back().generation + 1)
+        {
+            // Not a continuation of the recorded run: start a new one
+            records.clear();
+        }
+        else if (generation <= records.back().generation)
+        {
+            // The run continues from an earlier generation: drop the old future
+            previous = reconstruct(generation - 1, previous_states);
+            records.erase(records.begin() + (generation - records.front().generation), records.end());
+        }
+    }
+
+    PackedField current(game.get_packed_field());
+    Record record{generation, false, {}, {}};
+
+    if (records.empty() || (generation - records.front().generation) % keyframe_interval == 0)
+    {
+        size = game.get_size();
+        record.keyframe = true;
+        record.data = compress(current.get_words());
+        record.states = compress(current_states);
+    }
+    else
+    {
+        // Store only the cells that flipped since the previous generation
+        PackedWords delta = current.get_words();
+        const PackedWords &before = previous.get_words();
+        for (size_t i = 0; i < delta.size(); ++i)
+        {
+            delta[i] ^= before[i];
+        }
+        record.data = compress(delta);
+
+        PackedWords state_delta = current_states;
+        for (size_t i = 0; i < state_delta.size(); ++i)
+        {
+            state_delta[i] ^= previous_states[i];
+        }
+        record.states = compress(state_delta);
+    }
+
+    records.push_back(std::move(record));
+    previous = std::move(current);
+    previous_states = std::move(current_states);
+}
+
+void HistoryRecorder::seek(int generation, GameState &game) const
+{
+    PackedWords words;
+    PackedField field = reconstruct(generation, words);
+    std::vector<uint8_t> states = unpack_states(words, size);
+    if (game.get_state_count() <= 2)
+    {
+        // The game switched to a rule without dying cells
+        states.clear();
+    }
+    game.set_size(size);
+    game.swap_cells(field, states);
+    game.set_count_of_iterations(generation);
+}
+
+PackedField HistoryRecorder::reconstruct(int generation, PackedWords &states) const
+{
+    if (records.empty() || generation < records.front().generation || generation > records.back().generation)
+    {
+        throw std::out_of_range("Generation " + std::to_string(generation) + " was not recorded.");
+    }
+
+    // Load the nearest keyframe at or before the generation and replay the deltas
+    size_t index = generation - records.front().generation;
+    size_t key = index - index % keyframe_interval;
+
+    PackedField field(size);
+    PackedWords &words = field.get_words();
+    decompress(records[key].data, words);
+
+    // Records of a Generations rule carry the cell states as well
+    size_t state_words = records[key].states.empty() ? 0 : (static_cast<size_t>(size) * size + 7) / 8;
+    states.assign(state_words, 0);
+    decompress(records[key].states, states);
+
+    PackedWords delta(std::max(words.size(), state_words));
+    for (size_t i = key + 1; i <= index; ++i)
+    {
+        decompress(records[i].data, std::span<uint64_t>(delta.data(), words.size()));
+        for (size_t w = 0; w < words.size(); ++w)
+        {
+            words[w] ^= delta[w];
+        }
+        decompress(records[i].states, std::span<uint64_t>(delta.data(), state_words));
+        for (size_t w = 0; w < state_words; ++w)
+        {
+            states[w] ^= delta[w];
+        }
+    }
+    return field;
+}
+
+bool HistoryRecorder::empty() const
+{
+    return records.empty();
+}
+
+int HistoryRecorder::get_first_generation() const
+{
+    if (records.empty())
+    {
+        throw std::logic_error("History is empty.");
+    }
+    return records.front().generation;
+}
+
+int HistoryRecorder::get_last_generation() const
+{
+    if (records.empty())
+    {
+        throw std::logic_error("History is empty.");
+    }
+    return records.back().generation;
+}
+
+int HistoryRecorder::get_keyframe_interval() const
+{
+    return keyframe_interval;
+}
+
+size_t HistoryRecorder::get_compressed_bytes() const
+{
+    size_t bytes = 0;
+    for (const Record &record : records)
+    {
+        bytes += record.data.size() + record.states.size();
+    }
+    return bytes;
+}
+
+// Format: a run of zero words and a run of literal words, repeated
+std::vector<uint8_t> HistoryRecorder::compress(std::span<const uint64_t> words)
+{
+    std::vector<uint8_t> out;
+    size_t i = 0;
+    while (i < words.size())
+    {
+        size_t zeros = i;
+        while (zeros < words.size() && words[zeros] == 0)
+        {
+            ++zeros;
+        }
+        size_t literals = zeros;
+        while (literals < words.size() && words[literals] != 0)
+        {
+            ++literals;
+        }
+
+        write_varint(out, zeros - i);
+        write_varint(out, literals - zeros);
+        for (size_t w = zeros; w < literals; ++w)
+        {
+            for (int b = 0; b < 8; ++b)
+            {
+                out.push_back(static_cast<uint8_t>(words[w] >> (8 * b)));
+            }
+        }
+        i = literals;
+    }
+    return out;
+}
+
+void HistoryRecorder::decompress(const std::vector<uint8_t> &data, std::span<uint64_t> words)
+{
+    size_t pos = 0;
+    size_t w = 0;
+    while (pos < data.size())
+    {
+        uint64_t zeros = read_varint(data, pos);
+        uint64_t literals = read_varint(data, pos);
+        if (w + zeros + literals > words.size() || pos + literals * 8 > data.size())
+        {
+            throw std::runtime_error("Corrupted history record.");
+        }
+
+        std::fill(words.begin() + w, words.begin() + w + zeros, 0);
+        w += zeros;
+        for (uint64_t l = 0; l < literals; ++l, ++w)
+        {
+            uint64_t word = 0;
+            for (int b = 0; b < 8; ++b)
+            {
+                word |= uint64_t(data[pos++]) << (8 * b);
+            }
+            words[w] = word;
+        }
+    }
+    std::fill(words.begin() + w, words.end(), 0);
+}
+
+void HistoryRecorder::save(const std::string &file_name) const
+{
+    std::ofstream file(file_name, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("It couldn't open file for write: " + file_name);
+    }
+
+    file.write(HISTORY_MAGIC, sizeof(HISTORY_MAGIC));
+    write_value<int32_t>(file, size);
+    write_value<int32_t>(file, keyframe_interval);
+    write_value<uint64_t>(file, records.size());
+    for (const Record &record : records)
+    {
+        write_value<int32_t>(file, record.generation);
+        write_value<uint8_t>(file, record.keyframe);
+        write_value<uint64_t>(file, record.data.size());
+        file.write(reinterpret_cast<const char *>(record.data.data()), record.data.size());
+        write_value<uint64_t>(file, record.states.size());
+        file.write(reinterpret_cast<const char *>(record.states.data()), record.states.size());
+    }
+
+    if (!file)
+    {
+        throw std::runtime_error("It couldn't write history to: " + file_name);
+    }
+}
+
+void HistoryRecorder::load(const std::string &file_name, const GameState &game)
+{
+    std::ifstream file(file_name, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("It couldn't open the file!");
+    }
+    uint64_t file_size = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+
+    char magic[sizeof(HISTORY_MAGIC)];
+    if (!file.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), HISTORY_MAGIC))
+    {
+        throw std::runtime_error("Not a history file: " + file_name);
+    }
+
+    int loaded_size = read_value<int32_t>(file);
+    int loaded_interval = read_value<int32_t>(file);
+    uint64_t count = read_value<uint64_t>(file);
+    if (loaded_size < 0 || loaded_interval <= 0)
+    {
+        throw std::runtime_error("Corrupted history file: " + file_name);
+    }
+    if (loaded_size != game.get_size())
+    {
+        throw std::runtime_error("History file " + file_name + " was recorded on a field of size " +
+                                 std::to_string(loaded_size) + ", not " + std::to_string(game.get_size()) + ".");
+    }
+
+    // reconstruct() relies on consecutive generations and a keyframe every keyframe_interval records
+    bool has_states = game.get_state_count() > 2;
+    std::vector<Record> loaded;
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        Record record;
+        record.generation = read_value<int32_t>(file);
+        record.keyframe = read_value<uint8_t>(file) != 0;
+        if (i == 0 ? record.generation < 0 : record.generation != loaded.back().generation + 1)
+        {
+            throw std::runtime_error("Generations of history file " + file_name + " are not consecutive.");
+        }
+        if (record.keyframe != (i % loaded_interval == 0))
+        {
+            throw std::runtime_error("History file " + file_name + " needs a keyframe every " +
+                                     std::to_string(loaded_interval) + " records, starting with the first.");
+        }
+        record.data = read_bytes(file, file_size);
+        record.states = read_bytes(file, file_size);
+        if (record.states.empty() == has_states)
+        {
+            throw std::runtime_error("Cell states of history file " + file_name + " do not match the rule of the game.");
+        }
+        loaded.push_back(std::move(record));
+    }
+
+    // Every record must decompress to a whole field, so that seek() cannot fail later
+    PackedField field(loaded_size);
+    PackedWords &words = field.get_words();
+    PackedWords states(has_states ? (static_cast<size_t>(loaded_size) * loaded_size + 7) / 8 : 0);
+    for (const Record &record : loaded)
+    {
+        decompress(record.data, words);
+        decompress(record.states, states);
+    }
+
+    size = loaded_size;
+    keyframe_interval = loaded_interval;
+    records = std::move(loaded);
+    previous_states.clear();
+    previous = records.empty() ? PackedField() : reconstruct(records.back().generation, previous_states);
+}
@@ -0,0 +1,140 @@
+#include "GameOfLife.hpp"
+
+// Constructor: opens the output file and reserves the output buffer
+LiveFileWriter::LiveFileWriter(const std::string &file_name, size_t buffer_size)
+    : file_name(file_name),
+      file(file_name, std::ios::binary),
+      buffer(std::max<size_t>(buffer_size, 64)),
+      used(0)
+{
+    if (!file.is_open())
+    {
+        throw std::runtime_error("It couldn't open file for write: " + file_name);
+    }
+}
+
+LiveFileWriter::~LiveFileWriter()
+{
+    try
+    {
+        flush();
+    }
+    catch (const std::exception &)
+    {
+        // Errors are reported by an explicit flush() or write() call
+    }
+}
+
+void LiveFileWriter::write(const GameState &game)
+{
+    TraceZone zone("LiveFileWriter::write");
+    write_header(game);
+
+    const PackedField &field = game.get_packed_field();
+    write_rows(field.get_words().data(), 0, field.get_size(), field.get_stride());
+    write_dying_cells(game);
+
+    flush();
+}
+
+void LiveFileWriter::write_header(const GameState &game)
+{
+    append("#Life ");
+    append(game.get_game_version());
+    append("\n#N ");
+    append(game.get_universe_name());
+    append("\n#Size ");
+    append_number(game.get_size());
+    append("\n#R ");
+    append(game.get_rule_string());
+    append("\n");
+}
+
+void LiveFileWriter::write_rows(const uint64_t *rows, long long first_row, int row_count, int stride)
+{
+    for (int row = 0; row < row_count; ++row)
+    {
+        const uint64_t *cells = rows + static_cast<size_t>(row) * stride;
+        for (int w = 0; w < stride; ++w)
+        {
+            // Visit only the live cells of the word
+            for (uint64_t bits = cells[w]; bits != 0; bits &= bits - 1)
+            {
+                append_coordinates(first_row + row + 1, w * 64 + std::countr_zero(bits) + 1);
+            }
+        }
+    }
+}
+
+void LiveFileWriter::write_dying_cells(const GameState &game)
+{
+    // Readers of plain Life 1.06 files skip these comment lines and see the live cells only
+    const std::vector<uint8_t> &states = game.get_cell_states();
+    int size = game.get_size();
+    for (size_t cell = 0; cell < states.size(); ++cell)
+    {
+        if (states[cell] >= 2)
+        {
+            append("#D ");
+            append_number(static_cast<long long>(cell / size) + 1);
+            append(" ");
+            append_number(static_cast<long long>(cell % size) + 1);
+            append(" ");
+            append_number(states[cell]);
+            append("\n");
+        }
+    }
+}
+
+void LiveFileWriter::append(const std::string &text)
+{
+    for (size_t pos = 0; pos < text.size();)
+    {
+        if (used == buffer.size())
+        {
+            flush();
+        }
+        size_t chunk = std::min(text.size() - pos, buffer.size() - used);
+        std::copy_n(text.data() + pos, chunk, buffer.data() + used);
+        used += chunk;
+        pos += chunk;
+    }
+}
+
+void LiveFileWriter::append_number(long long number)
+{
+    if (buffer.size() - used < 24)
+    {
+        flush();
+    }
+    used = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), number).ptr - buffer.data();
+}
+
+void LiveFileWriter::append_coordinates(long long row, long long col)
+{
+    // Two numbers, a space and a newline always fit into 48 characters
+    if (buffer.size() - used < 48)
+    {
+        flush();
+    }
+    char *end = buffer.data() + buffer.size();
+    char *out = std::to_chars(buffer.data() + used, end, row).ptr;
+    *out++ = ' ';
+    out = std::to_chars(out, end, col).ptr;
+    *out++ = '\n';
+    used = out - buffer.data();
+}
+
+void LiveFileWriter::flush()
+{
+    if (used > 0)
+    {
+        file.write(buffer.data(), used);
+        used = 0;
+    }
+    file.flush();
+    if (!file)
+    {
+        throw std::runtime_error("It couldn't write to file: " + file_name);
+    }
+}
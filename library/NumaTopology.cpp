@@ -0,0 +1,155 @@
+#include "GameOfLife.hpp"
+
+namespace
+{
+    // CPUs the process may run on, or every CPU if the mask cannot be read
+    std::vector<int> allowed_cpus()
+    {
+        std::vector<int> cpus;
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        if (sched_getaffinity(0, sizeof(mask), &mask) == 0)
+        {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            {
+                if (CPU_ISSET(cpu, &mask))
+                {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+        if (cpus.empty())
+        {
+            for (int cpu = 0; cpu < static_cast<int>(std::max(1u, std::thread::hardware_concurrency())); ++cpu)
+            {
+                cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+
+    // Reads the MemTotal line of a node meminfo file
+    long long read_memory_kib(const std::filesystem::path &meminfo)
+    {
+        std::ifstream file(meminfo);
+        std::string line;
+        while (std::getline(file, line))
+        {
+            size_t found = line.find("MemTotal:");
+            if (found != std::string::npos)
+            {
+                return std::atoll(line.c_str() + found + 9);
+            }
+        }
+        return 0;
+    }
+}
+
+NumaTopology::NumaTopology(const std::string &root)
+{
+    std::vector<int> allowed = allowed_cpus();
+
+    std::error_code error;
+    for (const auto &entry : std::filesystem::directory_iterator(root, error))
+    {
+        std::string name = entry.path().filename().string();
+        if (name.size() <= 4 || name.compare(0, 4, "node") != 0 ||
+            !std::all_of(name.begin() + 4, name.end(), [](unsigned char c)
+                         { return std::isdigit(c); }))
+        {
+            continue;
+        }
+
+        std::ifstream list_file(entry.path() / "cpulist");
+        std::string list;
+        std::getline(list_file, list);
+        std::vector<int> cpus;
+        try
+        {
+            cpus = parse_cpu_list(list);
+        }
+        catch (const std::invalid_argument &)
+        {
+            continue;
+        }
+
+        Node node{std::atoi(name.c_str() + 4), {}, read_memory_kib(entry.path() / "meminfo")};
+        std::set_intersection(cpus.begin(), cpus.end(), allowed.begin(), allowed.end(), std::back_inserter(node.cpus));
+        if (!node.cpus.empty())
+        {
+            nodes.push_back(node);
+        }
+    }
+
+    std::sort(nodes.begin(), nodes.end(), [](const Node &a, const Node &b)
+              { return a.id < b.id; });
+    if (nodes.empty())
+    {
+        nodes.push_back(Node{0, allowed, 0});
+    }
+}
+
+const std::vector<NumaTopology::Node> &NumaTopology::get_nodes() const
+{
+    return nodes;
+}
+
+std::string NumaTopology::report() const
+{
+    std::ostringstream text;
+    for (const Node &node : nodes)
+    {
+        text << "node " << node.id << ": " << node.cpus.size() << " cpus (";
+        for (size_t i = 0; i < node.cpus.size(); ++i)
+        {
+            // Runs of consecutive CPUs are written as ranges
+            size_t end = i;
+            while (end + 1 < node.cpus.size() && node.cpus[end + 1] == node.cpus[end] + 1)
+            {
+                ++end;
+            }
+            text << (i > 0 ? "," : "") << node.cpus[i];
+            if (end > i)
+            {
+                text << "-" << node.cpus[end];
+            }
+            i = end;
+        }
+        text << ")";
+        if (node.memory_kib > 0)
+        {
+            text << ", " << node.memory_kib / 1024 << " MiB";
+        }
+        text << "\n";
+    }
+    return text.str();
+}
+
+std::vector<int> NumaTopology::parse_cpu_list(const std::string &list)
+{
+    static const std::regex range("^\\s*([0-9]+)(-([0-9]+))?\\s*$");
+    std::vector<int> cpus;
+    std::stringstream items(list);
+    std::string item;
+    while (std::getline(items, item, ','))
+    {
+        std::smatch match;
+        if (!std::regex_match(item, match, range))
+        {
+            throw std::invalid_argument("Invalid CPU list: " + list);
+        }
+        int first = std::stoi(match[1]);
+        int last = match[3].matched ? std::stoi(match[3]) : first;
+        if (last < first || last >= CPU_SETSIZE)
+        {
+            throw std::invalid_argument("Invalid CPU list: " + list);
+        }
+        for (int cpu = first; cpu <= last; ++cpu)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
@@ -0,0 +1,381 @@
+#include "GameOfLife.hpp"
+
+namespace
+{
+    // Header layout: magic, size, generation, birth and survival masks, universe name
+    const char STORE_MAGIC[8] = {'G', 'O', 'L', 'S', 'T', 'O', 'R', '1'};
+    const size_t HEADER_BYTES = 64;
+    const size_t NAME_OFFSET = 32;
+
+    size_t row_bytes(int size)
+    {
+        return static_cast<size_t>((size + 63) / 64) * sizeof(uint64_t);
+    }
+
+    void write_all(int fd, const void *data, size_t bytes, off_t offset)
+    {
+        const char *pos = static_cast<const char *>(data);
+        while (bytes > 0)
+        {
+            ssize_t written = ::pwrite(fd, pos, bytes, offset);
+            if (written < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (written <= 0)
+            {
+                throw std::runtime_error("It couldn't write to the field store.");
+            }
+            pos += written;
+            bytes -= written;
+            offset += written;
+        }
+    }
+
+    void read_all(int fd, void *data, size_t bytes, off_t offset)
+    {
+        char *pos = static_cast<char *>(data);
+        while (bytes > 0)
+        {
+            ssize_t received = ::pread(fd, pos, bytes, offset);
+            if (received < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (received <= 0)
+            {
+                throw std::runtime_error("It couldn't read the field store.");
+            }
+            pos += received;
+            bytes -= received;
+            offset += received;
+        }
+    }
+
+    int open_store(const std::string &store_file, long long size)
+    {
+        int fd = ::open(store_file.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            throw std::runtime_error("It couldn't open file for write: " + store_file);
+        }
+        if (::ftruncate(fd, static_cast<off_t>(HEADER_BYTES + size * row_bytes(static_cast<int>(size)))) < 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("It couldn't allocate the field store: " + store_file);
+        }
+        return fd;
+    }
+}
+
+OutOfCoreEngine::OutOfCoreEngine(const std::string &store_file, int band_rows)
+    : store_file(store_file), fd(::open(store_file.c_str(), O_RDWR)), state(), band_rows(band_rows)
+{
+    if (fd < 0)
+    {
+        throw std::runtime_error("It couldn't open the field store: " + store_file);
+    }
+
+    char header[HEADER_BYTES];
+    try
+    {
+        read_all(fd, header, sizeof(header), 0);
+    }
+    catch (const std::exception &)
+    {
+        ::close(fd);
+        throw std::runtime_error("Not a field store: " + store_file);
+    }
+    if (!std::equal(STORE_MAGIC, STORE_MAGIC + 8, header))
+    {
+        ::close(fd);
+        throw std::runtime_error("Not a field store: " + store_file);
+    }
+
+    int64_t size, generation;
+    uint32_t birth_mask, survival_mask;
+    std::memcpy(&size, header + 8, 8);
+    std::memcpy(&generation, header + 16, 8);
+    std::memcpy(&birth_mask, header + 24, 4);
+    std::memcpy(&survival_mask, header + 28, 4);
+
+    std::set<int> B_conditions, S_conditions;
+    for (int n = 0; n <= 8; ++n)
+    {
+        if (birth_mask >> n & 1)
+        {
+            B_conditions.insert(n);
+        }
+        if (survival_mask >> n & 1)
+        {
+            S_conditions.insert(n);
+        }
+    }
+    state.set_size(static_cast<int>(size));
+    state.set_count_of_iterations(static_cast<int>(generation));
+    state.set_B_conditions(B_conditions);
+    state.set_S_conditions(S_conditions);
+    state.set_universe_name(std::string(header + NAME_OFFSET, strnlen(header + NAME_OFFSET, HEADER_BYTES - NAME_OFFSET)));
+    GameEngine::get_rule_tables(state, births, survivals);
+
+    if (this->band_rows <= 0)
+    {
+        this->band_rows = static_cast<int>(std::max<size_t>(1, BAND_BYTES / row_bytes(state.get_size())));
+    }
+    this->band_rows = std::min(this->band_rows, std::max(1, state.get_size()));
+}
+
+OutOfCoreEngine::~OutOfCoreEngine()
+{
+    if (fd >= 0)
+    {
+        ::close(fd);
+    }
+}
+
+void OutOfCoreEngine::import_live(const std::string &live_file, const std::string &store_file)
+{
+    GameState metadata;
+    int store = -1;
+    uint64_t *cells = nullptr;
+    size_t mapped = 0;
+
+    // The cells are set in a shared mapping, so the page cache holds the field instead of the heap
+    auto map_store = [&]()
+    {
+        if (metadata.get_state_count() > 2)
+        {
+            throw std::runtime_error("Generations rules with dying cell states are not supported out of core.");
+        }
+        store = open_store(store_file, metadata.get_size());
+        mapped = HEADER_BYTES + static_cast<size_t>(metadata.get_size()) * row_bytes(metadata.get_size());
+        void *region = ::mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_SHARED, store, 0);
+        if (region == MAP_FAILED)
+        {
+            ::close(store);
+            store = -1;
+            throw std::runtime_error("It couldn't map the field store: " + store_file);
+        }
+        cells = reinterpret_cast<uint64_t *>(static_cast<char *>(region) + HEADER_BYTES);
+    };
+
+    try
+    {
+        ParserFile parser_file(live_file);
+        parser_file.parse(metadata, [&](int row, int col)
+                          {
+                              int size = metadata.get_size();
+                              if (row < 0 || row >= size || col < 0 || col >= size)
+                              {
+                                  throw std::out_of_range("Cell " + std::to_string(row + 1) + " " + std::to_string(col + 1) + " is outside the field.");
+                              }
+                              if (store < 0)
+                              {
+                                  map_store();
+                              }
+                              cells[static_cast<size_t>(row) * ((size + 63) / 64) + (col >> 6)] |= uint64_t(1) << (col & 63); });
+        if (store < 0)
+        {
+            map_store();
+        }
+        write_header(store, metadata);
+    }
+    catch (...)
+    {
+        if (cells != nullptr)
+        {
+            ::munmap(reinterpret_cast<char *>(cells) - HEADER_BYTES, mapped);
+        }
+        if (store >= 0)
+        {
+            ::close(store);
+        }
+        throw;
+    }
+
+    ::munmap(reinterpret_cast<char *>(cells) - HEADER_BYTES, mapped);
+    ::close(store);
+}
+
+void OutOfCoreEngine::create(const GameState &game, const std::string &store_file)
+{
+    int store = open_store(store_file, game.get_size());
+    try
+    {
+        write_header(store, game);
+        const PackedField &field = game.get_packed_field();
+        if (field.get_size() == game.get_size())
+        {
+            write_all(store, field.get_words().data(), field.get_words().size() * sizeof(uint64_t), HEADER_BYTES);
+        }
+    }
+    catch (...)
+    {
+        ::close(store);
+        throw;
+    }
+    ::close(store);
+}
+
+void OutOfCoreEngine::run(int generations)
+{
+    for (int i = 0; i < generations; ++i)
+    {
+        step_generation();
+    }
+}
+
+void OutOfCoreEngine::export_live(const std::string &live_file) const
+{
+    LiveFileWriter writer(live_file);
+    writer.write_header(state);
+
+    int size = state.get_size();
+    int stride = (size + 63) / 64;
+    PackedWords band(static_cast<size_t>(band_rows) * stride);
+    for (int first = 0; first < size; first += band_rows)
+    {
+        int rows = std::min(band_rows, size - first);
+        read_rows(fd, first, rows, band.data());
+        writer.write_rows(band.data(), first, rows, stride);
+    }
+    writer.flush();
+}
+
+const GameState &OutOfCoreEngine::get_state() const
+{
+    return state;
+}
+
+int OutOfCoreEngine::get_band_rows() const
+{
+    return band_rows;
+}
+
+void OutOfCoreEngine::write_header(int fd, const GameState &game)
+{
+    char header[HEADER_BYTES] = {};
+    int64_t size = game.get_size();
+    int64_t generation = game.get_count_of_iterations();
+    uint32_t birth_mask = 0, survival_mask = 0;
+    for (int condition : game.get_B_conditions())
+    {
+        birth_mask |= 1u << condition;
+    }
+    for (int condition : game.get_S_conditions())
+    {
+        survival_mask |= 1u << condition;
+    }
+
+    std::copy(STORE_MAGIC, STORE_MAGIC + 8, header);
+    std::memcpy(header + 8, &size, 8);
+    std::memcpy(header + 16, &generation, 8);
+    std::memcpy(header + 24, &birth_mask, 4);
+    std::memcpy(header + 28, &survival_mask, 4);
+    std::string name = game.get_universe_name().substr(0, HEADER_BYTES - NAME_OFFSET - 1);
+    std::copy(name.begin(), name.end(), header + NAME_OFFSET);
+    write_all(fd, header, sizeof(header), 0);
+}
+
+void OutOfCoreEngine::read_rows(int fd, long long first_row, int row_count, uint64_t *rows) const
+{
+    long long size = state.get_size();
+    size_t bytes = row_bytes(static_cast<int>(size));
+    for (int done = 0; done < row_count;)
+    {
+        // Read the longest run of rows that does not wrap around the field
+        long long row = ((first_row + done) % size + size) % size;
+        int run = static_cast<int>(std::min<long long>(row_count - done, size - row));
+        read_all(fd, reinterpret_cast<char *>(rows) + done * bytes, run * bytes, static_cast<off_t>(HEADER_BYTES + row * bytes));
+        done += run;
+    }
+}
+
+void OutOfCoreEngine::step_generation()
+{
+    int size = state.get_size();
+    if (size == 0)
+    {
+        state.set_count_of_iterations(state.get_count_of_iterations() + 1);
+        return;
+    }
+
+    int stride = (size + 63) / 64;
+    size_t bytes = row_bytes(size);
+    int bands = (size + band_rows - 1) / band_rows;
+
+    GameState next_state = state;
+    next_state.set_count_of_iterations(state.get_count_of_iterations() + 1);
+    std::string next_file = store_file + ".next";
+    int next_fd = open_store(next_file, size);
+
+    // Two input bands with one halo row on each side, two output bands
+    PackedWords input[2] = {PackedWords(static_cast<size_t>(band_rows + 2) * stride),
+                            PackedWords(static_cast<size_t>(band_rows + 2) * stride)};
+    PackedWords output[2] = {PackedWords(static_cast<size_t>(band_rows) * stride),
+                             PackedWords(static_cast<size_t>(band_rows) * stride)};
+
+    auto read_band = [this, size](int band, uint64_t *rows)
+    {
+        int first = band * band_rows;
+        read_rows(fd, first - 1, std::min(band_rows, size - first) + 2, rows);
+    };
+
+    std::future<void> prefetch = std::async(std::launch::async, read_band, 0, input[0].data());
+    std::future<void> write_behind;
+    try
+    {
+        write_header(next_fd, next_state);
+        for (int band = 0; band < bands; ++band)
+        {
+            prefetch.get();
+            if (band + 1 < bands)
+            {
+                prefetch = std::async(std::launch::async, read_band, band + 1, input[(band + 1) % 2].data());
+            }
+
+            int first = band * band_rows;
+            int rows = std::min(band_rows, size - first);
+            const uint64_t *in = input[band % 2].data();
+            uint64_t *out = output[band % 2].data();
+            for (int r = 0; r < rows; ++r)
+            {
+                GameEngine::step_row(in + static_cast<size_t>(r) * stride, in + static_cast<size_t>(r + 1) * stride,
+                                     in + static_cast<size_t>(r + 2) * stride, out + static_cast<size_t>(r) * stride,
+                                     size, births, survivals);
+            }
+
+            // At most one band is written while the next one is computed
+            if (write_behind.valid())
+            {
+                write_behind.get();
+            }
+            write_behind = std::async(std::launch::async, write_all, next_fd, out, rows * bytes,
+                                      static_cast<off_t>(HEADER_BYTES + first * bytes));
+        }
+        write_behind.get();
+    }
+    catch (...)
+    {
+        if (prefetch.valid())
+        {
+            prefetch.wait();
+        }
+        if (write_behind.valid())
+        {
+            write_behind.wait();
+        }
+        ::close(next_fd);
+        ::unlink(next_file.c_str());
+        throw;
+    }
+
+    if (::rename(next_file.c_str(), store_file.c_str()) < 0)
+    {
+        ::close(next_fd);
+        throw std::runtime_error("It couldn't replace the field store: " + store_file);
+    }
+    ::close(fd);
+    fd = next_fd;
+    state = next_state;
+}
@@ -0,0 +1,113 @@
+#include "GameOfLife.hpp"
+
+// Default constructor
+PackedField::PackedField() : size(0), stride(0), words() {}
+
+// Creates an empty field of the given size
+PackedField::PackedField(int size)
+    : size(size),
+      stride((size + 63) / 64),
+      words(static_cast<size_t>(size) * ((size + 63) / 64), 0) {}
+
+// Packs every row of the field into 64-bit words
+PackedField::PackedField(const Field &field) : PackedField(static_cast<int>(field.size()))
+{
+    for (int row = 0; row < size; ++row)
+    {
+        const std::vector<bool> &cells = field[row];
+        uint64_t *out = &words[static_cast<size_t>(row) * stride];
+        for (int col = 0; col < size; ++col)
+        {
+            if (cells[col])
+            {
+                out[col >> 6] |= uint64_t(1) << (col & 63);
+            }
+        }
+    }
+}
+
+Field PackedField::to_field() const
+{
+    Field field(size, std::vector<bool>(size, false));
+    for (int row = 0; row < size; ++row)
+    {
+        const uint64_t *in = &words[static_cast<size_t>(row) * stride];
+        for (int w = 0; w < stride; ++w)
+        {
+            // Visit only the live cells of the word
+            for (uint64_t bits = in[w]; bits != 0; bits &= bits - 1)
+            {
+                field[row][w * 64 + std::countr_zero(bits)] = true;
+            }
+        }
+    }
+    return field;
+}
+
+int PackedField::get_size() const
+{
+    return size;
+}
+
+int PackedField::get_stride() const
+{
+    return stride;
+}
+
+bool PackedField::get(int row, int col) const
+{
+    return (words[static_cast<size_t>(row) * stride + (col >> 6)] >> (col & 63)) & 1;
+}
+
+void PackedField::set(int row, int col, bool alive)
+{
+    uint64_t &word = words[static_cast<size_t>(row) * stride + (col >> 6)];
+    uint64_t mask = uint64_t(1) << (col & 63);
+    word = alive ? (word | mask) : (word & ~mask);
+}
+
+const PackedWords &PackedField::get_words() const
+{
+    return words;
+}
+
+PackedWords &PackedField::get_words()
+{
+    return words;
+}
+
+long long PackedField::population() const
+{
+    long long count = 0;
+    for (uint64_t word : words)
+    {
+        count += std::popcount(word);
+    }
+    return count;
+}
+
+int PackedField::count_range(int row, int start, int length) const
+{
+    if (length <= 0)
+    {
+        return 0;
+    }
+
+    const uint64_t *cells = &words[static_cast<size_t>(row) * stride];
+    int first = start >> 6;
+    int last = (start + length - 1) >> 6;
+    int tail = ((start + length - 1) & 63) + 1;
+    uint64_t tail_mask = tail == 64 ? ~uint64_t(0) : (uint64_t(1) << tail) - 1;
+
+    if (first == last)
+    {
+        return std::popcount((cells[first] >> (start & 63)) & (tail_mask >> (start & 63)));
+    }
+
+    int count = std::popcount(cells[first] >> (start & 63));
+    for (int w = first + 1; w < last; ++w)
+    {
+        count += std::popcount(cells[w]);
+    }
+    return count + std::popcount(cells[last] & tail_mask);
+}
@@ -0,0 +1,218 @@
+#include "GameOfLife.hpp"
+
+namespace
+{
+    const unsigned long MPOL_BIND_MODE = 2; // MPOL_BIND of <numaif.h>, which needs libnuma
+
+    // Pins the calling thread to a CPU
+    bool pin_to_cpu(int cpu)
+    {
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        CPU_SET(cpu, &mask);
+        return sched_setaffinity(0, sizeof(mask), &mask) == 0;
+    }
+
+    // Binds the pages of a mapping to a node before they are touched
+    bool bind_to_node(void *address, size_t bytes, int node)
+    {
+        const size_t bits = 8 * sizeof(unsigned long);
+        if (node < 0 || static_cast<size_t>(node) >= bits)
+        {
+            return false;
+        }
+        unsigned long mask = 1UL << node;
+        return syscall(SYS_mbind, address, bytes, MPOL_BIND_MODE, &mask, bits, 0) == 0;
+    }
+}
+
+ParallelEngine::ParallelEngine(GameState &state, int threads, NumaPolicy policy, const NumaTopology &topology)
+    : state(state), policy(policy), workers(), node_cpus()
+{
+    if (threads <= 0)
+    {
+        throw std::invalid_argument("The parallel engine needs at least one thread");
+    }
+    if (state.get_state_count() > 2)
+    {
+        throw std::invalid_argument("The parallel engine supports only rules with two cell states");
+    }
+
+    int size = state.get_size();
+    int count = std::max(1, std::min(threads, size));
+    const std::vector<NumaTopology::Node> &nodes = topology.get_nodes();
+    int node_count = static_cast<int>(nodes.size());
+
+    for (int i = 0; i < count; ++i)
+    {
+        // Consecutive bands share a node, so only the halo rows between two groups cross nodes
+        int group = static_cast<int>(static_cast<long long>(i) * node_count / count);
+        int first_in_group = static_cast<int>((static_cast<long long>(group) * count + node_count - 1) / node_count);
+        const NumaTopology::Node &node = nodes[group];
+
+        Worker worker;
+        worker.first_row = static_cast<int>(static_cast<long long>(i) * size / count);
+        worker.row_count = static_cast<int>(static_cast<long long>(i + 1) * size / count) - worker.first_row;
+        worker.node = policy == NumaPolicy::OFF ? -1 : node.id;
+        worker.cpu = -1;
+        worker.bound = false;
+        workers.push_back(worker);
+
+        std::vector<int> cpus;
+        if (policy != NumaPolicy::OFF)
+        {
+            cpus.push_back(node.cpus[(i - first_in_group) % node.cpus.size()]);
+        }
+        node_cpus.push_back(cpus);
+    }
+}
+
+void ParallelEngine::run(int generations)
+{
+    TraceZone zone("ParallelEngine::run");
+    int size = state.get_size();
+    if (state.get_packed_field().get_size() != size)
+    {
+        state.set_field(PackedField(size));
+    }
+
+    int count = static_cast<int>(workers.size());
+    std::vector<std::array<uint64_t *, 2> > bands(count, {nullptr, nullptr});
+    std::barrier<> sync(count);
+    std::atomic<bool> failed{false};
+    PackedField result(size);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < count; ++i)
+    {
+        threads.emplace_back(&ParallelEngine::run_band, this, i, generations, std::ref(bands), std::ref(sync),
+                             std::ref(failed), std::ref(result));
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    if (failed)
+    {
+        throw std::runtime_error("Cannot allocate the bands of the parallel engine");
+    }
+    state.swap_field(result);
+    state.set_count_of_iterations(state.get_count_of_iterations() + generations);
+}
+
+void ParallelEngine::run_band(int index, int generations, std::vector<std::array<uint64_t *, 2> > &bands,
+                              std::barrier<> &sync, std::atomic<bool> &failed, PackedField &result)
+{
+    Worker &worker = workers[index];
+    int count = static_cast<int>(workers.size());
+    int size = state.get_size();
+    int stride = state.get_packed_field().get_stride();
+    int rows = worker.row_count;
+    size_t band_words = static_cast<size_t>(rows + 2) * stride;
+    size_t bytes = 2 * band_words * sizeof(uint64_t);
+
+    Tracer::instance().set_thread_name("band " + std::to_string(index));
+    worker.cpu = -1;
+    worker.bound = false;
+    if (!node_cpus[index].empty() && pin_to_cpu(node_cpus[index][0]))
+    {
+        worker.cpu = node_cpus[index][0];
+    }
+
+    // Both buffers of the band, rows 0 and rows + 1 being the halo rows; nothing has touched the pages yet
+    void *memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+    {
+        failed = true;
+        memory = nullptr;
+    }
+    else
+    {
+        if (policy == NumaPolicy::BIND)
+        {
+            worker.bound = bind_to_node(memory, bytes, worker.node);
+        }
+        uint64_t *words = static_cast<uint64_t *>(memory);
+        std::fill(words, words + 2 * band_words, 0);
+        std::copy_n(state.get_packed_field().get_words().data() + static_cast<size_t>(worker.first_row) * stride,
+                    static_cast<size_t>(rows) * stride, words + stride);
+        bands[index] = {words, words + band_words};
+    }
+    sync.arrive_and_wait();
+
+    if (!failed)
+    {
+        std::array<bool, 9> births;
+        std::array<bool, 9> survivals;
+        GameEngine::get_rule_tables(state, births, survivals);
+        const std::array<uint64_t *, 2> &above = bands[(index + count - 1) % count];
+        const std::array<uint64_t *, 2> &below = bands[(index + 1) % count];
+        int above_rows = workers[(index + count - 1) % count].row_count;
+
+        long long first_generation = state.get_count_of_iterations();
+        for (int generation = 0; generation < generations; ++generation)
+        {
+            int current = generation & 1;
+            uint64_t *cells = bands[index][current];
+            uint64_t *next = bands[index][current ^ 1];
+
+            {
+                TraceZone zone("step band", first_generation + generation + 1);
+
+                // The last row of the band above and the first row of the band below are all that crosses bands
+                std::copy_n(above[current] + static_cast<size_t>(above_rows) * stride, stride, cells);
+                std::copy_n(below[current] + stride, stride, cells + static_cast<size_t>(rows + 1) * stride);
+
+                for (int r = 1; r <= rows; ++r)
+                {
+                    GameEngine::step_row(cells + static_cast<size_t>(r - 1) * stride,
+                                         cells + static_cast<size_t>(r) * stride,
+                                         cells + static_cast<size_t>(r + 1) * stride,
+                                         next + static_cast<size_t>(r) * stride, size, births, survivals);
+                }
+            }
+            TraceZone zone("halo sync", first_generation + generation + 1);
+            sync.arrive_and_wait();
+        }
+
+        // No band reads another one after the last barrier, so every band writes back its own rows
+        std::copy_n(bands[index][generations & 1] + stride, static_cast<size_t>(rows) * stride,
+                    result.get_words().data() + static_cast<size_t>(worker.first_row) * stride);
+    }
+
+    if (memory != nullptr)
+    {
+        munmap(memory, bytes);
+    }
+}
+
+const std::vector<ParallelEngine::Worker> &ParallelEngine::get_workers() const
+{
+    return workers;
+}
+
+std::string ParallelEngine::report_placement() const
+{
+    std::ostringstream text;
+    for (size_t i = 0; i < workers.size(); ++i)
+    {
+        const Worker &worker = workers[i];
+        text << "worker " << i << ": rows " << worker.first_row << "-" << worker.first_row + worker.row_count - 1;
+        if (worker.node >= 0)
+        {
+            text << ", node " << worker.node;
+        }
+        text << ", " << (worker.cpu >= 0 ? "cpu " + std::to_string(worker.cpu) : std::string("not pinned"));
+        if (policy == NumaPolicy::BIND)
+        {
+            text << (worker.bound ? ", bound" : ", first touch (mbind failed)");
+        }
+        else if (policy == NumaPolicy::FIRST_TOUCH)
+        {
+            text << ", first touch";
+        }
+        text << "\n";
+    }
+    return text.str();
+}
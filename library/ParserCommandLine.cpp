@@ -1,7 +1,9 @@
 #include "GameOfLife.hpp"
 
 ParserCommandLine::ParserCommandLine(int argc, char **argv)
-    : mode('0'), iterations(0)
+    : mode('0'), iterations(0), quiet(false), frame_interval(0), frame_scale(1), undo_budget(64), worker_count(0),
+      huge_pages(FieldArena::HugePages::TRANSPARENT), heat_mode(HeatMap::Mode::ALIVE), thread_count(0),
+      numa_policy(ParallelEngine::NumaPolicy::FIRST_TOUCH), topology_report(false)
 {
     parse(argc, argv);
 }
@@ -13,9 +15,241 @@ bool ParserCommandLine::has_live_extension(const std::string &filename)
            filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0;
 }
 
+int ParserCommandLine::parse_positive(const std::string &value, const std::string &name)
+{
+    std::regex number_regex("^[0-9]+$");
+    if (!std::regex_match(value, number_regex))
+    {
+        throw std::invalid_argument("Invalid " + name + " value: Must be a positive integer.");
+    }
+
+    int number = 0;
+    try
+    {
+        number = std::stoi(value);
+    }
+    catch (const std::exception &)
+    {
+        throw std::invalid_argument("Invalid " + name + " value: Must be an integer.");
+    }
+
+    if (number <= 0)
+    {
+        throw std::invalid_argument("Invalid " + name + " value: Must be a positive integer.");
+    }
+    return number;
+}
+
+bool ParserCommandLine::parse_extra_option(const std::string &arg)
+{
+    if (arg == "-q" || arg == "--quiet")
+    {
+        quiet = true;
+        return true;
+    }
+    if (arg.substr(0, 9) == "--record=")
+    {
+        record_file = arg.substr(9);
+        if (record_file.empty())
+        {
+            throw std::invalid_argument("Invalid record value: History file name is required.");
+        }
+        return true;
+    }
+    if (arg.substr(0, 9) == "--frames=")
+    {
+        // Frames go to stdout, so nothing else may be printed there
+        frame_interval = parse_positive(arg.substr(9), "frames");
+        quiet = true;
+        return true;
+    }
+    if (arg.substr(0, 14) == "--undo-budget=")
+    {
+        std::string value = arg.substr(14);
+        undo_budget = value == "0" ? 0 : parse_positive(value, "undo budget");
+        return true;
+    }
+    if (arg.substr(0, 8) == "--serve=")
+    {
+        server_socket = arg.substr(8);
+        if (server_socket.empty())
+        {
+            throw std::invalid_argument("Invalid serve value: Socket path is required.");
+        }
+        return true;
+    }
+    if (arg.substr(0, 10) == "--workers=")
+    {
+        worker_count = parse_positive(arg.substr(10), "workers");
+        return true;
+    }
+    if (arg.substr(0, 9) == "--script=")
+    {
+        script_file = arg.substr(9);
+        if (script_file.empty())
+        {
+            throw std::invalid_argument("Invalid script value: Script file name is required.");
+        }
+        return true;
+    }
+    if (arg.substr(0, 14) == "--out-of-core=")
+    {
+        store_file = arg.substr(14);
+        if (store_file.empty())
+        {
+            throw std::invalid_argument("Invalid out-of-core value: Store file name is required.");
+        }
+        return true;
+    }
+    if (arg.substr(0, 9) == "--census=")
+    {
+        census_file = arg.substr(9);
+        if (census_file.empty())
+        {
+            throw std::invalid_argument("Invalid census value: Report file name is required.");
+        }
+        return true;
+    }
+    if (arg.substr(0, 11) == "--heat-map=")
+    {
+        heat_map_file = arg.substr(11);
+        std::string extension = heat_map_file.size() > 4 ? heat_map_file.substr(heat_map_file.size() - 4) : "";
+        if (extension != ".pgm" && extension != ".csv")
+        {
+            throw std::invalid_argument("Invalid heat map value: File must have .pgm or .csv extension.");
+        }
+        return true;
+    }
+    if (arg.substr(0, 12) == "--heat-mode=")
+    {
+        std::string value = arg.substr(12);
+        if (value == "alive")
+        {
+            heat_mode = HeatMap::Mode::ALIVE;
+        }
+        else if (value == "flips")
+        {
+            heat_mode = HeatMap::Mode::FLIPS;
+        }
+        else
+        {
+            throw std::invalid_argument("Invalid heat mode value: Must be alive or flips.");
+        }
+        return true;
+    }
+    if (arg.substr(0, 13) == "--huge-pages=")
+    {
+        std::string value = arg.substr(13);
+        if (value == "none")
+        {
+            huge_pages = FieldArena::HugePages::NONE;
+        }
+        else if (value == "thp")
+        {
+            huge_pages = FieldArena::HugePages::TRANSPARENT;
+        }
+        else if (value == "explicit")
+        {
+            huge_pages = FieldArena::HugePages::EXPLICIT;
+        }
+        else
+        {
+            throw std::invalid_argument("Invalid huge pages value: Must be none, thp or explicit.");
+        }
+        return true;
+    }
+    if (arg.substr(0, 10) == "--threads=")
+    {
+        thread_count = parse_positive(arg.substr(10), "threads");
+        return true;
+    }
+    if (arg.substr(0, 7) == "--numa=")
+    {
+        std::string value = arg.substr(7);
+        if (value == "off")
+        {
+            numa_policy = ParallelEngine::NumaPolicy::OFF;
+        }
+        else if (value == "first-touch")
+        {
+            numa_policy = ParallelEngine::NumaPolicy::FIRST_TOUCH;
+        }
+        else if (value == "bind")
+        {
+            numa_policy = ParallelEngine::NumaPolicy::BIND;
+        }
+        else
+        {
+            throw std::invalid_argument("Invalid numa value: Must be off, first-touch or bind.");
+        }
+        return true;
+    }
+    if (arg == "--topology")
+    {
+        topology_report = true;
+        return true;
+    }
+    if (arg.substr(0, 8) == "--trace=")
+    {
+        trace_file = arg.substr(8);
+        if (trace_file.size() <= 5 || trace_file.compare(trace_file.size() - 5, 5, ".json") != 0)
+        {
+            throw std::invalid_argument("Invalid trace value: File must have .json extension.");
+        }
+        return true;
+    }
+    if (arg.substr(0, 10) == "--pattern=")
+    {
+        pattern_name = arg.substr(10);
+        if (PatternLibrary::find(pattern_name) == nullptr)
+        {
+            throw std::invalid_argument("Invalid pattern value: Must be one of " + PatternLibrary::list_names() + ".");
+        }
+        return true;
+    }
+    if (arg.substr(0, 8) == "--scale=")
+    {
+        frame_scale = parse_positive(arg.substr(8), "scale");
+        return true;
+    }
+    return false;
+}
+
 void ParserCommandLine::parse(int argc, char **argv)
 {
-    if (argc == 2)
+    // Optional arguments do not affect the mode, so strip them first
+    std::vector<char *> args;
+    for (int i = 0; i < argc; ++i)
+    {
+        if (i == 0 || !parse_extra_option(argv[i]))
+        {
+            args.push_back(argv[i]);
+        }
+    }
+    argc = static_cast<int>(args.size());
+    argv = args.data();
+
+    if (!server_socket.empty())
+    {
+        if (argc != 1 || quiet || !script_file.empty() || !pattern_name.empty())
+        {
+            throw std::invalid_argument("Server mode does not take an input file or other modes.");
+        }
+        return;
+    }
+
+    if (argc >= 2 && std::string(argv[1]) == "batch")
+    {
+        if (argc != 5)
+        {
+            throw std::invalid_argument("Usage: batch <directory|glob> <generations> <output directory>");
+        }
+        input_file = argv[2];
+        iterations = parse_positive(argv[3], "generations");
+        output_file = argv[4];
+        mode = '4';
+    }
+    else if (argc == 2)
     {
         input_file = argv[1];
         if (!has_live_extension(input_file))
@@ -42,6 +276,47 @@ void ParserCommandLine::parse(int argc, char **argv)
     {
         throw std::invalid_argument("Invalid arguments: Unexpected number of parameters.");
     }
+
+    if (quiet && mode != '3' && mode != '4')
+    {
+        throw std::invalid_argument("Quiet mode requires an input file, iterations and an output file.");
+    }
+
+    if (!store_file.empty() && (mode != '3' || frame_interval > 0 || !record_file.empty()))
+    {
+        throw std::invalid_argument("Out-of-core runs require an input file, iterations and an output file, without frames or recording.");
+    }
+
+    if (!census_file.empty() && (mode != '3' || !store_file.empty()))
+    {
+        throw std::invalid_argument("A census requires an input file, iterations and an output file, without out-of-core storage.");
+    }
+
+    if (!heat_map_file.empty() && (mode != '3' || !store_file.empty()))
+    {
+        throw std::invalid_argument("A heat map requires an input file, iterations and an output file, without out-of-core storage.");
+    }
+
+    if (thread_count > 0 && (mode != '3' || !store_file.empty() || frame_interval > 0 || !record_file.empty() ||
+                             !heat_map_file.empty()))
+    {
+        throw std::invalid_argument("Parallel runs require an input file, iterations and an output file, without out-of-core storage, frames, recording or a heat map.");
+    }
+
+    if (topology_report && mode != '2' && thread_count == 0)
+    {
+        throw std::invalid_argument("The topology report stands alone or comes with a run with --threads.");
+    }
+
+    if (!pattern_name.empty() && (mode != '2' || topology_report))
+    {
+        throw std::invalid_argument("A built-in pattern replaces the input file and cannot be combined with iterations, an output file or the topology report.");
+    }
+
+    if (!script_file.empty() && (mode == '3' || mode == '4' || quiet))
+    {
+        throw std::invalid_argument("A script cannot be combined with iterations, an output file or quiet mode.");
+    }
 }
 
 bool ParserCommandLine::parse_args_iterations(int argc, char **argv)
@@ -131,7 +406,7 @@ char ParserCommandLine::get_mode() const
 
 std::string ParserCommandLine::get_input_file() const
 {
-    if (mode == '1' || mode == '3')
+    if (mode == '1' || mode == '3' || mode == '4')
     {
         return input_file;
     }
@@ -140,7 +415,7 @@ std::string ParserCommandLine::get_input_file() const
 
 std::string ParserCommandLine::get_output_file() const
 {
-    if (mode == '3')
+    if (mode == '3' || mode == '4')
     {
         return output_file;
     }
@@ -149,9 +424,99 @@ std::string ParserCommandLine::get_output_file() const
 
 int ParserCommandLine::get_iterations() const
 {
-    if (mode == '3')
+    if (mode == '3' || mode == '4')
     {
         return iterations;
     }
     throw std::logic_error("Iterations not available in this mode.");
 }
+
+std::string ParserCommandLine::get_record_file() const
+{
+    return record_file;
+}
+
+bool ParserCommandLine::is_quiet() const
+{
+    return quiet;
+}
+
+int ParserCommandLine::get_frame_interval() const
+{
+    return frame_interval;
+}
+
+int ParserCommandLine::get_frame_scale() const
+{
+    return frame_scale;
+}
+
+int ParserCommandLine::get_undo_budget() const
+{
+    return undo_budget;
+}
+
+std::string ParserCommandLine::get_server_socket() const
+{
+    return server_socket;
+}
+
+int ParserCommandLine::get_worker_count() const
+{
+    return worker_count;
+}
+
+std::string ParserCommandLine::get_script_file() const
+{
+    return script_file;
+}
+
+FieldArena::HugePages ParserCommandLine::get_huge_pages() const
+{
+    return huge_pages;
+}
+
+std::string ParserCommandLine::get_store_file() const
+{
+    return store_file;
+}
+
+std::string ParserCommandLine::get_census_file() const
+{
+    return census_file;
+}
+
+std::string ParserCommandLine::get_heat_map_file() const
+{
+    return heat_map_file;
+}
+
+HeatMap::Mode ParserCommandLine::get_heat_mode() const
+{
+    return heat_mode;
+}
+
+int ParserCommandLine::get_thread_count() const
+{
+    return thread_count;
+}
+
+ParallelEngine::NumaPolicy ParserCommandLine::get_numa_policy() const
+{
+    return numa_policy;
+}
+
+bool ParserCommandLine::is_topology_report() const
+{
+    return topology_report;
+}
+
+std::string ParserCommandLine::get_pattern_name() const
+{
+    return pattern_name;
+}
+
+std::string ParserCommandLine::get_trace_file() const
+{
+    return trace_file;
+}
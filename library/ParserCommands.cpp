@@ -1,6 +1,7 @@
 #include "GameOfLife.hpp"
 
-ParserCommands::ParserCommands() : command(0), iterations(0) {}
+ParserCommands::ParserCommands()
+    : command(0), iterations(0), keyframe_interval(0), generation(0), pan_rows(0), pan_cols(0), zoom(0), frame_rate(0), scale(1), undo_steps(0), region(), heat_mode(), trace_switch() {}
 
 bool ParserCommands::has_live_extension(const std::string &filename)
 {
@@ -89,6 +90,385 @@ void ParserCommands::parse_help(const std::string &)
     command = '4';
 }
 
+int ParserCommands::parse_number(const std::string &argument, const std::string &command_name, bool allow_negative)
+{
+    try
+    {
+        size_t pos;
+        int number = std::stoi(argument, &pos);
+
+        if (pos != argument.length() || (number < 0 && !allow_negative))
+        {
+            throw std::invalid_argument("Invalid number.");
+        }
+        return number;
+    }
+    catch (const std::invalid_argument &)
+    {
+        throw InvalidCommandException(command_name + (allow_negative ? " command requires a valid integer."
+                                                                     : " command requires a valid non-negative integer."));
+    }
+    catch (const std::out_of_range &)
+    {
+        throw InvalidCommandException(command_name + " command requires an integer within a valid range.");
+    }
+}
+
+void ParserCommands::parse_record(const std::string &input)
+{
+    std::istringstream stream(input);
+    std::string command_part, interval_part, extra_part;
+
+    stream >> command_part >> interval_part >> extra_part;
+
+    if (!extra_part.empty())
+    {
+        throw InvalidCommandException("Invalid input: Unexpected characters after keyframe interval.");
+    }
+
+    keyframe_interval = 32;
+    if (!interval_part.empty())
+    {
+        keyframe_interval = parse_number(interval_part, "record");
+        if (keyframe_interval == 0)
+        {
+            throw InvalidCommandException("record command requires a positive keyframe interval.");
+        }
+    }
+    command = '5';
+}
+
+void ParserCommands::parse_goto(const std::string &input)
+{
+    std::istringstream stream(input);
+    std::string command_part, generation_part, extra_part;
+
+    stream >> command_part >> generation_part >> extra_part;
+
+    if (generation_part.empty())
+    {
+        throw InvalidCommandException("goto command requires a generation.");
+    }
+    if (!extra_part.empty())
+    {
+        throw InvalidCommandException("Invalid input: Unexpected characters after generation.");
+    }
+
+    generation = parse_number(generation_part, "goto");
+    command = '6';
+}
+
+void ParserCommands::parse_pan(const std::string &input)
+{
+    std::istringstream stream(input);
+    std::string command_part, rows_part, cols_part, extra_part;
+
+    stream >> command_part >> rows_part >> cols_part >> extra_part;
+
+    if (cols_part.empty())
+    {
+        throw InvalidCommandException("pan command requires a vertical and a horizontal shift.");
+    }
+    if (!extra_part.empty())
+    {
+        throw InvalidCommandException("Invalid input: Unexpected characters after shifts.");
+    }
+
+    pan_rows = parse_number(rows_part, "pan", true);
+    pan_cols = parse_number(cols_part, "pan", true);
+    command = '7';
+}
+
+void ParserCommands::parse_zoom(const std::string &input)
+{
+    std::istringstream stream(input);
+    std::string command_part, zoom_part, extra_part;
+
+    stream >> command_part >> zoom_part >> extra_part;
+
+    if (zoom_part.empty())
+    {
+        throw InvalidCommandException("zoom command requires a zoom level.");
+    }
+    if (!extra_part.empty())
+    {
+        throw InvalidCommandException("Invalid input: Unexpected characters after zoom level.");
+    }
+
+    zoom = parse_number(zoom_part, "zoom");
+    if ((zoom & (zoom - 1)) != 0)
+    {
+        throw InvalidCommandException("zoom command requires a power of two or 0.");
+    }
+    command = '8';
+}
+
+void ParserCommands::parse_run(const std::string &input)
+{
+    std::istringstream stream(input);
+    std::string command_part, rate_part, extra_part;
+
+    stream >> command_part >> rate_part >> extra_part;
+
+    if (!extra_part.empty())
+    {
+        throw InvalidCommandException("Invalid input: Unexpected characters after frame rate.");
+    }
+
+    frame_rate = 30;
+    if (!rate_part.empty())
+    {
+        frame_rate = parse_number(rate_part, "run");
+        if (frame_rate == 0 || frame_rate > 1000)
+        {
+            throw InvalidCommandException("run command requires a frame rate from 1 to 1000.");
+        }
+    }
+    command = '9';
+}
+
+void ParserCommands::parse_stop(const std::string &)
+{
+    command = 'a';
+}
+
+void ParserCommands::parse_export(const std::string &input)
+{
+    std::istringstream stream(input);
+    std::string command_part, filename_part, scale_part, extra_part;
+
+    stream >> command_part >> filename_part >> scale_part >> extra_part;
+
+    if (filename_part.empty())
+    {
+        throw InvalidCommandException("export command requires a filename.");
+    }
+    if (!extra_part.empty())
+    {
+        throw InvalidCommandException("Invalid input: Unexpected characters after scale.");
+    }
+
+    std::string extension = filename_part.size() > 4 ? filename_part.substr(filename_part.size() - 4) : "";
+    if (extension != ".pbm" && extension != ".pgm")
+    {
+        throw InvalidCommandException("Invalid file extension: Image file must have .pbm or .pgm extension.");
+    }
+
+    scale = 1;
+    if (!scale_part.empty())
+    {
+        scale = parse_number(scale_part, "export");
+        if (scale == 0)
+        {
+            throw InvalidCommandException("export command requires a positive scale.");
+        }
+    }
+
+    command = 'b';
+    filename = filename_part;
+}
+
+void ParserCommands::parse_undo(const std::string &input)
+{
+    std::istringstream stream(input);
+    std::string command_part, steps_part, extra_part;
+
+    stream >> command_part >> steps_part >> extra_part;
+
+    if (!extra_part.empty())
+    {
+        throw InvalidCommandException("Invalid input: Unexpected characters after steps.");
+    }
+
+    undo_steps = 1;
+    if (!steps_part.empty())
+    {
+        undo_steps = parse_number(steps_part, "undo");
+        if (undo_steps == 0)
+        {
+            throw InvalidCommandException("undo command requires a positive number of steps.");
+        }
+    }
+    command = 'c';
+}
+
+void ParserCommands::parse_rewind(const std::string &input)
+{
+    std::istringstream stream(input);
+    std::string command_part, generation_part, extra_part;
+
+    stream >> command_part >> generation_part >> extra_part;
+
+    if (generation_part.empty())
+    {
+        throw InvalidCommandException("rewind command requires a generation.");
+    }
+    if (!extra_part.empty())
+    {
+        throw InvalidCommandException("Invalid input: Unexpected characters after generation.");
+    }
+
+    generation = parse_number(generation_part, "rewind");
+    command = 'd';
+}
+
+void ParserCommands::parse_load(const std::string &input)
+{
+    std::istringstream stream(input);
+    std::string command_part, filename_part, extra_part;
+
+    stream >> command_part >> filename_part >> extra_part;
+
+    if (filename_part.empty())
+    {
+        throw InvalidCommandException("load command requires a filename.");
+    }
+    if (!extra_part.empty())
+    {
+        throw InvalidCommandException("Invalid input: Unexpected characters after filename.");
+    }
+    // A name without the .live extension is one of the patterns built into the program
+    if (!has_live_extension(filename_part) && PatternLibrary::find(filename_part) == nullptr)
+    {
+        throw InvalidCommandException("Unknown pattern: " + filename_part +
+                                      ". Load a .live file or one of: " + PatternLibrary::list_names());
+    }
+
+    command = 'e';
+    filename = filename_part;
+}
+
+void ParserCommands::parse_stats(const std::string &)
+{
+    command = 'f';
+}
+
+void ParserCommands::parse_census(const std::string &)
+{
+    command = 'h';
+}
+
+void ParserCommands::parse_heat(const std::string &input)
+{
+    std::istringstream stream(input);
+    std::string command_part, mode_part, extra_part;
+
+    stream >> command_part >> mode_part >> extra_part;
+
+    if (!extra_part.empty())
+    {
+        throw InvalidCommandException("Invalid input: Unexpected characters after heat mode.");
+    }
+    if (mode_part.empty() || mode_part == "alive")
+    {
+        heat_mode = HeatMap::Mode::ALIVE;
+    }
+    else if (mode_part == "flips")
+    {
+        heat_mode = HeatMap::Mode::FLIPS;
+    }
+    else if (mode_part == "off")
+    {
+        heat_mode.reset();
+    }
+    else
+    {
+        throw InvalidCommandException("heat command requires alive, flips or off.");
+    }
+    command = 'i';
+}
+
+void ParserCommands::parse_heatmap(const std::string &input)
+{
+    std::istringstream stream(input);
+    std::string command_part, filename_part, extra_part;
+
+    stream >> command_part >> filename_part >> extra_part;
+
+    if (filename_part.empty())
+    {
+        throw InvalidCommandException("heatmap command requires a filename.");
+    }
+    if (!extra_part.empty())
+    {
+        throw InvalidCommandException("Invalid input: Unexpected characters after filename.");
+    }
+
+    std::string extension = filename_part.size() > 4 ? filename_part.substr(filename_part.size() - 4) : "";
+    if (extension != ".pgm" && extension != ".csv")
+    {
+        throw InvalidCommandException("Invalid file extension: Heat map file must have .pgm or .csv extension.");
+    }
+
+    command = 'j';
+    filename = filename_part;
+}
+
+void ParserCommands::parse_trace(const std::string &input)
+{
+    std::istringstream stream(input);
+    std::string command_part, argument_part, extra_part;
+
+    stream >> command_part >> argument_part >> extra_part;
+
+    if (argument_part.empty())
+    {
+        throw InvalidCommandException("trace command requires on, off or a .json filename.");
+    }
+    if (!extra_part.empty())
+    {
+        throw InvalidCommandException("Invalid input: Unexpected characters after trace argument.");
+    }
+
+    if (argument_part == "on" || argument_part == "off")
+    {
+        trace_switch = argument_part == "on";
+    }
+    else if (argument_part.size() > 5 && argument_part.compare(argument_part.size() - 5, 5, ".json") == 0)
+    {
+        trace_switch.reset();
+        filename = argument_part;
+    }
+    else
+    {
+        throw InvalidCommandException("Invalid file extension: Trace file must have .json extension.");
+    }
+    command = 'k';
+}
+
+void ParserCommands::parse_region(const std::string &input)
+{
+    std::istringstream stream(input);
+    std::string command_part, extra_part;
+    std::array<std::string, 4> parts;
+
+    stream >> command_part >> parts[0] >> parts[1] >> parts[2] >> parts[3] >> extra_part;
+
+    if (parts[3].empty())
+    {
+        throw InvalidCommandException("region command requires a row, a column, a height and a width.");
+    }
+    if (!extra_part.empty())
+    {
+        throw InvalidCommandException("Invalid input: Unexpected characters after width.");
+    }
+
+    for (size_t i = 0; i < parts.size(); ++i)
+    {
+        region[i] = parse_number(parts[i], "region");
+    }
+    if (region[2] == 0 || region[3] == 0)
+    {
+        throw InvalidCommandException("region command requires a positive height and width.");
+    }
+    if (region[2] > MAX_REGION || region[3] > MAX_REGION)
+    {
+        throw InvalidCommandException("region command allows a height and width of at most " +
+                                      std::to_string(MAX_REGION) + ".");
+    }
+    command = 'g';
+}
+
 void ParserCommands::parse_command(const std::string &input)
 {
     if (input.empty())
@@ -116,6 +496,70 @@ void ParserCommands::parse_command(const std::string &input)
     {
         parse_help(input);
     }
+    else if (input == "record" || input.find("record ") == 0)
+    {
+        parse_record(input);
+    }
+    else if (input == "goto" || input.find("goto ") == 0)
+    {
+        parse_goto(input);
+    }
+    else if (input == "pan" || input.find("pan ") == 0)
+    {
+        parse_pan(input);
+    }
+    else if (input == "zoom" || input.find("zoom ") == 0)
+    {
+        parse_zoom(input);
+    }
+    else if (input == "run" || input.find("run ") == 0)
+    {
+        parse_run(input);
+    }
+    else if (input == "stop")
+    {
+        parse_stop(input);
+    }
+    else if (input == "export" || input.find("export ") == 0)
+    {
+        parse_export(input);
+    }
+    else if (input == "undo" || input.find("undo ") == 0)
+    {
+        parse_undo(input);
+    }
+    else if (input == "rewind" || input.find("rewind ") == 0)
+    {
+        parse_rewind(input);
+    }
+    else if (input == "load" || input.find("load ") == 0)
+    {
+        parse_load(input);
+    }
+    else if (input == "stats")
+    {
+        parse_stats(input);
+    }
+    else if (input == "region" || input.find("region ") == 0)
+    {
+        parse_region(input);
+    }
+    else if (input == "census")
+    {
+        parse_census(input);
+    }
+    else if (input == "heat" || input.find("heat ") == 0)
+    {
+        parse_heat(input);
+    }
+    else if (input == "heatmap" || input.find("heatmap ") == 0)
+    {
+        parse_heatmap(input);
+    }
+    else if (input == "trace" || input.find("trace ") == 0)
+    {
+        parse_trace(input);
+    }
     else
     {
         throw InvalidCommandException("Unknown command!");
@@ -127,9 +571,14 @@ char ParserCommands::get_command() const
     return command;
 }
 
+bool ParserCommands::is_builtin_pattern() const
+{
+    return command == 'e' && !has_live_extension(filename);
+}
+
 const std::string &ParserCommands::get_filename() const
 {
-    if (command != '1')
+    if (command != '1' && command != 'b' && command != 'e' && command != 'j' && command != 'k')
     {
         throw InvalidCommandException("Filename not available for this command.");
     }
@@ -144,3 +593,102 @@ int ParserCommands::get_iterations() const
     }
     return iterations;
 }
+
+int ParserCommands::get_keyframe_interval() const
+{
+    if (command != '5')
+    {
+        throw InvalidCommandException("Keyframe interval not available for this command.");
+    }
+    return keyframe_interval;
+}
+
+int ParserCommands::get_generation() const
+{
+    if (command != '6' && command != 'd')
+    {
+        throw InvalidCommandException("Generation not available for this command.");
+    }
+    return generation;
+}
+
+int ParserCommands::get_pan_rows() const
+{
+    if (command != '7')
+    {
+        throw InvalidCommandException("Shift not available for this command.");
+    }
+    return pan_rows;
+}
+
+int ParserCommands::get_pan_cols() const
+{
+    if (command != '7')
+    {
+        throw InvalidCommandException("Shift not available for this command.");
+    }
+    return pan_cols;
+}
+
+int ParserCommands::get_zoom() const
+{
+    if (command != '8')
+    {
+        throw InvalidCommandException("Zoom not available for this command.");
+    }
+    return zoom;
+}
+
+int ParserCommands::get_frame_rate() const
+{
+    if (command != '9')
+    {
+        throw InvalidCommandException("Frame rate not available for this command.");
+    }
+    return frame_rate;
+}
+
+int ParserCommands::get_scale() const
+{
+    if (command != 'b')
+    {
+        throw InvalidCommandException("Scale not available for this command.");
+    }
+    return scale;
+}
+
+int ParserCommands::get_undo_steps() const
+{
+    if (command != 'c')
+    {
+        throw InvalidCommandException("Steps not available for this command.");
+    }
+    return undo_steps;
+}
+
+std::optional<HeatMap::Mode> ParserCommands::get_heat_mode() const
+{
+    if (command != 'i')
+    {
+        throw InvalidCommandException("Heat mode not available for this command.");
+    }
+    return heat_mode;
+}
+
+std::optional<bool> ParserCommands::get_trace_switch() const
+{
+    if (command != 'k')
+    {
+        throw InvalidCommandException("Trace switch not available for this command.");
+    }
+    return trace_switch;
+}
+
+const std::array<int, 4> &ParserCommands::get_region() const
+{
+    if (command != 'g')
+    {
+        throw InvalidCommandException("Region not available for this command.");
+    }
+    return region;
+}
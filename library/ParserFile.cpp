@@ -3,6 +3,12 @@
 ParserFile::ParserFile(const std::string &file_name) : file_name(file_name) {}
 
 void ParserFile::parse(GameState &game_state)
+{
+    parse(game_state, [&game_state](int row, int col)
+          { game_state.set_cell(row, col, true); });
+}
+
+void ParserFile::parse(GameState &game_state, const std::function<void(int, int)> &add_cell)
 {
     std::ifstream file(file_name);
     if (!file.is_open())
@@ -10,8 +16,14 @@ void ParserFile::parse(GameState &game_state)
         throw std::runtime_error("It couldn't open the file!");
     }
 
+    parse(file, game_state, add_cell);
+}
+
+void ParserFile::parse(std::istream &input, GameState &game_state, const std::function<void(int, int)> &add_cell)
+{
+    TraceZone zone("ParserFile::parse");
     std::string line;
-    while (std::getline(file, line))
+    while (std::getline(input, line))
     {
         if (line.empty())
             continue;
@@ -40,10 +52,15 @@ void ParserFile::parse(GameState &game_state)
             std::string conditions = line.substr(3);
             parse_conditions(conditions, game_state);
         }
+        else if (line.rfind("#D", 0) == 0)
+        {
+
+            parse_dying_cell(line.substr(2), game_state);
+        }
         else
         {
 
-            parse_coordinates(line, game_state);
+            parse_coordinates(line, add_cell);
         }
     }
 }
@@ -53,25 +70,41 @@ void ParserFile::parse_conditions(const std::string &conditions, GameState &game
     std::set<int> B_conditions;
     std::set<int> S_conditions;
 
-    size_t B_pos = conditions.find('B');
-    size_t S_pos = conditions.find('S');
+    // Generations rules end with the number of cell states, e.g. B2/S/C3
+    int state_count = 2;
+    std::string birth_survival = conditions;
+    size_t C_pos = conditions.find('C');
+    if (C_pos != std::string::npos)
+    {
+        std::string count = conditions.substr(C_pos + 1);
+        if (count.empty() || count.size() > 3 || !std::all_of(count.begin(), count.end(), ::isdigit) ||
+            std::stoi(count) < 2 || std::stoi(count) > 256)
+        {
+            throw std::runtime_error("Invalid state count in conditions string: " + conditions);
+        }
+        state_count = std::stoi(count);
+        birth_survival = conditions.substr(0, C_pos);
+    }
+
+    size_t B_pos = birth_survival.find('B');
+    size_t S_pos = birth_survival.find('S');
 
     if (B_pos != std::string::npos && S_pos != std::string::npos)
     {
-        std::string B = conditions.substr(B_pos + 1, S_pos - B_pos - 1);
-        std::string S = conditions.substr(S_pos + 1);
+        std::string B = birth_survival.substr(B_pos + 1, S_pos - B_pos - 1);
+        std::string S = birth_survival.substr(S_pos + 1);
 
         parse_condition_set(B, B_conditions);
         parse_condition_set(S, S_conditions);
     }
     else if (B_pos != std::string::npos)
     {
-        std::string B = conditions.substr(B_pos + 1);
+        std::string B = birth_survival.substr(B_pos + 1);
         parse_condition_set(B, B_conditions);
     }
     else if (S_pos != std::string::npos)
     {
-        std::string S = conditions.substr(S_pos + 1);
+        std::string S = birth_survival.substr(S_pos + 1);
         parse_condition_set(S, S_conditions);
     }
     else
@@ -81,6 +114,18 @@ void ParserFile::parse_conditions(const std::string &conditions, GameState &game
 
     game_state.set_B_conditions(B_conditions);
     game_state.set_S_conditions(S_conditions);
+    game_state.set_state_count(state_count);
+}
+
+void ParserFile::parse_dying_cell(const std::string &line, GameState &game_state)
+{
+    std::istringstream stream(line);
+    int row, col, state;
+    if (!(stream >> row >> col >> state) || state < 2)
+    {
+        throw std::runtime_error("Invalid dying cell: #D" + line);
+    }
+    game_state.set_cell_state(row - 1, col - 1, state);
 }
 
 void ParserFile::parse_condition_set(const std::string &condition_str, std::set<int> &condition_set)
@@ -94,24 +139,14 @@ void ParserFile::parse_condition_set(const std::string &condition_str, std::set<
     }
 }
 
-void ParserFile::parse_coordinates(const std::string &line, GameState &game_state)
+void ParserFile::parse_coordinates(const std::string &line, const std::function<void(int, int)> &add_cell)
 {
     std::istringstream stream(line);
     int row, col;
 
-    Field field = game_state.get_field();
-
-    int size = game_state.get_size();
-    if (field.size() != size)
-    {
-        field.resize(size, std::vector<bool>(size, false));
-    }
-
     while (stream >> row >> col)
     {
 
-        field[row - 1][col - 1] = true;
+        add_cell(row - 1, col - 1);
     }
-
-    game_state.set_field(field);
 }
@@ -0,0 +1,91 @@
+#include "GameOfLife.hpp"
+
+#include "EmbeddedPatterns.hpp"
+
+namespace
+{
+    std::set<int> rule_counts(unsigned mask)
+    {
+        std::set<int> counts;
+        for (int n = 0; n <= 8; ++n)
+        {
+            if ((mask >> n) & 1)
+            {
+                counts.insert(n);
+            }
+        }
+        return counts;
+    }
+}
+
+std::span<const PatternLibrary::Pattern> PatternLibrary::get_patterns()
+{
+    return PATTERNS;
+}
+
+const PatternLibrary::Pattern *PatternLibrary::find(std::string_view name)
+{
+    for (const Pattern &pattern : PATTERNS)
+    {
+        if (pattern.name == name)
+        {
+            return &pattern;
+        }
+    }
+    return nullptr;
+}
+
+void PatternLibrary::load(std::string_view name, GameState &game)
+{
+    const Pattern *pattern = find(name);
+    if (pattern == nullptr)
+    {
+        throw std::invalid_argument("Unknown pattern: " + std::string(name) + ". Built-in patterns: " + list_names());
+    }
+    load(*pattern, game);
+}
+
+void PatternLibrary::load(const Pattern &pattern, GameState &game)
+{
+    game = GameState();
+    game.set_game_version(std::string(pattern.version));
+    game.set_universe_name(std::string(pattern.title));
+    game.set_size(pattern.size);
+    game.set_B_conditions(rule_counts(pattern.births));
+    game.set_S_conditions(rule_counts(pattern.survivals));
+
+    PackedField field(pattern.size);
+    std::copy(pattern.words.begin(), pattern.words.end(), field.get_words().begin());
+    game.swap_field(field);
+}
+
+const PatternLibrary::Pattern &PatternLibrary::random_game()
+{
+    std::vector<const Pattern *> games;
+    for (const Pattern &pattern : PATTERNS)
+    {
+        if (pattern.is_game)
+        {
+            games.push_back(&pattern);
+        }
+    }
+    if (games.empty())
+    {
+        throw std::logic_error("No games are built into the program");
+    }
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<size_t> distrib(0, games.size() - 1);
+    return *games[distrib(gen)];
+}
+
+std::string PatternLibrary::list_names()
+{
+    std::string names;
+    for (const Pattern &pattern : PATTERNS)
+    {
+        names += (names.empty() ? "" : ", ") + std::string(pattern.name);
+    }
+    return names;
+}
@@ -0,0 +1,174 @@
+#include "GameOfLife.hpp"
+
+ScriptRunner::ScriptRunner(GameState &game, std::ostream &output)
+    : game(game), output(output), pending_ticks(0), engine_calls(0), heat_map() {}
+
+void ScriptRunner::add_generation_callback(const std::function<void(const GameState &)> &callback)
+{
+    generation_callbacks.push_back(callback);
+}
+
+void ScriptRunner::run(std::istream &script)
+{
+    std::string line;
+    int line_number = 0;
+    while (std::getline(script, line))
+    {
+        ++line_number;
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        ParserCommands command;
+        try
+        {
+            command.parse_command(line);
+        }
+        catch (const InvalidCommandException &e)
+        {
+            throw InvalidCommandException("line " + std::to_string(line_number) + ": " + e.what());
+        }
+
+        // Ticks are only collected here, the engine runs before the next command needs the field
+        if (command.get_command() == '2')
+        {
+            pending_ticks += command.get_iterations();
+            continue;
+        }
+
+        flush_ticks();
+        try
+        {
+            if (!execute(command))
+            {
+                return;
+            }
+        }
+        catch (const InvalidCommandException &e)
+        {
+            throw InvalidCommandException("line " + std::to_string(line_number) + ": " + e.what());
+        }
+        catch (const std::runtime_error &e)
+        {
+            throw std::runtime_error("line " + std::to_string(line_number) + ": " + e.what());
+        }
+    }
+    flush_ticks();
+}
+
+long long ScriptRunner::get_engine_calls() const
+{
+    return engine_calls;
+}
+
+void ScriptRunner::flush_ticks()
+{
+    while (pending_ticks > 0)
+    {
+        int ticks = static_cast<int>(std::min<long long>(pending_ticks, std::numeric_limits<int>::max()));
+        GameEngine engine(game, ticks);
+        for (const auto &callback : generation_callbacks)
+        {
+            engine.add_generation_callback(callback);
+        }
+        if (heat_map)
+        {
+            engine.add_generation_callback([this](const GameState &state)
+                                           { heat_map->add(state.get_packed_field()); });
+        }
+        engine.UpdateGameState();
+
+        pending_ticks -= ticks;
+        ++engine_calls;
+    }
+}
+
+bool ScriptRunner::execute(const ParserCommands &command)
+{
+    switch (command.get_command())
+    {
+    case '1':
+    {
+        LiveFileWriter writer(command.get_filename());
+        writer.write(game);
+        return true;
+    }
+    case '3':
+        return false;
+    case 'b':
+    {
+        const std::string &image_file = command.get_filename();
+        FrameExporter exporter(command.get_scale(), image_file.substr(image_file.size() - 4) == ".pgm");
+        exporter.write_to_file(game.get_packed_field(), image_file);
+        return true;
+    }
+    case 'e':
+    {
+        GameState loaded;
+        if (command.is_builtin_pattern())
+        {
+            PatternLibrary::load(command.get_filename(), loaded);
+        }
+        else
+        {
+            ParserFile parser_file(command.get_filename());
+            parser_file.parse(loaded);
+        }
+        game = loaded;
+        heat_map.reset();
+
+        // Observers such as a recording start over on the new field
+        for (const auto &callback : generation_callbacks)
+        {
+            callback(game);
+        }
+        return true;
+    }
+    case 'f':
+        output << game.get_stats() << "\n";
+        return true;
+    case 'g':
+    {
+        const std::array<int, 4> &region = command.get_region();
+        output << game.get_region(region[0], region[1], region[2], region[3]);
+        return true;
+    }
+    case 'h':
+    {
+        Census census;
+        census.take(game.get_packed_field(), game.get_B_conditions(), game.get_S_conditions());
+        output << census.format();
+        return true;
+    }
+    case 'i':
+    {
+        std::optional<HeatMap::Mode> mode = command.get_heat_mode();
+        heat_map = mode ? std::make_unique<HeatMap>(*mode, game) : nullptr;
+        return true;
+    }
+    case 'j':
+        if (!heat_map)
+        {
+            throw InvalidCommandException("Nothing is counted. Use the heat command first.");
+        }
+        heat_map->write_to_file(command.get_filename());
+        return true;
+    case 'k':
+        if (command.get_trace_switch())
+        {
+            Tracer::instance().set_enabled(*command.get_trace_switch());
+        }
+        else
+        {
+            Tracer::instance().write_to_file(command.get_filename());
+            Tracer::instance().clear();
+        }
+        return true;
+    }
+    throw InvalidCommandException("Command not supported in scripts.");
+}
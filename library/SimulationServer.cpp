@@ -0,0 +1,371 @@
+#include "GameOfLife.hpp"
+
+// Constructor: prepares the server without opening the socket
+SimulationServer::SimulationServer(const std::string &socket_path, int worker_count)
+    : socket_path(socket_path),
+      worker_count(worker_count > 0 ? worker_count : 1),
+      listen_fd(-1),
+      running(false) {}
+
+SimulationServer::~SimulationServer()
+{
+    stop();
+}
+
+void SimulationServer::start()
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path))
+    {
+        throw std::invalid_argument("Socket path is too long: " + socket_path);
+    }
+    std::copy(socket_path.begin(), socket_path.end(), address.sun_path);
+
+    listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0)
+    {
+        throw std::runtime_error("It couldn't create a socket.");
+    }
+
+    ::unlink(socket_path.c_str());
+    if (::bind(listen_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+        ::listen(listen_fd, 128) < 0)
+    {
+        ::close(listen_fd);
+        listen_fd = -1;
+        throw std::runtime_error("It couldn't listen on: " + socket_path);
+    }
+
+    running = true;
+    for (int i = 0; i < worker_count; ++i)
+    {
+        workers.emplace_back(&SimulationServer::run_worker, this);
+    }
+    acceptor = std::thread(&SimulationServer::accept_connections, this);
+}
+
+void SimulationServer::stop()
+{
+    if (!running.exchange(false))
+    {
+        return;
+    }
+
+    // Wake up the acceptor, the connections and the workers
+    ::shutdown(listen_fd, SHUT_RDWR);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int fd : connection_fds)
+        {
+            ::shutdown(fd, SHUT_RDWR);
+        }
+    }
+    work_ready.notify_all();
+
+    if (acceptor.joinable())
+    {
+        acceptor.join();
+    }
+    for (auto &[id, connection] : connections)
+    {
+        connection.join();
+    }
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+    connections.clear();
+    finished_connections.clear();
+    workers.clear();
+
+    ::close(listen_fd);
+    listen_fd = -1;
+    ::unlink(socket_path.c_str());
+}
+
+std::string SimulationServer::handle_request(const std::string &request)
+{
+    // Request format: <session> <command>
+    std::string line = request.substr(0, request.find_last_not_of(" \t\r\n") + 1);
+    size_t space = line.find(' ');
+    std::string session_id = line.substr(0, space);
+    std::string command_text = space == std::string::npos ? "" : line.substr(space + 1);
+
+    if (session_id.empty())
+    {
+        return "ERR Request must start with a session name.\n";
+    }
+
+    auto job = std::make_shared<Job>();
+    try
+    {
+        job->command.parse_command(command_text);
+    }
+    catch (const InvalidCommandException &e)
+    {
+        return std::string("ERR ") + e.what() + "\n";
+    }
+
+    char command = job->command.get_command();
+    if (command != '1' && command != '2' && command != '3' && command != 'e' && command != 'f' && command != 'g')
+    {
+        return "ERR Command not supported by the server.\n";
+    }
+    job->remaining = command == '2' ? job->command.get_iterations() : 0;
+    std::future<std::string> response = job->response.get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running)
+        {
+            return "ERR Server is stopping.\n";
+        }
+
+        auto found = sessions.find(session_id);
+        if (found == sessions.end())
+        {
+            if (command != 'e')
+            {
+                return "ERR Unknown session: " + session_id + "\n";
+            }
+            found = sessions.emplace(session_id, std::make_shared<Session>()).first;
+        }
+
+        std::shared_ptr<Session> session = found->second;
+        session->jobs.push_back(job);
+        if (!session->queued)
+        {
+            session->queued = true;
+            ready.push_back(session);
+            work_ready.notify_one();
+        }
+        if (command == '3')
+        {
+            sessions.erase(found);
+        }
+    }
+
+    return response.get();
+}
+
+size_t SimulationServer::get_session_count() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return sessions.size();
+}
+
+void SimulationServer::run_worker()
+{
+    while (true)
+    {
+        std::shared_ptr<Session> session;
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            work_ready.wait(lock, [this]
+                            { return !running || !ready.empty(); });
+            if (ready.empty())
+            {
+                return;
+            }
+            session = ready.front();
+            ready.pop_front();
+
+            // Connections append jobs under the lock, only this worker removes them
+            job = session->jobs.front();
+        }
+
+        // Only this worker touches the game of the session until it is queued again
+        bool finished = execute_slice(*session, *job);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (finished)
+        {
+            session->jobs.pop_front();
+        }
+        if (session->jobs.empty())
+        {
+            session->queued = false;
+        }
+        else
+        {
+            // Round robin: other sessions get their turn before the next slice
+            ready.push_back(session);
+            work_ready.notify_one();
+        }
+    }
+}
+
+bool SimulationServer::execute_slice(Session &session, Job &job)
+{
+    GameState &game = session.game;
+    try
+    {
+        switch (job.command.get_command())
+        {
+        case '1':
+        {
+            LiveFileWriter writer(job.command.get_filename());
+            writer.write(game);
+            job.response.set_value("OK\n");
+            return true;
+        }
+        case '2':
+        {
+            // Long ticks are split into slices of bounded work
+            long long cells = std::max<long long>(1, static_cast<long long>(game.get_size()) * game.get_size());
+            int slice = static_cast<int>(std::clamp<long long>(SLICE_CELLS / cells, 1, job.remaining));
+            GameEngine engine(game, slice);
+            engine.UpdateGameState();
+            job.remaining -= slice;
+            if (job.remaining > 0)
+            {
+                return false;
+            }
+            job.response.set_value("OK generation=" + std::to_string(game.get_count_of_iterations()) + "\n");
+            return true;
+        }
+        case '3':
+            job.response.set_value("OK\n");
+            return true;
+        case 'e':
+        {
+            GameState loaded;
+            if (job.command.is_builtin_pattern())
+            {
+                PatternLibrary::load(job.command.get_filename(), loaded);
+            }
+            else
+            {
+                ParserFile parser_file(job.command.get_filename());
+                parser_file.parse(loaded);
+            }
+            game = loaded;
+            job.response.set_value("OK " + game.get_stats() + "\n");
+            return true;
+        }
+        case 'f':
+            job.response.set_value("OK " + game.get_stats() + "\n");
+            return true;
+        case 'g':
+        {
+            const std::array<int, 4> &region = job.command.get_region();
+            // The region is clamped to the field, and so are the dimensions in the response
+            int height = std::min(region[2], game.get_size());
+            int width = std::min(region[3], game.get_size());
+            job.response.set_value("OK " + std::to_string(height) + " " + std::to_string(width) + "\n" +
+                                   game.get_region(region[0], region[1], height, width));
+            return true;
+        }
+        }
+        job.response.set_value("ERR Command not supported by the server.\n");
+    }
+    catch (const std::exception &e)
+    {
+        job.response.set_value(std::string("ERR ") + e.what() + "\n");
+    }
+    return true;
+}
+
+void SimulationServer::accept_connections()
+{
+    while (running)
+    {
+        int fd = ::accept(listen_fd, nullptr, nullptr);
+        if (fd < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return;
+        }
+
+        // Connections that ended are joined here, so a long-running server keeps only the open ones
+        std::vector<std::thread> finished;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running)
+            {
+                ::close(fd);
+                return;
+            }
+            for (std::thread::id id : finished_connections)
+            {
+                auto found = connections.find(id);
+                finished.push_back(std::move(found->second));
+                connections.erase(found);
+            }
+            finished_connections.clear();
+
+            connection_fds.insert(fd);
+            std::thread connection(&SimulationServer::serve_connection, this, fd);
+            std::thread::id id = connection.get_id();
+            connections.emplace(id, std::move(connection));
+        }
+        for (std::thread &connection : finished)
+        {
+            connection.join();
+        }
+    }
+}
+
+void SimulationServer::serve_connection(int fd)
+{
+    std::string buffer;
+    char chunk[4096];
+    bool connected = true;
+
+    while (connected && running)
+    {
+        size_t end = buffer.find('\n');
+        if (end == std::string::npos)
+        {
+            if (buffer.size() > MAX_REQUEST)
+            {
+                // A client that never ends its line would grow the buffer without bound
+                static const char error[] = "ERR Request line is too long.\n";
+                ::send(fd, error, sizeof(error) - 1, MSG_NOSIGNAL);
+                break;
+            }
+            ssize_t received = ::read(fd, chunk, sizeof(chunk));
+            if (received < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (received <= 0)
+            {
+                break;
+            }
+            buffer.append(chunk, received);
+            continue;
+        }
+
+        std::string response = handle_request(buffer.substr(0, end));
+        buffer.erase(0, end + 1);
+
+        const char *data = response.data();
+        size_t left = response.size();
+        while (left > 0)
+        {
+            ssize_t written = ::send(fd, data, left, MSG_NOSIGNAL);
+            if (written < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (written <= 0)
+            {
+                connected = false;
+                break;
+            }
+            data += written;
+            left -= written;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    connection_fds.erase(fd);
+    ::close(fd);
+    finished_connections.push_back(std::this_thread::get_id());
+}
@@ -0,0 +1,212 @@
+#include "GameOfLife.hpp"
+
+// Default constructor
+SparseField::SparseField() : size(0), tiles_per_side(0), tiles(), candidates() {}
+
+// Copies every tile that has a live cell
+SparseField::SparseField(const PackedField &field)
+    : size(field.get_size()),
+      tiles_per_side(field.get_stride()),
+      tiles(),
+      candidates()
+{
+    const uint64_t *words = field.get_words().data();
+    for (int tile_row = 0; tile_row * TILE < size; ++tile_row)
+    {
+        int first = tile_row * TILE;
+        int rows = std::min(TILE, size - first);
+        for (int tile_col = 0; tile_col < tiles_per_side; ++tile_col)
+        {
+            Tile tile{};
+            uint64_t any = 0;
+            for (int r = 0; r < rows; ++r)
+            {
+                tile[r] = words[static_cast<size_t>(first + r) * tiles_per_side + tile_col];
+                any |= tile[r];
+            }
+            if (any != 0)
+            {
+                tiles.emplace(static_cast<uint32_t>(tile_row * tiles_per_side + tile_col), tile);
+            }
+        }
+    }
+}
+
+void SparseField::to_packed(PackedField &field) const
+{
+    if (field.get_size() != size)
+    {
+        field = PackedField(size);
+    }
+    PackedWords &words = field.get_words();
+    std::fill(words.begin(), words.end(), 0);
+
+    for (const auto &[key, tile] : tiles)
+    {
+        int first = static_cast<int>(key) / tiles_per_side * TILE;
+        int tile_col = static_cast<int>(key) % tiles_per_side;
+        int rows = std::min(TILE, size - first);
+        for (int r = 0; r < rows; ++r)
+        {
+            words[static_cast<size_t>(first + r) * tiles_per_side + tile_col] = tile[r];
+        }
+    }
+}
+
+int SparseField::get_size() const
+{
+    return size;
+}
+
+size_t SparseField::get_tile_count() const
+{
+    return tiles.size();
+}
+
+size_t SparseField::get_tile_capacity() const
+{
+    return static_cast<size_t>(tiles_per_side) * tiles_per_side;
+}
+
+long long SparseField::population() const
+{
+    long long count = 0;
+    for (const auto &entry : tiles)
+    {
+        for (uint64_t word : entry.second)
+        {
+            count += std::popcount(word);
+        }
+    }
+    return count;
+}
+
+size_t SparseField::memory_bytes() const
+{
+    // A node holds the key, the tile and the link to the next node
+    size_t node = sizeof(std::pair<const uint32_t, Tile>) + sizeof(void *);
+    return tiles.size() * node + tiles.bucket_count() * sizeof(void *) + candidates.capacity() * sizeof(uint32_t);
+}
+
+size_t SparseField::count_occupied_tiles(const PackedField &field)
+{
+    int size = field.get_size();
+    int stride = field.get_stride();
+    const uint64_t *words = field.get_words().data();
+    std::vector<uint64_t> any(stride);
+
+    size_t count = 0;
+    for (int first = 0; first < size; first += TILE)
+    {
+        // The words of a tile column are ORed over the rows of the tile
+        std::fill(any.begin(), any.end(), 0);
+        int rows = std::min(TILE, size - first);
+        for (int r = 0; r < rows; ++r)
+        {
+            const uint64_t *row = words + static_cast<size_t>(first + r) * stride;
+            for (int w = 0; w < stride; ++w)
+            {
+                any[w] |= row[w];
+            }
+        }
+        count += std::count_if(any.begin(), any.end(), [](uint64_t word)
+                               { return word != 0; });
+    }
+    return count;
+}
+
+void SparseField::step(SparseField &next, const std::array<bool, 9> &births, const std::array<bool, 9> &survivals)
+{
+    // Only occupied tiles and their neighbors can have live cells in the next generation
+    candidates.clear();
+    for (const auto &entry : tiles)
+    {
+        int tile_row = static_cast<int>(entry.first) / tiles_per_side;
+        int tile_col = static_cast<int>(entry.first) % tiles_per_side;
+        for (int dr = -1; dr <= 1; ++dr)
+        {
+            for (int dc = -1; dc <= 1; ++dc)
+            {
+                int r = (tile_row + dr + tiles_per_side) % tiles_per_side;
+                int c = (tile_col + dc + tiles_per_side) % tiles_per_side;
+                candidates.push_back(static_cast<uint32_t>(r * tiles_per_side + c));
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    next.size = size;
+    next.tiles_per_side = tiles_per_side;
+    next.tiles.clear();
+    Tile result;
+    GameEngine::RuleCounts rule = GameEngine::get_rule_counts(births, survivals);
+    for (uint32_t key : candidates)
+    {
+        if (step_tile(static_cast<int>(key) / tiles_per_side, static_cast<int>(key) % tiles_per_side, rule, result))
+        {
+            next.tiles.emplace(key, result);
+        }
+    }
+}
+
+bool SparseField::step_tile(int tile_row, int tile_col, const GameEngine::RuleCounts &rule, Tile &result) const
+{
+    static const Tile EMPTY{};
+    int last = tiles_per_side - 1;
+    int last_bit = (size - 1) & 63;
+    uint64_t last_mask = last_bit == 63 ? ~uint64_t(0) : (uint64_t(2) << last_bit) - 1;
+
+    // The 3 x 3 tiles around this one, wrapping around the field; missing tiles are empty
+    const Tile *around[3][3];
+    for (int dr = 0; dr < 3; ++dr)
+    {
+        for (int dc = 0; dc < 3; ++dc)
+        {
+            int r = (tile_row + dr - 1 + tiles_per_side) % tiles_per_side;
+            int c = (tile_col + dc - 1 + tiles_per_side) % tiles_per_side;
+            auto it = tiles.find(static_cast<uint32_t>(r * tiles_per_side + c));
+            around[dr][dc] = it == tiles.end() ? &EMPTY : &it->second;
+        }
+    }
+
+    // Neighbors on the left and on the right of 64 cells, wrapping around the row like GameEngine::step_row
+    auto west = [&](const Tile *const *row, int r)
+    {
+        uint64_t left = (*row[0])[r];
+        uint64_t carry = tile_col > 0 ? left >> 63 : (left >> last_bit) & 1;
+        return ((*row[1])[r] << 1) | carry;
+    };
+    auto east = [&](const Tile *const *row, int r)
+    {
+        uint64_t right = (*row[2])[r];
+        uint64_t carry = tile_col < last ? right << 63 : (right & 1) << last_bit;
+        return ((*row[1])[r] >> 1) | carry;
+    };
+
+    int first = tile_row * TILE;
+    int rows = std::min(TILE, size - first);
+    int up_last = ((first + size - 1) % size) & (TILE - 1); // Row of the tile above next to this tile
+    uint64_t any = 0;
+    for (int r = 0; r < rows; ++r)
+    {
+        // The rows above and below come from the tiles above and below at the edges of the tile
+        const Tile *const *up = r > 0 ? around[1] : around[0];
+        const Tile *const *down = r + 1 < rows ? around[1] : around[2];
+        int up_row = r > 0 ? r - 1 : up_last;
+        int down_row = r + 1 < rows ? r + 1 : 0;
+
+        uint64_t word = GameEngine::step_word(west(up, up_row), (*up[1])[up_row], east(up, up_row),
+                                              west(around[1], r), east(around[1], r),
+                                              west(down, down_row), (*down[1])[down_row], east(down, down_row),
+                                              (*around[1][1])[r], rule);
+        if (tile_col == last)
+        {
+            word &= last_mask;
+        }
+        result[r] = word;
+        any |= word;
+    }
+    std::fill(result.begin() + rows, result.end(), 0);
+    return any != 0;
+}
@@ -0,0 +1,135 @@
+#include "GameOfLife.hpp"
+
+// Constructor: prepares the runner without starting the worker
+TickRunner::TickRunner(GameState &game)
+    : game(game),
+      requested(0),
+      first_generation(0),
+      started(),
+      cancelled(false),
+      completed(0),
+      finished(true),
+      error(),
+      worker()
+{
+}
+
+TickRunner::~TickRunner()
+{
+    cancel();
+    if (worker.joinable())
+    {
+        worker.join();
+    }
+}
+
+void TickRunner::add_generation_callback(const std::function<void(const GameState &)> &callback)
+{
+    generation_callbacks.push_back(callback);
+}
+
+void TickRunner::start(int generations)
+{
+    if (worker.joinable())
+    {
+        throw std::logic_error("A tick is already running.");
+    }
+    requested = generations;
+    first_generation = game.get_count_of_iterations();
+    started = std::chrono::steady_clock::now();
+    cancelled = false;
+    completed = 0;
+    finished = false;
+    error = nullptr;
+
+    worker = std::thread([this]
+                         {
+                             std::exception_ptr failure;
+                             Tracer::instance().set_thread_name("tick runner");
+                             try
+                             {
+                                 GameEngine engine(game, requested);
+                                 engine.set_cancel_flag(&cancelled);
+                                 engine.add_generation_callback([this](const GameState &)
+                                                                { completed.fetch_add(1, std::memory_order_relaxed); });
+                                 for (const auto &callback : generation_callbacks)
+                                 {
+                                     engine.add_generation_callback(callback);
+                                 }
+                                 engine.UpdateGameState();
+                             }
+                             catch (...)
+                             {
+                                 failure = std::current_exception();
+                             }
+
+                             std::lock_guard<std::mutex> lock(mutex);
+                             error = failure;
+                             finished = true;
+                             finished_changed.notify_all(); });
+}
+
+void TickRunner::cancel()
+{
+    cancelled = true;
+}
+
+bool TickRunner::wait_for(std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    return finished_changed.wait_for(lock, timeout, [this]
+                                     { return finished; });
+}
+
+void TickRunner::wait()
+{
+    if (worker.joinable())
+    {
+        worker.join();
+    }
+    if (error)
+    {
+        std::rethrow_exception(std::exchange(error, nullptr));
+    }
+}
+
+long long TickRunner::get_completed() const
+{
+    return completed;
+}
+
+bool TickRunner::is_cancelled() const
+{
+    return cancelled;
+}
+
+std::string TickRunner::format_progress() const
+{
+    long long done = completed;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    double rate = seconds > 0 ? done / seconds : 0;
+
+    std::ostringstream text;
+    text << "generation " << first_generation + done << " (" << done << " of " << requested << ", "
+         << (requested > 0 ? 100 * done / requested : 100) << "%), " << static_cast<long long>(rate) << " gen/s, ETA ";
+    if (rate <= 0)
+    {
+        text << "unknown";
+        return text.str();
+    }
+
+    long long left = static_cast<long long>((requested - done) / rate);
+    if (left >= 3600)
+    {
+        text << left / 3600 << " h " << left % 3600 / 60 << " min";
+    }
+    else if (left >= 60)
+    {
+        text << left / 60 << " min " << left % 60 << " s";
+    }
+    else
+    {
+        text << left << " s";
+    }
+    return text.str();
+}
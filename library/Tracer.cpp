@@ -0,0 +1,235 @@
+#include "GameOfLife.hpp"
+
+namespace
+{
+    // Writes a string as a JSON string literal
+    void append_json_string(std::string &json, const std::string &text)
+    {
+        json += '"';
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                json += '\\';
+                json += c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                json += escaped;
+            }
+            else
+            {
+                json += c;
+            }
+        }
+        json += '"';
+    }
+
+    // Nanoseconds as the microseconds of trace events
+    void append_microseconds(std::string &json, int64_t nanoseconds)
+    {
+        char number[32];
+        std::snprintf(number, sizeof(number), "%lld.%03lld", static_cast<long long>(nanoseconds / 1000),
+                      static_cast<long long>(nanoseconds % 1000));
+        json += number;
+    }
+}
+
+std::atomic<bool> Tracer::enabled{false};
+
+Tracer &Tracer::instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::RingOwner::~RingOwner()
+{
+    if (ring != nullptr)
+    {
+        std::lock_guard<std::mutex> lock(instance().rings_mutex);
+        ring->in_use = false;
+    }
+}
+
+void Tracer::set_enabled(bool on)
+{
+    int64_t unset = 0;
+    origin.compare_exchange_strong(unset, now());
+    enabled.store(on, std::memory_order_relaxed);
+}
+
+Tracer::Ring &Tracer::local_ring()
+{
+    thread_local RingOwner owner;
+    if (owner.ring == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        for (const std::unique_ptr<Ring> &ring : rings)
+        {
+            if (!ring->in_use)
+            {
+                owner.ring = ring.get();
+                break;
+            }
+        }
+        if (owner.ring == nullptr)
+        {
+            rings.push_back(std::make_unique<Ring>());
+            owner.ring = rings.back().get();
+            owner.ring->slots = std::make_unique<Slot[]>(RING_CAPACITY);
+        }
+        owner.ring->in_use = true;
+
+        // The events of the previous owners stay on their own tracks until they leave the ring
+        ++track_count;
+        owner.ring->tracks.push_back(Track{owner.ring->head.load(std::memory_order_relaxed), track_count,
+                                           "thread " + std::to_string(track_count)});
+        drop_old_tracks(*owner.ring);
+    }
+    return *owner.ring;
+}
+
+void Tracer::drop_old_tracks(Ring &ring)
+{
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    uint64_t oldest = std::max(head >= RING_CAPACITY ? head - RING_CAPACITY + 1 : 0,
+                               ring.cleared.load(std::memory_order_relaxed));
+    size_t old = 0;
+    while (old + 1 < ring.tracks.size() && ring.tracks[old + 1].first <= oldest)
+    {
+        ++old;
+    }
+    ring.tracks.erase(ring.tracks.begin(), ring.tracks.begin() + old);
+}
+
+void Tracer::record(const char *name, int64_t start, int64_t end, long long generation)
+{
+    Ring &ring = local_ring();
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+
+    // A reader that sees any store to the slot also sees the head that makes it drop the slot
+    std::atomic_thread_fence(std::memory_order_release);
+    Slot &slot = ring.slots[head % RING_CAPACITY];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.duration.store(end - start, std::memory_order_relaxed);
+    slot.generation.store(generation, std::memory_order_relaxed);
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+void Tracer::set_thread_name(const std::string &name)
+{
+    if (!is_enabled())
+    {
+        return;
+    }
+    Ring &ring = local_ring();
+    std::lock_guard<std::mutex> lock(rings_mutex);
+    ring.tracks.back().thread_name = name;
+}
+
+std::vector<std::pair<int, Tracer::Event> > Tracer::get_events() const
+{
+    std::vector<std::pair<int, Event> > events;
+    std::lock_guard<std::mutex> lock(rings_mutex);
+    for (const std::unique_ptr<Ring> &ring : rings)
+    {
+        // The oldest slot is the next one the owner writes, so it is never read
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t first = std::max(head >= RING_CAPACITY ? head - RING_CAPACITY + 1 : 0,
+                                  ring->cleared.load(std::memory_order_relaxed));
+        size_t copied = events.size();
+        size_t track = 0;
+        for (uint64_t i = first; i < head; ++i)
+        {
+            while (track + 1 < ring->tracks.size() && ring->tracks[track + 1].first <= i)
+            {
+                ++track;
+            }
+            const Slot &slot = ring->slots[i % RING_CAPACITY];
+            events.emplace_back(ring->tracks[track].number,
+                                Event{slot.name.load(std::memory_order_relaxed), slot.start.load(std::memory_order_relaxed),
+                                      slot.duration.load(std::memory_order_relaxed),
+                                      slot.generation.load(std::memory_order_relaxed)});
+        }
+
+        // Events the owner overwrote while they were copied are dropped
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t end = ring->head.load(std::memory_order_relaxed);
+        uint64_t valid = end >= RING_CAPACITY ? end - RING_CAPACITY + 1 : 0;
+        if (valid > first)
+        {
+            size_t torn = static_cast<size_t>(std::min(valid, head) - first);
+            events.erase(events.begin() + copied, events.begin() + copied + torn);
+        }
+    }
+    return events;
+}
+
+std::string Tracer::to_json() const
+{
+    std::vector<std::pair<int, Event> > events = get_events();
+    int64_t start = origin.load();
+    int pid = static_cast<int>(getpid());
+
+    std::string json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    const char *separator = "\n";
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        for (const std::unique_ptr<Ring> &ring : rings)
+        {
+            for (const Track &track : ring->tracks)
+            {
+                json += separator;
+                json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + std::to_string(pid) +
+                        ",\"tid\":" + std::to_string(track.number) + ",\"args\":{\"name\":";
+                append_json_string(json, track.thread_name);
+                json += "}}";
+                separator = ",\n";
+            }
+        }
+    }
+    for (const auto &[track, event] : events)
+    {
+        json += separator;
+        json += "{\"name\":";
+        append_json_string(json, event.name);
+        json += ",\"cat\":\"life\",\"ph\":\"X\",\"ts\":";
+        append_microseconds(json, event.start - start);
+        json += ",\"dur\":";
+        append_microseconds(json, event.duration);
+        json += ",\"pid\":" + std::to_string(pid) + ",\"tid\":" + std::to_string(track);
+        if (event.generation >= 0)
+        {
+            json += ",\"args\":{\"generation\":" + std::to_string(event.generation) + "}";
+        }
+        json += "}";
+        separator = ",\n";
+    }
+    json += "\n]}\n";
+    return json;
+}
+
+void Tracer::write_to_file(const std::string &file_name) const
+{
+    std::ofstream file(file_name, std::ios::binary);
+    file << to_json();
+    if (!file)
+    {
+        throw std::runtime_error("It couldn't write the trace to " + file_name);
+    }
+}
+
+void Tracer::clear()
+{
+    // Only the owner of a ring advances its head, so clearing moves the start of the ring instead
+    std::lock_guard<std::mutex> lock(rings_mutex);
+    for (const std::unique_ptr<Ring> &ring : rings)
+    {
+        ring->cleared.store(ring->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+        drop_old_tracks(*ring);
+    }
+}
@@ -0,0 +1,141 @@
+#include "GameOfLife.hpp"
+
+// Constructor: sets the memory budget of the stored deltas
+UndoHistory::UndoHistory(size_t budget_bytes)
+    : budget_bytes(budget_bytes),
+      used_bytes(0),
+      entries(),
+      current(),
+      current_states(),
+      current_generation(-1) {}
+
+void UndoHistory::reset(const GameState &game)
+{
+    entries.clear();
+    used_bytes = 0;
+    if (budget_bytes == 0)
+    {
+        return;
+    }
+    current = game.get_packed_field();
+    current_states = game.copy_cell_states();
+    current_generation = game.get_count_of_iterations();
+}
+
+void UndoHistory::record(const GameState &game)
+{
+    if (budget_bytes == 0)
+    {
+        return;
+    }
+    if (game.get_count_of_iterations() != current_generation + 1 || game.get_size() != current.get_size())
+    {
+        // The state changed outside of the stepping loop
+        reset(game);
+        return;
+    }
+
+    PackedField next(game.get_packed_field());
+    std::vector<uint8_t> next_states = game.copy_cell_states();
+    if (next_states.size() != current_states.size())
+    {
+        // The rule gained or lost its dying states
+        reset(game);
+        return;
+    }
+    const PackedWords &before = current.get_words();
+    const PackedWords &after = next.get_words();
+
+    // Store only the words that changed
+    Entry entry;
+    entry.generation = current_generation;
+    for (size_t w = 0; w < after.size(); ++w)
+    {
+        if (uint64_t diff = before[w] ^ after[w])
+        {
+            entry.indexes.push_back(static_cast<uint32_t>(w));
+            entry.bits.push_back(diff);
+        }
+    }
+    for (size_t i = 0; i < next_states.size(); ++i)
+    {
+        if (uint8_t diff = current_states[i] ^ next_states[i])
+        {
+            entry.cells.push_back(static_cast<uint32_t>(i));
+            entry.states.push_back(diff);
+        }
+    }
+    entry.indexes.shrink_to_fit();
+    entry.bits.shrink_to_fit();
+    entry.cells.shrink_to_fit();
+    entry.states.shrink_to_fit();
+
+    used_bytes += entry_bytes(entry);
+    entries.push_back(std::move(entry));
+    while (used_bytes > budget_bytes && !entries.empty())
+    {
+        used_bytes -= entry_bytes(entries.front());
+        entries.pop_front();
+    }
+
+    current = std::move(next);
+    current_states = std::move(next_states);
+    current_generation = game.get_count_of_iterations();
+}
+
+int UndoHistory::undo(int steps, GameState &game)
+{
+    int undone = 0;
+    PackedWords &words = current.get_words();
+    while (undone < steps && !entries.empty())
+    {
+        const Entry &entry = entries.back();
+        for (size_t i = 0; i < entry.indexes.size(); ++i)
+        {
+            words[entry.indexes[i]] ^= entry.bits[i];
+        }
+        for (size_t i = 0; i < entry.cells.size(); ++i)
+        {
+            current_states[entry.cells[i]] ^= entry.states[i];
+        }
+        current_generation = entry.generation;
+        used_bytes -= entry_bytes(entry);
+        entries.pop_back();
+        ++undone;
+    }
+
+    if (undone > 0)
+    {
+        // The dying cells of Generations rules come back with the field
+        PackedField field(current);
+        std::vector<uint8_t> states(current_states);
+        game.swap_cells(field, states);
+        game.set_count_of_iterations(current_generation);
+    }
+    return undone;
+}
+
+void UndoHistory::rewind(int generation, GameState &game)
+{
+    if (generation > current_generation || generation < get_oldest_generation())
+    {
+        throw std::out_of_range("Generation " + std::to_string(generation) + " is not in the undo history.");
+    }
+    undo(current_generation - generation, game);
+}
+
+int UndoHistory::get_oldest_generation() const
+{
+    return entries.empty() ? current_generation : entries.front().generation;
+}
+
+size_t UndoHistory::get_memory_usage() const
+{
+    return used_bytes;
+}
+
+size_t UndoHistory::entry_bytes(const Entry &entry)
+{
+    return sizeof(Entry) + entry.indexes.capacity() * sizeof(uint32_t) + entry.bits.capacity() * sizeof(uint64_t) +
+           entry.cells.capacity() * sizeof(uint32_t) + entry.states.capacity() * sizeof(uint8_t);
+}
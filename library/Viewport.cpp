@@ -0,0 +1,128 @@
+#include "GameOfLife.hpp"
+
+namespace
+{
+    // Braille dot bits indexed by [dot row][dot column]
+    const int BRAILLE_DOTS[4][2] = {{0x01, 0x08}, {0x02, 0x10}, {0x04, 0x20}, {0x40, 0x80}};
+}
+
+// Constructor: sets the viewport size in terminal characters
+Viewport::Viewport(int width, int height)
+    : width(width), height(height), origin_row(0), origin_col(0), zoom(1), threshold(1), frame() {}
+
+void Viewport::set_dimensions(int new_width, int new_height)
+{
+    width = std::max(new_width, 1);
+    height = std::max(new_height, 1);
+}
+
+int Viewport::get_width() const
+{
+    return width;
+}
+
+int Viewport::get_height() const
+{
+    return height;
+}
+
+void Viewport::pan(int rows, int cols)
+{
+    origin_row += rows;
+    origin_col += cols;
+}
+
+void Viewport::set_zoom(int new_zoom)
+{
+    if (new_zoom <= 0 || (new_zoom & (new_zoom - 1)) != 0)
+    {
+        throw std::invalid_argument("Zoom must be a positive power of two.");
+    }
+
+    // Keep the center of the view in place
+    origin_row += static_cast<long long>(height) * 4 * (zoom - new_zoom) / 2;
+    origin_col += static_cast<long long>(width) * 2 * (zoom - new_zoom) / 2;
+    zoom = new_zoom;
+}
+
+int Viewport::get_zoom() const
+{
+    return zoom;
+}
+
+void Viewport::fit(int field_size)
+{
+    zoom = 1;
+    while (static_cast<long long>(width) * 2 * zoom < field_size ||
+           static_cast<long long>(height) * 4 * zoom < field_size)
+    {
+        zoom *= 2;
+    }
+    origin_row = 0;
+    origin_col = 0;
+}
+
+void Viewport::set_threshold(int cells)
+{
+    threshold = std::max(cells, 1);
+}
+
+int Viewport::count_block(const PackedField &field, long long row, long long col) const
+{
+    int size = field.get_size();
+
+    // A block larger than the universe would only count cells twice
+    int length = std::min(zoom, size);
+    int start = static_cast<int>(((col % size) + size) % size);
+    int first_part = std::min(length, size - start);
+
+    int count = 0;
+    for (int r = 0; r < length; ++r)
+    {
+        int wrapped_row = static_cast<int>((((row + r) % size) + size) % size);
+
+        count += field.count_range(wrapped_row, start, first_part);
+        if (first_part < length)
+        {
+            count += field.count_range(wrapped_row, 0, length - first_part);
+        }
+    }
+    return count;
+}
+
+const std::string &Viewport::render(const PackedField &field)
+{
+    frame.clear();
+    if (field.get_size() == 0)
+    {
+        return frame;
+    }
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            int dots = 0;
+            for (int dy = 0; dy < 4; ++dy)
+            {
+                for (int dx = 0; dx < 2; ++dx)
+                {
+                    long long row = origin_row + static_cast<long long>(y * 4 + dy) * zoom;
+                    long long col = origin_col + static_cast<long long>(x * 2 + dx) * zoom;
+                    if (count_block(field, row, col) >= threshold)
+                    {
+                        dots |= BRAILLE_DOTS[dy][dx];
+                    }
+                }
+            }
+
+            // U+2800 + dots encoded as UTF-8
+            int code = 0x2800 + dots;
+            frame += static_cast<char>(0xE0 | (code >> 12));
+            frame += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            frame += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        frame += '\n';
+    }
+    return frame;
+}
@@ -3,5 +3,5 @@
 int main(int argc, char **argv)
 {
     GameInterface game(argc, argv);
-    return 0;
-}
\ No newline at end of file
+    return game.get_exit_code();
+}
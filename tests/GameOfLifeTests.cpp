@@ -1,4 +1,5 @@
 #include "../library/GameOfLife.hpp"
+#include "../library/GameOfLife.h"
 #include <gtest/gtest.h>
 
 TEST(ParserCommandLineTest, ValidArgumentsInMode1)
@@ -234,3 +235,1626 @@ TEST(ParserFileTest, WrongFile)
 
     EXPECT_THROW(parser_file.parse(game), std::invalid_argument);
 }
+
+TEST(ParserCommandsTest, ValidCommandRecordAndGoto)
+{
+    ParserCommands parser_commands;
+
+    parser_commands.parse_command("record");
+    EXPECT_EQ(parser_commands.get_command(), '5');
+    EXPECT_EQ(parser_commands.get_keyframe_interval(), 32);
+
+    parser_commands.parse_command("record 8");
+    EXPECT_EQ(parser_commands.get_keyframe_interval(), 8);
+    EXPECT_THROW(parser_commands.get_generation(), std::runtime_error);
+
+    parser_commands.parse_command("goto 15");
+    EXPECT_EQ(parser_commands.get_command(), '6');
+    EXPECT_EQ(parser_commands.get_generation(), 15);
+    EXPECT_THROW(parser_commands.get_keyframe_interval(), std::runtime_error);
+}
+
+TEST(ParserCommandsTest, IncorrectCommandRecordAndGoto)
+{
+    ParserCommands parser_commands;
+
+    EXPECT_THROW(parser_commands.parse_command("record 0"), std::runtime_error);
+    EXPECT_THROW(parser_commands.parse_command("record 4x"), std::runtime_error);
+    EXPECT_THROW(parser_commands.parse_command("goto"), std::runtime_error);
+    EXPECT_THROW(parser_commands.parse_command("goto -3"), std::runtime_error);
+    EXPECT_THROW(parser_commands.parse_command("goto 3 4"), std::runtime_error);
+}
+
+static GameState make_glider_game(int size)
+{
+    GameState game;
+    game.set_size(size);
+    game.set_B_conditions({3});
+    game.set_S_conditions({2, 3});
+
+    Field field(size, std::vector<bool>(size, false));
+    field[0][1] = true;
+    field[1][2] = true;
+    field[2][0] = true;
+    field[2][1] = true;
+    field[2][2] = true;
+    game.set_field(field);
+    return game;
+}
+
+TEST(PackedFieldTest, PackAndUnpack)
+{
+    GameState game = make_glider_game(70);
+    PackedField packed(game.get_field());
+
+    EXPECT_EQ(packed.get_size(), 70);
+    EXPECT_EQ(packed.get_stride(), 2);
+    EXPECT_EQ(packed.population(), 5);
+    EXPECT_TRUE(packed.get(2, 2));
+    EXPECT_FALSE(packed.get(2, 3));
+
+    packed.set(69, 69, true);
+    EXPECT_TRUE(packed.get(69, 69));
+    EXPECT_EQ(packed.to_field()[69][69], true);
+
+    packed.set(69, 69, false);
+    EXPECT_EQ(packed.to_field(), game.get_field());
+}
+
+TEST(HistoryRecorderTest, CompressRoundTrip)
+{
+    std::vector<uint64_t> words = {0, 0, 0, 7, 0, 1ULL << 63, ~0ULL, 0, 0};
+    std::vector<uint8_t> data = HistoryRecorder::compress(words);
+
+    std::vector<uint64_t> restored(words.size(), 42);
+    HistoryRecorder::decompress(data, restored);
+    EXPECT_EQ(restored, words);
+}
+
+TEST(HistoryRecorderTest, SeekRestoresRecordedGenerations)
+{
+    GameState game = make_glider_game(16);
+    GameState reference = game;
+
+    HistoryRecorder recorder(4);
+    recorder.record(game);
+    GameEngine engine(game, 10);
+    engine.add_generation_callback([&recorder](const GameState &state)
+                                   { recorder.record(state); });
+    engine.UpdateGameState();
+
+    EXPECT_EQ(recorder.get_first_generation(), 0);
+    EXPECT_EQ(recorder.get_last_generation(), 10);
+
+    for (int generation = 10; generation >= 0; --generation)
+    {
+        GameState expected = reference;
+        GameEngine(expected, generation).UpdateGameState();
+
+        recorder.seek(generation, game);
+        EXPECT_EQ(game.get_field(), expected.get_field());
+        EXPECT_EQ(game.get_count_of_iterations(), generation);
+    }
+    EXPECT_THROW(recorder.seek(11, game), std::out_of_range);
+}
+
+TEST(HistoryRecorderTest, RecordingAfterSeekReplacesFuture)
+{
+    GameState game = make_glider_game(16);
+    HistoryRecorder recorder(3);
+    recorder.record(game);
+    GameEngine engine(game, 8);
+    engine.add_generation_callback([&recorder](const GameState &state)
+                                   { recorder.record(state); });
+    engine.UpdateGameState();
+    GameState expected = game;
+
+    recorder.seek(5, game);
+    GameEngine continued(game, 3);
+    continued.add_generation_callback([&recorder](const GameState &state)
+                                      { recorder.record(state); });
+    continued.UpdateGameState();
+
+    EXPECT_EQ(recorder.get_last_generation(), 8);
+    recorder.seek(8, game);
+    EXPECT_EQ(game.get_field(), expected.get_field());
+}
+
+TEST(HistoryRecorderTest, LoadChecksTheFile)
+{
+    GameState game = make_glider_game(16);
+    HistoryRecorder recorder(3);
+    recorder.record(game);
+    GameEngine engine(game, 7);
+    engine.add_generation_callback([&recorder](const GameState &state)
+                                   { recorder.record(state); });
+    engine.UpdateGameState();
+
+    std::string file = testing::TempDir() + "history_test.golh";
+    recorder.save(file);
+    std::string saved;
+    {
+        std::ifstream in(file, std::ios::binary);
+        saved.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    HistoryRecorder loaded;
+    GameState restored = make_glider_game(16);
+    loaded.load(file, restored);
+    loaded.seek(7, restored);
+    EXPECT_EQ(restored.get_field(), game.get_field());
+    EXPECT_THROW(loaded.load(file, make_glider_game(20)), std::runtime_error);
+
+    // Header of 20 bytes, then the first record: generation, keyframe flag and data length
+    auto load_changed = [&](size_t offset, const std::string &bytes)
+    {
+        std::string changed = saved;
+        changed.replace(offset, bytes.size(), bytes);
+        std::ofstream(file, std::ios::binary) << changed;
+        loaded.load(file, restored);
+    };
+    EXPECT_THROW(load_changed(20, std::string("\x05\0\0\0", 4)), std::runtime_error);
+    EXPECT_THROW(load_changed(24, std::string("\0", 1)), std::runtime_error);
+    EXPECT_THROW(load_changed(25, std::string("\0\0\0\0\x01\0\0\0", 8)), std::runtime_error);
+    EXPECT_EQ(loaded.get_last_generation(), 7);
+}
+
+TEST(ParserCommandLineTest, QuietMode)
+{
+    const char *argv[] = {"program_name", "example.live", "--quiet", "-i", "10", "-o", "output.live"};
+    int argc = 7;
+
+    ParserCommandLine parser_command_line(argc, const_cast<char **>(argv));
+
+    EXPECT_EQ(parser_command_line.get_mode(), '3');
+    EXPECT_TRUE(parser_command_line.is_quiet());
+    EXPECT_EQ(parser_command_line.get_iterations(), 10);
+
+    const char *argv2[] = {"program_name", "example.live", "-q"};
+    EXPECT_THROW(ParserCommandLine(3, const_cast<char **>(argv2)), std::invalid_argument);
+}
+
+TEST(LiveFileWriterTest, WritesLifeFormat)
+{
+    GameState game = make_glider_game(16);
+    game.set_game_version("1.06");
+    game.set_universe_name("glider");
+
+    std::string file = testing::TempDir() + "writer_test.live";
+    {
+        LiveFileWriter writer(file, 64);
+        writer.write(game);
+    }
+
+    std::ifstream in(file);
+    std::stringstream content;
+    content << in.rdbuf();
+    EXPECT_EQ(content.str(), "#Life 1.06\n#N glider\n#Size 16\n#R B3/S23\n1 2\n2 3\n3 1\n3 2\n3 3\n");
+
+    GameState loaded;
+    ParserFile(file).parse(loaded);
+    EXPECT_EQ(loaded.get_field(), game.get_field());
+}
+
+TEST(DiffRendererTest, FullFrame)
+{
+    PackedField field(2);
+    field.set(0, 1, true);
+
+    DiffRenderer renderer;
+    EXPECT_EQ(renderer.build_full(field), ". O \n. . \n");
+}
+
+TEST(DiffRendererTest, RedrawsOnlyChangedCells)
+{
+    PackedField field(16);
+    DiffRenderer renderer;
+    renderer.build_full(field);
+
+    field.set(0, 1, true);
+    field.set(2, 2, true);
+    EXPECT_EQ(renderer.build_update(field, 1), "\033[F\033[K\033[16A\033[3GO \033[2B\033[5GO \033[14B\r");
+
+    EXPECT_EQ(renderer.build_update(field, 1), "\033[F\033[K\r");
+
+    field.set(2, 2, false);
+    EXPECT_EQ(renderer.build_update(field, 0), "\033[14A\033[5G. \033[14B\r");
+
+    for (int col = 0; col < 16; ++col)
+    {
+        field.set(15, col, true);
+    }
+    EXPECT_EQ(renderer.build_update(field, 0), "\033[1A\rO O O O O O O O O O O O O O O O \033[1B\r");
+}
+
+TEST(ParserCommandsTest, ValidCommandPanAndZoom)
+{
+    ParserCommands parser_commands;
+
+    parser_commands.parse_command("pan -10 25");
+    EXPECT_EQ(parser_commands.get_command(), '7');
+    EXPECT_EQ(parser_commands.get_pan_rows(), -10);
+    EXPECT_EQ(parser_commands.get_pan_cols(), 25);
+
+    parser_commands.parse_command("zoom 4");
+    EXPECT_EQ(parser_commands.get_command(), '8');
+    EXPECT_EQ(parser_commands.get_zoom(), 4);
+    EXPECT_THROW(parser_commands.get_pan_rows(), std::runtime_error);
+
+    EXPECT_THROW(parser_commands.parse_command("pan 1"), std::runtime_error);
+    EXPECT_THROW(parser_commands.parse_command("zoom 3"), std::runtime_error);
+    EXPECT_THROW(parser_commands.parse_command("zoom -2"), std::runtime_error);
+}
+
+TEST(ViewportTest, BrailleDotsAndPooling)
+{
+    PackedField field(8);
+    field.set(0, 0, true);
+    field.set(3, 1, true);
+
+    Viewport viewport(1, 1);
+    EXPECT_EQ(viewport.render(field), "⢁\n");
+
+    viewport.pan(-1, -1);
+    EXPECT_EQ(viewport.render(field), "⠐\n");
+
+    PackedField sparse(8);
+    sparse.set(5, 5, true);
+    Viewport pooled(2, 1);
+    pooled.set_zoom(2);
+    pooled.pan(2, 2);
+    EXPECT_EQ(pooled.render(sparse), "⠀⠄\n");
+
+    pooled.set_threshold(2);
+    EXPECT_EQ(pooled.render(sparse), "⠀⠀\n");
+}
+
+TEST(TripleBufferTest, ConsumerGetsLatestValue)
+{
+    TripleBuffer<int> buffer;
+    EXPECT_FALSE(buffer.acquire());
+
+    buffer.write_buffer() = 1;
+    buffer.publish();
+    buffer.write_buffer() = 2;
+    buffer.publish();
+    EXPECT_TRUE(buffer.has_pending());
+
+    EXPECT_TRUE(buffer.acquire());
+    EXPECT_EQ(buffer.read_buffer(), 2);
+    EXPECT_FALSE(buffer.acquire());
+    EXPECT_EQ(buffer.read_buffer(), 2);
+}
+
+TEST(ContinuousRunnerTest, StopsAtConsistentGeneration)
+{
+    GameState game = make_glider_game(16);
+    GameState reference = game;
+
+    std::atomic<int> frames(0);
+    ContinuousRunner runner(game, 100);
+    runner.start([&frames](const PackedField &field, int)
+                 { EXPECT_EQ(field.population(), 5); ++frames; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    runner.stop();
+
+    EXPECT_GT(frames, 0);
+    EXPECT_EQ(game.get_count_of_iterations(), runner.get_computed_generations());
+
+    GameEngine(reference, game.get_count_of_iterations()).UpdateGameState();
+    EXPECT_EQ(game.get_field(), reference.get_field());
+}
+
+TEST(FrameExporterTest, PackedBitmap)
+{
+    PackedField field(10);
+    field.set(0, 0, true);
+    field.set(0, 9, true);
+    field.set(9, 3, true);
+
+    FrameExporter exporter;
+    const std::string &image = exporter.encode(field);
+
+    std::string header = "P4\n10 10\n";
+    ASSERT_EQ(image.size(), header.size() + 20);
+    EXPECT_EQ(image.substr(0, header.size()), header);
+    EXPECT_EQ(static_cast<uint8_t>(image[header.size()]), 0x80);
+    EXPECT_EQ(static_cast<uint8_t>(image[header.size() + 1]), 0x40);
+    EXPECT_EQ(static_cast<uint8_t>(image[header.size() + 18]), 0x10);
+    EXPECT_EQ(static_cast<uint8_t>(image[header.size() + 19]), 0x00);
+}
+
+TEST(FrameExporterTest, DownscaledGraymap)
+{
+    PackedField field(4);
+    field.set(0, 0, true);
+    field.set(1, 1, true);
+    field.set(2, 3, true);
+
+    FrameExporter exporter(2, true);
+    EXPECT_EQ(exporter.encode(field), std::string("P5\n2 2\n255\n") + char(128) + char(255) + char(255) + char(192));
+
+    FrameExporter bitmap(2);
+    EXPECT_EQ(bitmap.encode(field), std::string("P4\n2 2\n") + char(0x80) + char(0x40));
+}
+
+TEST(ParserCommandsTest, ValidCommandExport)
+{
+    ParserCommands parser_commands;
+
+    parser_commands.parse_command("export frame.pgm 4");
+    EXPECT_EQ(parser_commands.get_command(), 'b');
+    EXPECT_EQ(parser_commands.get_filename(), "frame.pgm");
+    EXPECT_EQ(parser_commands.get_scale(), 4);
+
+    EXPECT_THROW(parser_commands.parse_command("export frame.png"), std::runtime_error);
+    EXPECT_THROW(parser_commands.parse_command("export frame.pbm 0"), std::runtime_error);
+}
+
+TEST(ParserCommandLineTest, FrameStreamingImpliesQuiet)
+{
+    const char *argv[] = {"program_name", "example.live", "-i", "10", "-o", "output.live", "--frames=5", "--scale=4"};
+    int argc = 8;
+
+    ParserCommandLine parser_command_line(argc, const_cast<char **>(argv));
+
+    EXPECT_TRUE(parser_command_line.is_quiet());
+    EXPECT_EQ(parser_command_line.get_frame_interval(), 5);
+    EXPECT_EQ(parser_command_line.get_frame_scale(), 4);
+}
+
+TEST(ParserCommandsTest, ValidCommandUndoAndRewind)
+{
+    ParserCommands parser_commands;
+
+    parser_commands.parse_command("undo");
+    EXPECT_EQ(parser_commands.get_command(), 'c');
+    EXPECT_EQ(parser_commands.get_undo_steps(), 1);
+
+    parser_commands.parse_command("undo 5");
+    EXPECT_EQ(parser_commands.get_undo_steps(), 5);
+
+    parser_commands.parse_command("rewind 3");
+    EXPECT_EQ(parser_commands.get_command(), 'd');
+    EXPECT_EQ(parser_commands.get_generation(), 3);
+    EXPECT_THROW(parser_commands.get_undo_steps(), std::runtime_error);
+
+    EXPECT_THROW(parser_commands.parse_command("undo 0"), std::runtime_error);
+    EXPECT_THROW(parser_commands.parse_command("rewind"), std::runtime_error);
+}
+
+TEST(UndoHistoryTest, UndoAndRewind)
+{
+    GameState game = make_glider_game(16);
+    std::vector<Field> fields = {game.get_field()};
+
+    UndoHistory history;
+    history.reset(game);
+    GameEngine engine(game, 1);
+    engine.add_generation_callback([&history](const GameState &state)
+                                   { history.record(state); });
+    for (int i = 0; i < 6; ++i)
+    {
+        engine.UpdateGameState();
+        fields.push_back(game.get_field());
+    }
+
+    EXPECT_EQ(history.undo(2, game), 2);
+    EXPECT_EQ(game.get_count_of_iterations(), 4);
+    EXPECT_EQ(game.get_field(), fields[4]);
+
+    engine.UpdateGameState();
+    EXPECT_EQ(game.get_field(), fields[5]);
+
+    history.rewind(1, game);
+    EXPECT_EQ(game.get_count_of_iterations(), 1);
+    EXPECT_EQ(game.get_field(), fields[1]);
+
+    EXPECT_THROW(history.rewind(3, game), std::out_of_range);
+    EXPECT_EQ(history.undo(10, game), 1);
+    EXPECT_EQ(game.get_field(), fields[0]);
+    EXPECT_EQ(history.get_memory_usage(), 0u);
+}
+
+TEST(UndoHistoryTest, DropsOldestStepsOverBudget)
+{
+    GameState game = make_glider_game(16);
+    UndoHistory history(300);
+    history.reset(game);
+
+    GameEngine engine(game, 20);
+    engine.add_generation_callback([&history](const GameState &state)
+                                   { history.record(state); });
+    engine.UpdateGameState();
+
+    EXPECT_LE(history.get_memory_usage(), 300u);
+    EXPECT_GT(history.get_oldest_generation(), 0);
+    EXPECT_THROW(history.rewind(0, game), std::out_of_range);
+}
+
+TEST(UndoHistoryTest, RestoresDyingCells)
+{
+    // Brian's Brain: every live cell dies through one dying state
+    GameState game;
+    game.set_size(16);
+    game.set_B_conditions({2});
+    game.set_S_conditions({});
+    game.set_state_count(3);
+    game.set_cell(7, 7, true);
+    game.set_cell(7, 8, true);
+    game.set_cell(8, 7, true);
+
+    UndoHistory history;
+    history.reset(game);
+    HistoryRecorder recorder(2);
+    recorder.record(game);
+    std::vector<std::vector<uint8_t> > states = {game.copy_cell_states()};
+    GameEngine engine(game, 1);
+    engine.add_generation_callback([&](const GameState &state)
+                                   { history.record(state); recorder.record(state); });
+    for (int i = 0; i < 4; ++i)
+    {
+        engine.UpdateGameState();
+        states.push_back(game.copy_cell_states());
+    }
+    ASSERT_EQ(std::count(states[1].begin(), states[1].end(), 2), 3);
+
+    history.rewind(1, game);
+    EXPECT_EQ(game.copy_cell_states(), states[1]);
+    engine.UpdateGameState();
+    EXPECT_EQ(game.copy_cell_states(), states[2]);
+
+    // Stepping again from generation 1 replaced the recorded generations after it
+    for (int generation = 2; generation >= 0; --generation)
+    {
+        recorder.seek(generation, game);
+        EXPECT_EQ(game.copy_cell_states(), states[generation]);
+    }
+}
+
+TEST(ParserCommandsTest, ValidCommandLoadStatsRegion)
+{
+    ParserCommands parser_commands;
+
+    parser_commands.parse_command("load glider.live");
+    EXPECT_EQ(parser_commands.get_command(), 'e');
+    EXPECT_EQ(parser_commands.get_filename(), "glider.live");
+
+    parser_commands.parse_command("stats");
+    EXPECT_EQ(parser_commands.get_command(), 'f');
+
+    parser_commands.parse_command("region 1 2 3 4");
+    EXPECT_EQ(parser_commands.get_command(), 'g');
+    EXPECT_EQ(parser_commands.get_region(), (std::array<int, 4>{1, 2, 3, 4}));
+
+    EXPECT_THROW(parser_commands.parse_command("load"), std::runtime_error);
+    EXPECT_THROW(parser_commands.parse_command("stats 1"), std::runtime_error);
+    EXPECT_THROW(parser_commands.parse_command("region 1 2 3"), std::runtime_error);
+    EXPECT_THROW(parser_commands.parse_command("region 1 2 0 4"), std::runtime_error);
+    EXPECT_THROW(parser_commands.parse_command("region 0 0 2000000000 2000000000"), std::runtime_error);
+}
+
+TEST(GameStateTest, StatsAndRegion)
+{
+    GameState game = make_glider_game(8);
+
+    EXPECT_EQ(game.get_stats(), "generation=0 population=5 size=8 rule=B3/S23 storage=dense");
+    EXPECT_EQ(game.get_region(0, 0, 3, 3), ".O.\n..O\nOOO\n");
+    EXPECT_EQ(game.get_region(-1, 7, 2, 3), "...\n..O\n");
+    EXPECT_EQ(game.get_region(0, 0, 1, 100), ".O......\n");
+}
+
+TEST(SimulationServerTest, SessionLifecycle)
+{
+    std::string pattern = testing::TempDir() + "server_glider.live";
+    {
+        LiveFileWriter writer(pattern);
+        writer.write(make_glider_game(8));
+    }
+
+    SimulationServer server(testing::TempDir() + "server_test.sock", 2);
+    server.start();
+
+    EXPECT_EQ(server.handle_request("a stats").rfind("ERR", 0), 0u);
+    EXPECT_EQ(server.handle_request("a load " + pattern).rfind("OK", 0), 0u);
+    EXPECT_EQ(server.get_session_count(), 1u);
+
+    EXPECT_EQ(server.handle_request("a tick 4").rfind("OK", 0), 0u);
+    EXPECT_EQ(server.handle_request("a stats"), "OK generation=4 population=5 size=8 rule=B3/S23 storage=dense\n");
+    EXPECT_EQ(server.handle_request("a region 1 1 3 3"), "OK 3 3\n.O.\n..O\nOOO\n");
+    EXPECT_EQ(server.handle_request("a region 0 0 100 2").rfind("OK 8 2\n", 0), 0u);
+
+    // A line without an end is cut off instead of buffered forever
+    int client = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::string socket_path = testing::TempDir() + "server_test.sock";
+    std::copy(socket_path.begin(), socket_path.end(), address.sun_path);
+    ASSERT_EQ(::connect(client, reinterpret_cast<sockaddr *>(&address), sizeof(address)), 0);
+    std::string endless(100 << 10, 'x');
+    ::send(client, endless.data(), endless.size(), MSG_NOSIGNAL);
+    std::string reply;
+    char chunk[256];
+    for (ssize_t received; (received = ::read(client, chunk, sizeof(chunk))) > 0;)
+    {
+        reply.append(chunk, received);
+    }
+    ::close(client);
+    EXPECT_EQ(reply, "ERR Request line is too long.\n");
+
+    EXPECT_EQ(server.handle_request("a exit").rfind("OK", 0), 0u);
+    EXPECT_EQ(server.get_session_count(), 0u);
+
+    server.stop();
+    EXPECT_EQ(server.handle_request("a stats").rfind("ERR", 0), 0u);
+}
+
+TEST(ParserCommandLineTest, ScriptOption)
+{
+    const char *argv[] = {"program_name", "example.live", "--script=run.txt"};
+    ParserCommandLine parser_command_line(3, const_cast<char **>(argv));
+
+    EXPECT_EQ(parser_command_line.get_mode(), '1');
+    EXPECT_EQ(parser_command_line.get_script_file(), "run.txt");
+
+    const char *argv_batch[] = {"program_name", "example.live", "-i", "10", "-o", "output.live", "--script=run.txt"};
+    EXPECT_THROW(ParserCommandLine(7, const_cast<char **>(argv_batch)), std::invalid_argument);
+}
+
+TEST(ScriptRunnerTest, CoalescesTicks)
+{
+    GameState game = make_glider_game(8);
+    std::ostringstream output;
+    std::istringstream script("# glider\ntick 3\n\nt 1\ntick\nstats\nregion 1 1 3 3\ntick 2\nexit\ntick 5\n");
+
+    ScriptRunner runner(game, output);
+    runner.run(script);
+
+    EXPECT_EQ(runner.get_engine_calls(), 2);
+    EXPECT_EQ(game.get_count_of_iterations(), 7);
+    EXPECT_EQ(output.str(), "generation=5 population=5 size=8 rule=B3/S23 storage=dense\n"
+                            "...\n"
+                            "O.O\n"
+                            ".OO\n");
+}
+
+TEST(ScriptRunnerTest, DumpAndErrors)
+{
+    std::string dump = testing::TempDir() + "script_dump.live";
+    GameState game = make_glider_game(8);
+    std::ostringstream output;
+
+    ScriptRunner runner(game, output);
+    std::istringstream script("tick 4\ndump " + dump + "\nload " + dump + "\nstats\n");
+    runner.run(script);
+    EXPECT_EQ(output.str(), "generation=0 population=5 size=8 rule=B3/S23 storage=dense\n");
+    EXPECT_EQ(game.get_region(1, 1, 3, 3), ".O.\n..O\nOOO\n");
+
+    std::istringstream invalid("tick 1\nzoom 2\n");
+    EXPECT_THROW(runner.run(invalid), InvalidCommandException);
+    EXPECT_EQ(game.get_count_of_iterations(), 1);
+
+    std::istringstream missing("load missing_file.live\n");
+    EXPECT_THROW(runner.run(missing), std::runtime_error);
+}
+
+TEST(ScriptRunnerTest, LoadRestartsRecording)
+{
+    std::string moved = testing::TempDir() + "script_moved.live";
+    GameState later = make_glider_game(8);
+    GameEngine(later, 4).UpdateGameState();
+    LiveFileWriter(moved).write(later);
+
+    GameState game = make_glider_game(8);
+    std::ostringstream output;
+    HistoryRecorder recorder;
+    recorder.record(game);
+
+    ScriptRunner runner(game, output);
+    runner.add_generation_callback([&recorder](const GameState &state)
+                                   { recorder.record(state); });
+    std::istringstream script("tick 3\nload " + moved + "\ntick 2\n");
+    runner.run(script);
+
+    // The recording holds the loaded pattern only
+    EXPECT_EQ(recorder.get_first_generation(), 0);
+    EXPECT_EQ(recorder.get_last_generation(), 2);
+    GameState restored = make_glider_game(8);
+    recorder.seek(0, restored);
+    EXPECT_EQ(restored.get_region(1, 1, 3, 3), ".O.\n..O\nOOO\n");
+}
+
+TEST(ParserCommandLineTest, BatchSubcommand)
+{
+    const char *argv[] = {"program_name", "batch", "patterns/*.live", "100", "out", "--workers=3"};
+    ParserCommandLine parser_command_line(6, const_cast<char **>(argv));
+
+    EXPECT_EQ(parser_command_line.get_mode(), '4');
+    EXPECT_EQ(parser_command_line.get_input_file(), "patterns/*.live");
+    EXPECT_EQ(parser_command_line.get_iterations(), 100);
+    EXPECT_EQ(parser_command_line.get_output_file(), "out");
+    EXPECT_EQ(parser_command_line.get_worker_count(), 3);
+
+    const char *argv_short[] = {"program_name", "batch", "patterns", "100"};
+    EXPECT_THROW(ParserCommandLine(4, const_cast<char **>(argv_short)), std::invalid_argument);
+}
+
+TEST(BatchRunnerTest, RunsAllPatterns)
+{
+    std::filesystem::path input_dir = std::filesystem::path(testing::TempDir()) / "batch_in";
+    std::filesystem::path output_dir = std::filesystem::path(testing::TempDir()) / "batch_out";
+    std::filesystem::remove_all(input_dir);
+    std::filesystem::remove_all(output_dir);
+    std::filesystem::create_directories(input_dir);
+    std::filesystem::create_directories(output_dir);
+
+    for (int size : {8, 12, 16, 20, 24})
+    {
+        LiveFileWriter writer((input_dir / ("glider" + std::to_string(size) + ".live")).string());
+        writer.write(make_glider_game(size));
+    }
+    std::ofstream((input_dir / "broken.live").string()) << "#Life 1.06\n#Size 8\n#R 23/3\n";
+    std::ofstream((input_dir / "notes.txt").string()) << "not a pattern\n";
+
+    std::vector<std::string> files = BatchRunner::find_patterns(input_dir.string());
+    ASSERT_EQ(files.size(), 6u);
+    EXPECT_EQ(BatchRunner::find_patterns((input_dir / "glider1*.live").string()).size(), 2u);
+
+    BatchRunner runner(8, output_dir.string(), 3);
+    runner.run(files);
+
+    int failed = 0;
+    for (const BatchRunner::Job &job : runner.get_jobs())
+    {
+        if (!job.error.empty())
+        {
+            ++failed;
+            continue;
+        }
+        EXPECT_EQ(job.population, 5);
+
+        GameState result;
+        ParserFile parser_file(job.output_file);
+        parser_file.parse(result);
+        EXPECT_EQ(result.get_region(2, 2, 3, 3), ".O.\n..O\nOOO\n");
+    }
+    EXPECT_EQ(failed, 1);
+
+    runner.write_summary((output_dir / "summary.csv").string());
+    std::ifstream summary((output_dir / "summary.csv").string());
+    std::string line;
+    int lines = 0;
+    while (std::getline(summary, line))
+    {
+        if (lines++ > 0)
+        {
+            EXPECT_EQ(line.front(), '"');
+            EXPECT_EQ(line.back(), '"');
+        }
+    }
+    EXPECT_EQ(lines, 7);
+
+    // A pattern of the same name from another directory would overwrite the first result
+    std::filesystem::create_directories(input_dir / "more");
+    std::filesystem::copy_file(input_dir / "glider8.live", input_dir / "more" / "glider8.live",
+                               std::filesystem::copy_options::overwrite_existing);
+    files.push_back((input_dir / "more" / "glider8.live").string());
+    EXPECT_THROW(runner.run(files), std::invalid_argument);
+}
+
+TEST(GameEngineTest, PackedStepMatchesNeighborCount)
+{
+    std::mt19937 random(7);
+    const std::vector<std::pair<std::set<int>, std::set<int> > > rules = {
+        {{3}, {2, 3}}, {{3, 6}, {2, 3}}, {{0, 1, 8}, {0, 4, 5, 8}}, {{}, {1, 2, 3, 4, 5, 6, 7, 8}}};
+
+    for (int size : {1, 2, 3, 63, 64, 65, 130})
+    {
+        for (const auto &[births, survivals] : rules)
+        {
+            Field field(size, std::vector<bool>(size, false));
+            for (auto &row : field)
+            {
+                for (size_t col = 0; col < row.size(); ++col)
+                {
+                    row[col] = random() % 3 == 0;
+                }
+            }
+
+            GameState game;
+            game.set_size(size);
+            game.set_B_conditions(births);
+            game.set_S_conditions(survivals);
+            game.set_field(field);
+            GameEngine engine(game, 1);
+
+            Field expected = field;
+            for (int x = 0; x < size; ++x)
+            {
+                for (int y = 0; y < size; ++y)
+                {
+                    int neighbors = engine.countNeighbors(field, x, y);
+                    expected[x][y] = field[x][y] ? survivals.count(neighbors) > 0 : births.count(neighbors) > 0;
+                }
+            }
+
+            engine.UpdateGameState();
+            EXPECT_EQ(game.get_field(), expected) << "size " << size;
+        }
+    }
+}
+
+TEST(FieldArenaTest, RecyclesAlignedBlocks)
+{
+    FieldArena &arena = FieldArena::instance();
+    arena.release_cache();
+
+    void *small = arena.allocate(1000);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(small) % 64, 0u);
+    size_t reuses = arena.get_stats().reuses;
+    arena.deallocate(small, 1000);
+    EXPECT_EQ(arena.allocate(1000), small);
+    EXPECT_EQ(arena.get_stats().reuses, reuses + 1);
+    arena.deallocate(small, 1000);
+
+    for (FieldArena::HugePages policy : {FieldArena::HugePages::NONE, FieldArena::HugePages::TRANSPARENT, FieldArena::HugePages::EXPLICIT})
+    {
+        arena.set_huge_pages(policy);
+        size_t bytes = (4 << 20) + 8;
+        uint64_t *large = static_cast<uint64_t *>(arena.allocate(bytes));
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(large) % 64, 0u);
+        large[0] = 1;
+        large[bytes / 8 - 1] = 2;
+        arena.deallocate(large, bytes);
+        arena.release_cache();
+    }
+    arena.set_huge_pages(FieldArena::HugePages::TRANSPARENT);
+
+    // Successive engines reuse the buffers of the previous ones
+    GameState game = make_glider_game(512);
+    GameEngine(game, 2).UpdateGameState();
+    reuses = arena.get_stats().reuses;
+    GameEngine(game, 2).UpdateGameState();
+    EXPECT_GT(arena.get_stats().reuses, reuses);
+}
+
+TEST(OutOfCoreEngineTest, MatchesInMemoryEngine)
+{
+    std::string store = testing::TempDir() + "field.store";
+    std::string live = testing::TempDir() + "out_of_core.live";
+    std::mt19937 random(11);
+
+    GameState game;
+    game.set_size(130);
+    game.set_B_conditions({3});
+    game.set_S_conditions({2, 3});
+    for (int row = 0; row < 130; ++row)
+    {
+        for (int col = 0; col < 130; ++col)
+        {
+            game.set_cell(row, col, random() % 3 == 0);
+        }
+    }
+    {
+        LiveFileWriter writer(live);
+        writer.write(game);
+    }
+
+    // Bands of 7 rows do not divide the size, so the last band is shorter
+    OutOfCoreEngine::import_live(live, store);
+    OutOfCoreEngine engine(store, 7);
+    EXPECT_EQ(engine.get_band_rows(), 7);
+    engine.run(12);
+
+    GameEngine(game, 12).UpdateGameState();
+    EXPECT_EQ(engine.get_state().get_count_of_iterations(), 12);
+    EXPECT_EQ(engine.get_state().get_rule_string(), "B3/S23");
+
+    engine.export_live(live);
+    GameState result;
+    ParserFile parser_file(live);
+    parser_file.parse(result);
+    EXPECT_EQ(result.get_field(), game.get_field());
+
+    OutOfCoreEngine::create(make_glider_game(8), store);
+    OutOfCoreEngine glider(store);
+    glider.run(8);
+    glider.export_live(live);
+    GameState moved;
+    ParserFile(live).parse(moved);
+    EXPECT_EQ(moved.get_region(2, 2, 3, 3), ".O.\n..O\nOOO\n");
+
+    EXPECT_THROW(OutOfCoreEngine{live}, std::runtime_error);
+}
+
+TEST(ParserCommandsTest, ValidCommandCensus)
+{
+    ParserCommands parser_commands;
+    parser_commands.parse_command("census");
+    EXPECT_EQ(parser_commands.get_command(), 'h');
+    EXPECT_THROW(parser_commands.parse_command("census 5"), std::runtime_error);
+
+    const char *argv[] = {"program_name", "example.live", "-i", "10", "-o", "output.live", "--census=objects.txt"};
+    ParserCommandLine parser_command_line(7, const_cast<char **>(argv));
+    EXPECT_EQ(parser_command_line.get_census_file(), "objects.txt");
+
+    const char *argv_interactive[] = {"program_name", "example.live", "--census=objects.txt"};
+    EXPECT_THROW(ParserCommandLine(3, const_cast<char **>(argv_interactive)), std::invalid_argument);
+}
+
+TEST(CensusTest, CountsAndClassifiesObjects)
+{
+    GameState game;
+    game.set_size(64);
+    game.set_B_conditions({3});
+    game.set_S_conditions({2, 3});
+    auto place = [&game](int row, int col, const std::vector<std::string> &rows)
+    {
+        for (size_t r = 0; r < rows.size(); ++r)
+        {
+            for (size_t c = 0; c < rows[r].size(); ++c)
+            {
+                if (rows[r][c] == 'O')
+                {
+                    game.set_cell((row + static_cast<int>(r)) % 64, (col + static_cast<int>(c)) % 64, true);
+                }
+            }
+        }
+    };
+    place(5, 5, {"OO", "OO"});
+    place(5, 20, {"OO", "OO"});
+    place(40, 40, {"OO", "OO"});
+    place(63, 63, {"OO", "OO"}); // Wraps across both edges
+    place(20, 5, {"OOO"});
+    place(20, 20, {"O", "O", "O"});
+    place(30, 30, {"OOO", "O..", ".O."});
+    place(50, 10, {".O.", "..O", "OOO"}); // Moves the other way, but counts as the same object
+
+    Census census;
+    census.take(game.get_packed_field(), game.get_B_conditions(), game.get_S_conditions());
+
+    EXPECT_EQ(census.get_island_count(), 8);
+    const std::vector<Census::Object> &objects = census.get_objects();
+    ASSERT_EQ(objects.size(), 3u);
+
+    EXPECT_EQ(objects[0].name, "block");
+    EXPECT_EQ(objects[0].count, 4);
+    EXPECT_EQ(objects[0].kind, Census::Kind::STILL_LIFE);
+
+    EXPECT_EQ(objects[1].name, "blinker");
+    EXPECT_EQ(objects[1].count, 2);
+    EXPECT_EQ(objects[1].kind, Census::Kind::OSCILLATOR);
+    EXPECT_EQ(objects[1].period, 2);
+
+    // The move belongs to the canonical picture, not to either glider of the field
+    EXPECT_EQ(objects[2].name, "glider");
+    EXPECT_EQ(objects[2].count, 2);
+    EXPECT_EQ(objects[2].kind, Census::Kind::SPACESHIP);
+    EXPECT_EQ(objects[2].period, 4);
+    EXPECT_EQ(objects[2].dx, 1);
+    EXPECT_EQ(objects[2].dy, -1);
+}
+
+TEST(GameEngineTest, GenerationStream)
+{
+    GameState streamed = make_glider_game(8);
+    GameState updated = make_glider_game(8);
+    GameEngine(updated, 8).UpdateGameState();
+
+    GameEngine engine(streamed, 8);
+    std::set<const uint64_t *> buffers;
+    int count = 0;
+    for (const PackedField &field : engine.generations())
+    {
+        ++count;
+        EXPECT_EQ(streamed.get_count_of_iterations(), count);
+        EXPECT_EQ(field.population(), 5);
+        buffers.insert(field.get_words().data());
+    }
+    EXPECT_EQ(count, 8);
+    EXPECT_EQ(streamed.get_field(), updated.get_field());
+    EXPECT_EQ(buffers.size(), 2u); // The stream alternates between the field and the scratch field
+
+    // Leaving the loop stops the computation
+    GameState stopped = make_glider_game(8);
+    GameEngine long_engine(stopped, 1000);
+    for (const PackedField &field : long_engine.generations())
+    {
+        if (stopped.get_count_of_iterations() == 3)
+        {
+            EXPECT_EQ(field.population(), 5);
+            break;
+        }
+    }
+    EXPECT_EQ(stopped.get_count_of_iterations(), 3);
+}
+
+TEST(CApiTest, LoadStepAndReadCells)
+{
+    const std::string glider = "#Life 1.06\n#Size 8\n#R B3/S23\n1 2\n2 3\n3 1\n3 2\n3 3\n";
+    gol_universe *universe = gol_create(8);
+    ASSERT_NE(universe, nullptr);
+    ASSERT_EQ(gol_load(universe, glider.data(), glider.size()), GOL_OK);
+
+    std::vector<long long> generations;
+    gol_set_callback(universe, [](const gol_universe *, long long generation, void *user_data)
+                     { static_cast<std::vector<long long> *>(user_data)->push_back(generation); }, &generations);
+    ASSERT_EQ(gol_step(universe, 4), GOL_OK);
+    EXPECT_EQ(generations, (std::vector<long long>{1, 2, 3, 4}));
+    EXPECT_EQ(gol_generation(universe), 4);
+    EXPECT_EQ(gol_population(universe), 5);
+
+    // The glider moved from rows 0 to 2 one cell down and right
+    size_t stride = 0;
+    const uint64_t *cells = gol_cells(universe, &stride);
+    EXPECT_EQ(stride, 1u);
+    EXPECT_EQ(cells[1], uint64_t(1) << 2);
+    EXPECT_EQ(cells[2], uint64_t(1) << 3);
+    EXPECT_EQ(cells[3], (uint64_t(1) << 1) | (uint64_t(1) << 2) | (uint64_t(1) << 3));
+
+    const std::string broken = "#Life 1.06\n#Size 8\n#R 23/3\n";
+    EXPECT_EQ(gol_load(universe, broken.data(), broken.size()), GOL_ERROR_PARSE);
+    EXPECT_STRNE(gol_last_error(universe), "");
+    EXPECT_EQ(gol_population(universe), 5);
+    EXPECT_EQ(gol_step(universe, -1), GOL_ERROR_ARGUMENT);
+    EXPECT_EQ(gol_create(0), nullptr);
+    gol_destroy(universe);
+}
+
+TEST(GameEngineTest, GenerationsRuleMatchesReference)
+{
+    // Star Wars, B2/S345/C4, on a size that is not a multiple of 64
+    const int size = 70;
+    const int state_count = 4;
+    GameState game;
+    game.set_size(size);
+    game.set_B_conditions({2});
+    game.set_S_conditions({3, 4, 5});
+    game.set_state_count(state_count);
+
+    std::mt19937 random(7);
+    std::vector<uint8_t> expected(size * size);
+    for (int row = 0; row < size; ++row)
+    {
+        for (int col = 0; col < size; ++col)
+        {
+            int state = random() % 3 == 0 ? static_cast<int>(random() % state_count) : 0;
+            game.set_cell_state(row, col, state);
+            expected[row * size + col] = static_cast<uint8_t>(state);
+        }
+    }
+
+    for (int generation = 0; generation < 10; ++generation)
+    {
+        std::vector<uint8_t> next(size * size);
+        for (int row = 0; row < size; ++row)
+        {
+            for (int col = 0; col < size; ++col)
+            {
+                int neighbors = 0;
+                for (int dr = -1; dr <= 1; ++dr)
+                {
+                    for (int dc = -1; dc <= 1; ++dc)
+                    {
+                        if ((dr != 0 || dc != 0) && expected[((row + dr + size) % size) * size + (col + dc + size) % size] == 1)
+                        {
+                            ++neighbors;
+                        }
+                    }
+                }
+                int state = expected[row * size + col];
+                if (state == 0)
+                {
+                    next[row * size + col] = neighbors == 2 ? 1 : 0;
+                }
+                else if (state == 1 && neighbors >= 3 && neighbors <= 5)
+                {
+                    next[row * size + col] = 1;
+                }
+                else
+                {
+                    next[row * size + col] = static_cast<uint8_t>((state + 1) % state_count);
+                }
+            }
+        }
+        expected = next;
+    }
+
+    GameEngine(game, 10).UpdateGameState();
+    ASSERT_EQ(game.get_cell_states(), expected);
+    for (int row = 0; row < size; ++row)
+    {
+        for (int col = 0; col < size; ++col)
+        {
+            ASSERT_EQ(game.get_packed_field().get(row, col), expected[row * size + col] == 1);
+        }
+    }
+    EXPECT_EQ(game.get_rule_string(), "B2/S345/C4");
+}
+
+TEST(LiveFileWriterTest, PreservesDyingCells)
+{
+    GameState game;
+    game.set_size(8);
+    game.set_B_conditions({2});
+    game.set_S_conditions({});
+    game.set_state_count(3);
+    game.set_cell_state(2, 3, 1);
+    game.set_cell_state(2, 4, 2);
+
+    std::string file = testing::TempDir() + "generations_test.live";
+    LiveFileWriter(file).write(game);
+
+    std::ifstream in(file);
+    std::stringstream content;
+    content << in.rdbuf();
+    EXPECT_EQ(content.str(), "#Life 1.0\n#N Default\n#Size 8\n#R B2/S/C3\n3 4\n#D 3 5 2\n");
+
+    GameState loaded;
+    ParserFile(file).parse(loaded);
+    EXPECT_EQ(loaded.get_state_count(), 3);
+    EXPECT_EQ(loaded.get_cell_states(), game.get_cell_states());
+
+    std::istringstream broken("#Size 8\n#R B2/S/C1\n");
+    EXPECT_THROW(ParserFile("").parse(broken, loaded, [](int, int) {}), std::runtime_error);
+}
+
+TEST(ChangeListEngineTest, MatchesDenseEngine)
+{
+    // A soup across the edges of the field, so that changes wrap around
+    GameState dense;
+    dense.set_size(100);
+    dense.set_B_conditions({3});
+    dense.set_S_conditions({2, 3});
+    std::mt19937 random(3);
+    for (int row = -20; row < 20; ++row)
+    {
+        for (int col = -20; col < 20; ++col)
+        {
+            if (random() % 3 == 0)
+            {
+                dense.set_cell((row + 100) % 100, (col + 100) % 100, true);
+            }
+        }
+    }
+    GameState sparse = dense;
+
+    ChangeListEngine engine(sparse);
+    engine.run(10);
+    engine.run(20);
+    GameEngine(dense, 30).UpdateGameState();
+    EXPECT_EQ(sparse.get_count_of_iterations(), 30);
+    EXPECT_EQ(sparse.get_field(), dense.get_field());
+    EXPECT_GT(engine.get_change_count(), 0u);
+
+    // A state stepped by another engine gets new counts
+    GameEngine(sparse, 5).UpdateGameState();
+    GameEngine(dense, 10).UpdateGameState();
+    engine.run(5);
+    EXPECT_EQ(sparse.get_field(), dense.get_field());
+
+    GameState seeds = make_glider_game(8);
+    seeds.set_B_conditions({0, 3});
+    EXPECT_THROW(ChangeListEngine{seeds}, std::invalid_argument);
+}
+
+TEST(HeatMapTest, CountsLiveCellsAndChanges)
+{
+    // Blinker: the middle cell is always alive, the ends change every generation
+    GameState game;
+    game.set_size(8);
+    game.set_B_conditions({3});
+    game.set_S_conditions({2, 3});
+    game.set_cell(3, 2, true);
+    game.set_cell(3, 3, true);
+    game.set_cell(3, 4, true);
+
+    HeatMap alive(HeatMap::Mode::ALIVE, game);
+    HeatMap flips(HeatMap::Mode::FLIPS, game);
+    GameEngine engine(game, 5);
+    engine.add_generation_callback([&](const GameState &state)
+                                   {
+                                       alive.add(state.get_packed_field());
+                                       flips.add(state.get_packed_field()); });
+    engine.UpdateGameState();
+
+    EXPECT_EQ(alive.get_generations(), 5);
+    EXPECT_EQ(alive.get(3, 3), 5);
+    EXPECT_EQ(alive.get(2, 3), 3);
+    EXPECT_EQ(alive.get(3, 2), 2);
+    EXPECT_EQ(alive.get_max(), 5);
+    EXPECT_EQ(flips.get(3, 3), 0);
+    EXPECT_EQ(flips.get(2, 3), 5);
+    EXPECT_EQ(flips.get(0, 0), 0);
+
+    std::string file = testing::TempDir() + "heat_map_test.csv";
+    flips.write_to_file(file);
+    std::ifstream in(file);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line);)
+    {
+        lines.push_back(line);
+    }
+    ASSERT_EQ(lines.size(), 8u);
+    EXPECT_EQ(lines[3], "0,0,5,0,5,0,0,0");
+
+    // Counters stop at the largest 16-bit value
+    HeatMap saturated(HeatMap::Mode::ALIVE, game);
+    for (int i = 0; i < 70000; ++i)
+    {
+        saturated.add(game.get_packed_field());
+    }
+    EXPECT_EQ(saturated.get(3, 3), 65535);
+    EXPECT_EQ(saturated.get(0, 0), 0);
+}
+
+TEST(ParserCommandsTest, ValidCommandHeatAndHeatmap)
+{
+    ParserCommands parser_commands;
+
+    parser_commands.parse_command("heat flips");
+    EXPECT_EQ(parser_commands.get_command(), 'i');
+    EXPECT_EQ(parser_commands.get_heat_mode(), HeatMap::Mode::FLIPS);
+    parser_commands.parse_command("heat");
+    EXPECT_EQ(parser_commands.get_heat_mode(), HeatMap::Mode::ALIVE);
+    parser_commands.parse_command("heat off");
+    EXPECT_FALSE(parser_commands.get_heat_mode().has_value());
+
+    parser_commands.parse_command("heatmap activity.pgm");
+    EXPECT_EQ(parser_commands.get_command(), 'j');
+    EXPECT_EQ(parser_commands.get_filename(), "activity.pgm");
+
+    EXPECT_THROW(parser_commands.parse_command("heat often"), std::runtime_error);
+    EXPECT_THROW(parser_commands.parse_command("heatmap activity.png"), std::runtime_error);
+
+    const char *argv[] = {"program_name", "example.live", "-i", "10", "-o", "output.live", "--heat-map=heat.csv", "--heat-mode=flips"};
+    ParserCommandLine parser_command_line(8, const_cast<char **>(argv));
+    EXPECT_EQ(parser_command_line.get_heat_map_file(), "heat.csv");
+    EXPECT_EQ(parser_command_line.get_heat_mode(), HeatMap::Mode::FLIPS);
+}
+
+TEST(FixedUniverseTest, MatchesDynamicEngine)
+{
+    // The step is constexpr: a blinker returns after two generations at compile time
+    constexpr auto blinker = []
+    {
+        FixedUniverse<16, ConwayRule> universe;
+        universe.set(5, 4, true);
+        universe.set(5, 5, true);
+        universe.set(5, 6, true);
+        FixedUniverse<16, ConwayRule> stepped = universe;
+        stepped.step();
+        bool vertical = stepped.get(4, 5) && stepped.get(6, 5) && !stepped.get(5, 4);
+        stepped.step();
+        return vertical && stepped == universe && stepped.population() == 3;
+    }();
+    static_assert(blinker);
+
+    // Soups across the wrapped edges under both instantiated rules, and a size without instantiation
+    for (int size : {16, 32, 64, 25})
+    {
+        for (std::set<int> births : {std::set<int>{3}, std::set<int>{3, 6}})
+        {
+            GameState fixed;
+            fixed.set_size(size);
+            fixed.set_B_conditions(births);
+            fixed.set_S_conditions({2, 3});
+            std::mt19937 random(size);
+            for (int row = 0; row < size; ++row)
+            {
+                for (int col = 0; col < size; ++col)
+                {
+                    fixed.set_cell(row, col, random() % 3 == 0);
+                }
+            }
+            GameState dynamic = fixed;
+
+            GameEngine(fixed, 40).UpdateGameState();
+            // An observer needs every generation, which keeps the engine on the packed kernel
+            GameEngine engine(dynamic, 40);
+            engine.add_generation_callback([](const GameState &) {});
+            engine.UpdateGameState();
+
+            EXPECT_EQ(fixed.get_count_of_iterations(), 40);
+            EXPECT_EQ(fixed.get_field(), dynamic.get_field()) << "size " << size;
+        }
+    }
+}
+
+TEST(SparseFieldTest, SwitchesStorageWithDensity)
+{
+    // A soup in the corners of the field, so that it wraps across the edges of the tiles and of the field
+    for (int size : {1024, 1000})
+    {
+        GameState adaptive;
+        adaptive.set_size(size);
+        adaptive.set_B_conditions({3});
+        adaptive.set_S_conditions({2, 3});
+        std::mt19937 random(size);
+        for (int row = -20; row < 20; ++row)
+        {
+            for (int col = -20; col < 20; ++col)
+            {
+                adaptive.set_cell((row + size) % size, (col + size) % size, random() % 3 == 0);
+            }
+        }
+        GameState dense = adaptive;
+
+        GameEngine(adaptive, 100).UpdateGameState();
+        // An observer keeps the engine on the packed kernel
+        GameEngine engine(dense, 100);
+        engine.add_generation_callback([](const GameState &) {});
+        engine.UpdateGameState();
+
+        EXPECT_EQ(adaptive.get_storage(), GameState::Storage::SPARSE);
+        EXPECT_EQ(adaptive.get_count_of_iterations(), 100);
+        EXPECT_EQ(adaptive.get_packed_field().get_words(), dense.get_packed_field().get_words()) << "size " << size;
+        EXPECT_NE(adaptive.get_stats().find("storage=sparse (4 of 256 tiles occupied at generation 0, below 4.0%)"),
+                  std::string::npos)
+            << adaptive.get_stats();
+    }
+
+    // A sparse run whose field fills up returns to the packed kernel
+    GameState soup;
+    soup.set_size(256);
+    soup.set_B_conditions({3});
+    soup.set_S_conditions({2, 3});
+    std::mt19937 random(1);
+    for (int row = 0; row < 256; ++row)
+    {
+        for (int col = 0; col < 256; ++col)
+        {
+            soup.set_cell(row, col, random() % 3 == 0);
+        }
+    }
+    soup.set_storage(GameState::Storage::SPARSE, "");
+    SparseField tiles(soup.get_packed_field());
+    EXPECT_EQ(tiles.get_tile_count(), 16u);
+    EXPECT_EQ(tiles.population(), soup.get_population());
+    EXPECT_LT(tiles.memory_bytes(), 16u * 4096 + 1024);
+
+    GameEngine(soup, 5).UpdateGameState();
+    EXPECT_EQ(soup.get_storage(), GameState::Storage::DENSE);
+    EXPECT_EQ(soup.get_storage_reason(), "16 of 16 tiles occupied at generation 0, above 12.0%");
+
+    // Under B0 every empty cell is born, so a nearly empty field must not turn sparse
+    GameState b0;
+    b0.set_size(512);
+    b0.set_B_conditions({0});
+    b0.set_S_conditions({8});
+    b0.set_cell(100, 100, true);
+    GameEngine(b0, 1).UpdateGameState();
+    EXPECT_EQ(b0.get_storage(), GameState::Storage::DENSE);
+    EXPECT_EQ(b0.get_population(), 512LL * 512 - 9);
+}
+
+TEST(ParallelEngineTest, MatchesSerialEngineWithEveryPolicy)
+{
+    GameState start;
+    start.set_size(100);
+    start.set_B_conditions({3, 6});
+    start.set_S_conditions({2, 3});
+    std::mt19937 random(7);
+    for (int row = 0; row < 100; ++row)
+    {
+        for (int col = 0; col < 100; ++col)
+        {
+            start.set_cell(row, col, random() % 3 == 0);
+        }
+    }
+    GameState serial = start;
+    GameEngine(serial, 60).UpdateGameState();
+
+    NumaTopology topology;
+    ASSERT_FALSE(topology.get_nodes().empty());
+    ASSERT_FALSE(topology.get_nodes()[0].cpus.empty());
+
+    for (auto policy : {ParallelEngine::NumaPolicy::OFF, ParallelEngine::NumaPolicy::FIRST_TOUCH,
+                        ParallelEngine::NumaPolicy::BIND})
+    {
+        // One thread reads its own halo rows; seven threads get uneven bands
+        for (int threads : {1, 2, 7})
+        {
+            GameState parallel = start;
+            ParallelEngine engine(parallel, threads, policy, topology);
+            engine.run(25);
+            engine.run(35);
+            EXPECT_EQ(parallel.get_count_of_iterations(), 60);
+            EXPECT_EQ(parallel.get_packed_field().get_words(), serial.get_packed_field().get_words())
+                << threads << " threads";
+
+            const auto &workers = engine.get_workers();
+            ASSERT_EQ(workers.size(), static_cast<size_t>(threads));
+            EXPECT_EQ(workers.back().first_row + workers.back().row_count, 100);
+            EXPECT_EQ(workers[0].cpu >= 0, policy != ParallelEngine::NumaPolicy::OFF);
+        }
+    }
+
+    GameState generations = make_glider_game(8);
+    generations.set_state_count(3);
+    EXPECT_THROW(ParallelEngine(generations, 2, ParallelEngine::NumaPolicy::OFF, topology), std::invalid_argument);
+}
+
+TEST(NumaTopologyTest, ReadsNodesFromSysfs)
+{
+    EXPECT_EQ(NumaTopology::parse_cpu_list("0-2,5,7-8\n"), (std::vector<int>{0, 1, 2, 5, 7, 8}));
+    EXPECT_TRUE(NumaTopology::parse_cpu_list("").empty());
+    EXPECT_THROW(NumaTopology::parse_cpu_list("3-1"), std::invalid_argument);
+
+    // A two-node machine, the second node covering CPUs the process may not use, and a memory-only node
+    std::filesystem::path root = std::filesystem::path(testing::TempDir()) / "numa_topology_test";
+    std::filesystem::remove_all(root);
+    auto add_node = [&](const std::string &name, const std::string &cpus, const std::string &meminfo)
+    {
+        std::filesystem::create_directories(root / name);
+        std::ofstream(root / name / "cpulist") << cpus << "\n";
+        std::ofstream(root / name / "meminfo") << meminfo;
+    };
+    add_node("node0", "0", "Node 0 MemTotal:       2097152 kB\nNode 0 MemFree:  1024 kB\n");
+    add_node("node1", "0,600-601", "Node 1 MemTotal:       1048576 kB\n");
+    add_node("node2", "", "Node 2 MemTotal:       1048576 kB\n");
+    std::filesystem::create_directories(root / "power");
+
+    NumaTopology topology(root.string());
+    ASSERT_EQ(topology.get_nodes().size(), 2u);
+    EXPECT_EQ(topology.get_nodes()[0].id, 0);
+    EXPECT_EQ(topology.get_nodes()[1].id, 1);
+    EXPECT_EQ(topology.get_nodes()[1].cpus, (std::vector<int>{0}));
+    EXPECT_EQ(topology.report(), "node 0: 1 cpus (0), 2048 MiB\nnode 1: 1 cpus (0), 1024 MiB\n");
+
+    // Consecutive bands share a node
+    GameState game = make_glider_game(8);
+    ParallelEngine engine(game, 4, ParallelEngine::NumaPolicy::FIRST_TOUCH, topology);
+    std::vector<int> nodes;
+    for (const auto &worker : engine.get_workers())
+    {
+        nodes.push_back(worker.node);
+    }
+    EXPECT_EQ(nodes, (std::vector<int>{0, 0, 1, 1}));
+
+    // Without sysfs the machine is one node
+    NumaTopology flat((root / "missing").string());
+    ASSERT_EQ(flat.get_nodes().size(), 1u);
+    std::filesystem::remove_all(root);
+
+    const char *argv[] = {"program_name", "example.live", "-i", "10", "-o", "output.live", "--threads=4", "--numa=bind"};
+    ParserCommandLine parser_command_line(8, const_cast<char **>(argv));
+    EXPECT_EQ(parser_command_line.get_thread_count(), 4);
+    EXPECT_EQ(parser_command_line.get_numa_policy(), ParallelEngine::NumaPolicy::BIND);
+    const char *invalid[] = {"program_name", "example.live", "--threads=4"};
+    EXPECT_THROW(ParserCommandLine(3, const_cast<char **>(invalid)), std::invalid_argument);
+}
+
+TEST(TickRunnerTest, CancelsAtGenerationBoundary)
+{
+    GameState game = make_glider_game(16);
+    game.set_count_of_iterations(10);
+    TickRunner runner(game);
+    long long observed = 0;
+    runner.add_generation_callback([&observed](const GameState &)
+                                   { ++observed; });
+
+    runner.start(std::numeric_limits<int>::max());
+    while (runner.get_completed() < 1000)
+    {
+        std::this_thread::yield();
+    }
+    EXPECT_FALSE(runner.wait_for(std::chrono::milliseconds(0)));
+    runner.cancel();
+    runner.wait();
+
+    // The state holds the last completed generation and its number
+    long long completed = runner.get_completed();
+    EXPECT_TRUE(runner.is_cancelled());
+    EXPECT_EQ(observed, completed);
+    EXPECT_EQ(game.get_count_of_iterations(), 10 + completed);
+    GameState reference = make_glider_game(16);
+    GameEngine(reference, static_cast<int>(completed)).UpdateGameState();
+    EXPECT_EQ(game.get_packed_field().get_words(), reference.get_packed_field().get_words());
+    EXPECT_NE(runner.format_progress().find("generation " + std::to_string(10 + completed) + " ("), std::string::npos);
+
+    // A tick that is not cancelled runs to the end
+    runner.start(50);
+    EXPECT_TRUE(runner.wait_for(std::chrono::seconds(10)));
+    runner.wait();
+    EXPECT_EQ(runner.get_completed(), 50);
+    EXPECT_FALSE(runner.is_cancelled());
+
+    // An engine cancelled before it starts computes nothing
+    std::atomic<bool> cancelled{true};
+    GameEngine engine(game, 100);
+    engine.set_cancel_flag(&cancelled);
+    engine.UpdateGameState();
+    EXPECT_EQ(game.get_count_of_iterations(), 10 + completed + 50);
+}
+
+TEST(PatternLibraryTest, EmbedsGamesAndCatalogue)
+{
+    constexpr std::array<std::array<int, 2>, 3> cells{{{0, 1}, {1, 65}, {69, 69}}};
+    constexpr auto words = PatternLibrary::pack<70>(cells);
+    static_assert(words.size() == 140 && words[0] == 2 && words[3] == 2 && words[139] == 32);
+
+    // The bundled games are the files of the games directory
+    int games = 0;
+    for (const PatternLibrary::Pattern &pattern : PatternLibrary::get_patterns())
+    {
+        if (!pattern.is_game)
+        {
+            continue;
+        }
+        ++games;
+        GameState embedded, parsed;
+        PatternLibrary::load(pattern, embedded);
+        ParserFile("games/" + std::string(pattern.name) + ".live").parse(parsed);
+        EXPECT_EQ(embedded.get_universe_name(), parsed.get_universe_name());
+        EXPECT_EQ(embedded.get_size(), parsed.get_size());
+        EXPECT_EQ(embedded.get_B_conditions(), parsed.get_B_conditions());
+        EXPECT_EQ(embedded.get_S_conditions(), parsed.get_S_conditions());
+        EXPECT_EQ(embedded.get_packed_field().get_words(), parsed.get_packed_field().get_words());
+    }
+    EXPECT_EQ(games, 5);
+
+    // Catalogue patterns are what their names say; the census names the objects of one island
+    for (const std::string name : {"block", "beehive", "loaf", "boat", "tub", "blinker", "toad", "beacon", "glider"})
+    {
+        GameState game;
+        PatternLibrary::load(name, game);
+        Census census;
+        census.take(game.get_packed_field(), game.get_B_conditions(), game.get_S_conditions());
+        ASSERT_EQ(census.get_objects().size(), 1u) << name;
+        EXPECT_EQ(census.get_objects()[0].name, name);
+    }
+    auto returns_after = [](const std::string &name, int generations, int dy, int dx)
+    {
+        GameState game;
+        PatternLibrary::load(name, game);
+        GameState start = game;
+        GameEngine(game, generations).UpdateGameState();
+        int size = game.get_size();
+        for (int row = 0; row < size; ++row)
+        {
+            for (int col = 0; col < size; ++col)
+            {
+                if (start.get_packed_field().get(row, col) !=
+                    game.get_packed_field().get((row + dy + size) % size, (col + dx + size) % size))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+    EXPECT_TRUE(returns_after("pulsar", 3, 0, 0));
+    EXPECT_FALSE(returns_after("pulsar", 1, 0, 0));
+    EXPECT_TRUE(returns_after("pentadecathlon", 15, 0, 0));
+    EXPECT_TRUE(returns_after("lwss", 4, 0, -2));
+    EXPECT_TRUE(returns_after("mwss", 4, 0, 2));
+    EXPECT_TRUE(returns_after("hwss", 4, 0, 2));
+
+    GameState replicator;
+    PatternLibrary::load("replicator", replicator);
+    EXPECT_EQ(replicator.get_B_conditions(), std::set<int>({3, 6}));
+    EXPECT_THROW(PatternLibrary::load("no-such-pattern", replicator), std::invalid_argument);
+}
+
+TEST(ParserCommandsTest, LoadsBuiltInPatterns)
+{
+    ParserCommands parser_commands;
+    parser_commands.parse_command("load gosper-glider-gun");
+    EXPECT_EQ(parser_commands.get_command(), 'e');
+    EXPECT_EQ(parser_commands.get_filename(), "gosper-glider-gun");
+    EXPECT_TRUE(parser_commands.is_builtin_pattern());
+
+    parser_commands.parse_command("load glider.live");
+    EXPECT_FALSE(parser_commands.is_builtin_pattern());
+    EXPECT_THROW(parser_commands.parse_command("load no-such-pattern"), InvalidCommandException);
+
+    const char *argv[] = {"program_name", "--pattern=acorn"};
+    ParserCommandLine parser_command_line(2, const_cast<char **>(argv));
+    EXPECT_EQ(parser_command_line.get_mode(), '2');
+    EXPECT_EQ(parser_command_line.get_pattern_name(), "acorn");
+
+    const char *argv_unknown[] = {"program_name", "--pattern=no-such-pattern"};
+    EXPECT_THROW(ParserCommandLine(2, const_cast<char **>(argv_unknown)), std::invalid_argument);
+    const char *argv_file[] = {"program_name", "example.live", "--pattern=acorn"};
+    EXPECT_THROW(ParserCommandLine(3, const_cast<char **>(argv_file)), std::invalid_argument);
+
+    // The script runner loads built-in patterns like files
+    GameState game;
+    std::ostringstream output;
+    ScriptRunner runner(game, output);
+    std::istringstream script("load diehard\ntick 130\nstats\n");
+    runner.run(script);
+    EXPECT_EQ(game.get_packed_field().get_words(), PackedField(64).get_words());
+}
+
+TEST(TracerTest, RecordsZonesPerThread)
+{
+    Tracer &tracer = Tracer::instance();
+    tracer.clear();
+    {
+        TraceZone zone("disabled");
+    }
+    EXPECT_TRUE(tracer.get_events().empty());
+
+    tracer.set_enabled(true);
+    GameState game = make_glider_game(20);
+    GameEngine(game, 3).UpdateGameState();
+    std::thread worker([&tracer]
+                       {
+                           tracer.set_thread_name("test \"worker\"");
+                           for (size_t i = 0; i < Tracer::RING_CAPACITY + 10; ++i)
+                           {
+                               TraceZone zone("wrapped", static_cast<long long>(i));
+                           } });
+    worker.join();
+    tracer.set_enabled(false);
+
+    // Every generation of the engine is a zone on this thread; the full ring keeps the newest zones
+    std::map<std::string, std::vector<long long> > generations;
+    std::set<int> tracks;
+    for (const auto &[track, event] : tracer.get_events())
+    {
+        generations[event.name].push_back(event.generation);
+        tracks.insert(track);
+        EXPECT_GE(event.duration, 0);
+    }
+    EXPECT_EQ(generations["step"], std::vector<long long>({1, 2, 3}));
+    EXPECT_EQ(generations["GameEngine::UpdateGameState"].size(), 1u);
+    ASSERT_EQ(generations["wrapped"].size(), Tracer::RING_CAPACITY - 1);
+    EXPECT_EQ(generations["wrapped"].front(), 11);
+    EXPECT_EQ(tracks.size(), 2u);
+
+    std::string json = tracer.to_json();
+    EXPECT_EQ(json.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0), 0u);
+    EXPECT_NE(json.find("\"args\":{\"name\":\"test \\\"worker\\\"\"}"), std::string::npos);
+    EXPECT_NE(json.find("{\"name\":\"step\",\"cat\":\"life\",\"ph\":\"X\",\"ts\":"), std::string::npos);
+    EXPECT_NE(json.find("\"args\":{\"generation\":3}"), std::string::npos);
+
+    // A new thread takes over the ring of the finished worker on a track of its own
+    tracer.set_enabled(true);
+    std::thread next([&tracer]
+                     {
+                         tracer.set_thread_name("test next");
+                         TraceZone zone("reused"); });
+    next.join();
+    tracer.set_enabled(false);
+    std::map<std::string, std::set<int> > tracks_by_name;
+    for (const auto &[track, event] : tracer.get_events())
+    {
+        tracks_by_name[event.name].insert(track);
+    }
+    ASSERT_EQ(tracks_by_name["reused"].size(), 1u);
+    EXPECT_EQ(tracks_by_name["wrapped"].size(), 1u);
+    EXPECT_EQ(tracks_by_name["wrapped"].count(*tracks_by_name["reused"].begin()), 0u);
+    json = tracer.to_json();
+    EXPECT_NE(json.find("\"args\":{\"name\":\"test \\\"worker\\\"\"}"), std::string::npos);
+    EXPECT_NE(json.find("\"args\":{\"name\":\"test next\"}"), std::string::npos);
+
+    tracer.clear();
+    EXPECT_TRUE(tracer.get_events().empty());
+}
+
+TEST(ParserCommandsTest, ValidCommandTrace)
+{
+    ParserCommands parser_commands;
+    parser_commands.parse_command("trace on");
+    EXPECT_EQ(parser_commands.get_command(), 'k');
+    EXPECT_EQ(parser_commands.get_trace_switch(), std::optional<bool>(true));
+
+    parser_commands.parse_command("trace off");
+    EXPECT_EQ(parser_commands.get_trace_switch(), std::optional<bool>(false));
+
+    parser_commands.parse_command("trace run.json");
+    EXPECT_FALSE(parser_commands.get_trace_switch().has_value());
+    EXPECT_EQ(parser_commands.get_filename(), "run.json");
+
+    EXPECT_THROW(parser_commands.parse_command("trace"), InvalidCommandException);
+    EXPECT_THROW(parser_commands.parse_command("trace run.txt"), InvalidCommandException);
+    EXPECT_THROW(parser_commands.parse_command("trace on now"), InvalidCommandException);
+
+    const char *argv[] = {"program_name", "example.live", "--trace=run.json"};
+    EXPECT_EQ(ParserCommandLine(3, const_cast<char **>(argv)).get_trace_file(), "run.json");
+    const char *argv_invalid[] = {"program_name", "example.live", "--trace=run"};
+    EXPECT_THROW(ParserCommandLine(3, const_cast<char **>(argv_invalid)), std::invalid_argument);
+}
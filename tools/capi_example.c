@@ -0,0 +1,78 @@
+/* Example of embedding the simulator through the C interface of the shared
+ * library: loads a glider from memory, prints the population after every
+ * generation from the callback, and draws the field straight from the packed
+ * cells without copying them. */
+
+#include "../library/GameOfLife.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const char GLIDER[] = "#Life 1.06\n"
+                             "#N Glider\n"
+                             "#Size 8\n"
+                             "#R B3/S23\n"
+                             "1 2\n"
+                             "2 3\n"
+                             "3 1\n"
+                             "3 2\n"
+                             "3 3\n";
+
+static void on_generation(const gol_universe *universe, long long generation, void *user_data)
+{
+    int *calls = (int *)user_data;
+    ++*calls;
+    printf("generation %lld: population %lld\n", generation, gol_population(universe));
+}
+
+static void draw(const gol_universe *universe)
+{
+    size_t stride = 0;
+    const uint64_t *cells = gol_cells(universe, &stride);
+    int size = gol_size(universe);
+    for (int row = 0; row < size; ++row)
+    {
+        const uint64_t *words = cells + (size_t)row * stride;
+        for (int col = 0; col < size; ++col)
+        {
+            putchar((words[col / 64] >> (col % 64)) & 1 ? 'O' : '.');
+        }
+        putchar('\n');
+    }
+}
+
+int main(void)
+{
+    if (gol_api_version() != GOL_API_VERSION)
+    {
+        fprintf(stderr, "Incompatible library version %d\n", gol_api_version());
+        return 1;
+    }
+
+    gol_universe *universe = gol_create(8);
+    if (universe == NULL)
+    {
+        fprintf(stderr, "Unable to create a universe\n");
+        return 1;
+    }
+
+    if (gol_load(universe, GLIDER, strlen(GLIDER)) != GOL_OK)
+    {
+        fprintf(stderr, "Unable to load the glider: %s\n", gol_last_error(universe));
+        gol_destroy(universe);
+        return 1;
+    }
+
+    int calls = 0;
+    gol_set_callback(universe, on_generation, &calls);
+    if (gol_step(universe, 4) != GOL_OK)
+    {
+        fprintf(stderr, "Unable to step: %s\n", gol_last_error(universe));
+        gol_destroy(universe);
+        return 1;
+    }
+
+    draw(universe);
+    gol_destroy(universe);
+    return calls == 4 ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+// Crossover benchmark of the change-list engine against the dense packed
+// kernel and the sparse tiled field. A random soup fills a square window in the
+// middle of an empty field; the larger the window, the more cells change per
+// generation. All engines run the same generations from the same start, and
+// their results are compared.
+
+#include "../library/GameOfLife.hpp"
+
+#include <cstdio>
+
+namespace
+{
+    GameState make_soup(int size, int window, uint64_t seed)
+    {
+        GameState game;
+        game.set_size(size);
+        game.set_B_conditions({3});
+        game.set_S_conditions({2, 3});
+        game.set_field(PackedField(size));
+
+        std::mt19937_64 random(seed);
+        int start = (size - window) / 2;
+        for (int row = start; row < start + window; ++row)
+        {
+            for (int col = start; col < start + window; ++col)
+            {
+                if (random() % 100 < 35)
+                {
+                    game.set_cell(row, col, true);
+                }
+            }
+        }
+        return game;
+    }
+
+    template <typename Run>
+    double seconds_of(Run run)
+    {
+        auto started = std::chrono::steady_clock::now();
+        run();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int size = argc > 1 ? std::atoi(argv[1]) : 2048;
+    int generations = argc > 2 ? std::atoi(argv[2]) : 50;
+    if (size < 16 || generations < 1)
+    {
+        std::cerr << "Usage: " << argv[0] << " [size] [generations]\n";
+        return 2;
+    }
+
+    std::printf("size %d, %d generations\n", size, generations);
+    std::printf("%8s %14s %12s %12s %12s %11s %11s\n", "window", "changes/gen", "packed ms", "sparse ms", "changes ms",
+                "vs packed", "vs sparse");
+
+    int crossover = 0;
+    for (int window = 16; window <= size; window *= 2)
+    {
+        GameState dense = make_soup(size, window, 1);
+        GameState tiled = dense;
+        GameState sparse = dense;
+
+        // An observer keeps the engine on the packed kernel instead of its sparse storage
+        PackedField buffer;
+        double dense_seconds = seconds_of([&]
+                                          {
+                                              GameEngine engine(dense, generations, buffer);
+                                              engine.add_generation_callback([](const GameState &) {});
+                                              engine.UpdateGameState(); });
+
+        // The conversions in and out are part of the cost
+        double tiled_seconds = seconds_of([&]
+                                          {
+                                              std::array<bool, 9> births;
+                                              std::array<bool, 9> survivals;
+                                              GameEngine::get_rule_tables(tiled, births, survivals);
+                                              SparseField current(tiled.get_packed_field());
+                                              SparseField next;
+                                              for (int i = 0; i < generations; ++i)
+                                              {
+                                                  current.step(next, births, survivals);
+                                                  std::swap(current, next);
+                                              }
+                                              PackedField field;
+                                              current.to_packed(field);
+                                              tiled.swap_field(field); });
+
+        // The initial counts are part of the cost
+        size_t changes = 0;
+        double sparse_seconds = seconds_of([&]
+                                           {
+                                               ChangeListEngine engine(sparse);
+                                               for (int i = 0; i < generations; ++i)
+                                               {
+                                                   engine.run(1);
+                                                   changes += engine.get_change_count();
+                                               } });
+
+        if (dense.get_packed_field().get_words() != sparse.get_packed_field().get_words() ||
+            dense.get_packed_field().get_words() != tiled.get_packed_field().get_words())
+        {
+            std::fprintf(stderr, "The engines disagree for window %d\n", window);
+            return 1;
+        }
+
+        double speedup = dense_seconds / sparse_seconds;
+        if (speedup < 1 && crossover == 0)
+        {
+            crossover = window;
+        }
+        std::printf("%8d %14.0f %12.3f %12.3f %12.3f %10.2fx %10.2fx\n", window, static_cast<double>(changes) / generations,
+                    1000 * dense_seconds / generations, 1000 * tiled_seconds / generations,
+                    1000 * sparse_seconds / generations, speedup, tiled_seconds / sparse_seconds);
+    }
+
+    if (crossover > 0)
+    {
+        std::printf("the packed kernel is faster from a %d x %d window on\n", crossover, crossover);
+    }
+    else
+    {
+        std::printf("the change-list engine is faster than the packed kernel for every window\n");
+    }
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Throughput benchmark of the field storage and the engine on large fields.
+// Runs a random field for a number of generations with the given huge page
+// policy and reports cell updates per second, page faults and the amount of
+// memory the kernel backed with transparent huge pages. For dTLB misses run it
+// under perf: perf stat -e dTLB-load-misses,dTLB-store-misses fieldbench ...
+
+#include "../library/GameOfLife.hpp"
+
+#include <sys/resource.h>
+
+#include <cstdio>
+
+namespace
+{
+    long anon_huge_pages_kb()
+    {
+        std::ifstream smaps("/proc/self/smaps_rollup");
+        std::string line;
+        while (std::getline(smaps, line))
+        {
+            if (line.rfind("AnonHugePages:", 0) == 0)
+            {
+                return std::atol(line.c_str() + 14);
+            }
+        }
+        return -1;
+    }
+
+    long minor_faults()
+    {
+        rusage usage{};
+        ::getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_minflt;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <size> [generations] [none|thp|explicit]\n";
+        return 2;
+    }
+
+    int size = std::atoi(argv[1]);
+    int generations = argc > 2 ? std::atoi(argv[2]) : 20;
+    std::string policy = argc > 3 ? argv[3] : "thp";
+    FieldArena::instance().set_huge_pages(policy == "none"       ? FieldArena::HugePages::NONE
+                                          : policy == "explicit" ? FieldArena::HugePages::EXPLICIT
+                                                                 : FieldArena::HugePages::TRANSPARENT);
+
+    PackedField field(size);
+    std::mt19937_64 random(1);
+    for (uint64_t &word : field.get_words())
+    {
+        word = random() & random();
+    }
+    // Columns past the size must stay dead
+    int last_bit = (size - 1) & 63;
+    uint64_t last_mask = last_bit == 63 ? ~uint64_t(0) : (uint64_t(2) << last_bit) - 1;
+    for (int row = 0; row < size; ++row)
+    {
+        field.get_words()[static_cast<size_t>(row + 1) * field.get_stride() - 1] &= last_mask;
+    }
+
+    GameState game;
+    game.set_size(size);
+    game.set_B_conditions({3});
+    game.set_S_conditions({2, 3});
+    game.swap_field(field);
+
+    long faults = minor_faults();
+    auto started = std::chrono::steady_clock::now();
+    GameEngine engine(game, generations);
+    engine.UpdateGameState();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    FieldArena::Stats stats = FieldArena::instance().get_stats();
+    std::printf("size %d, %d generations, huge pages: %s\n", size, generations, policy.c_str());
+    std::printf("%.3f s, %.1f ms per generation, %.2f Gcell updates/s\n", seconds, 1000 * seconds / generations,
+                static_cast<double>(size) * size * generations / seconds / 1e9);
+    std::printf("minor faults %ld, AnonHugePages %ld kB, blocks: %zu allocated, %zu reused, %zu hugetlb, %zu advised\n",
+                minor_faults() - faults, anon_huge_pages_kb(), stats.allocations, stats.reuses,
+                stats.huge_tlb_blocks, stats.advised_blocks);
+    std::printf("population %lld\n", game.get_population());
+    return 0;
+}
@@ -0,0 +1,81 @@
+// Benchmark of the compile-time fixed-size universes against the packed
+// kernel on the small boards of soup searches. Every size runs the same soup
+// once through a FixedUniverse and once through GameEngine with an observer,
+// which keeps the engine on the packed kernel, and the results are compared.
+
+#include "../library/GameOfLife.hpp"
+
+#include <cstdio>
+
+namespace
+{
+    GameState make_soup(int size, uint64_t seed)
+    {
+        GameState game;
+        game.set_size(size);
+        game.set_B_conditions({3});
+        game.set_S_conditions({2, 3});
+        game.set_field(PackedField(size));
+
+        std::mt19937_64 random(seed);
+        for (int row = 0; row < size; ++row)
+        {
+            for (int col = 0; col < size; ++col)
+            {
+                if (random() % 100 < 35)
+                {
+                    game.set_cell(row, col, true);
+                }
+            }
+        }
+        return game;
+    }
+
+    template <typename Run>
+    double seconds_of(Run run)
+    {
+        auto started = std::chrono::steady_clock::now();
+        run();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    }
+
+    template <int N>
+    bool compare(int generations)
+    {
+        GameState dynamic = make_soup(N, N);
+        PackedField result;
+        double fixed_seconds = seconds_of([&]
+                                          {
+                                              FixedUniverse<N, ConwayRule> universe(dynamic.get_packed_field());
+                                              universe.run(generations);
+                                              universe.to_field(result); });
+
+        GameEngine engine(dynamic, generations);
+        engine.add_generation_callback([](const GameState &) {});
+        double dynamic_seconds = seconds_of([&]
+                                            { engine.UpdateGameState(); });
+
+        if (result.get_words() != dynamic.get_packed_field().get_words())
+        {
+            std::fprintf(stderr, "The engines disagree for size %d\n", N);
+            return false;
+        }
+        std::printf("%6d %14.1f %14.1f %8.2fx\n", N, 1e9 * dynamic_seconds / generations,
+                    1e9 * fixed_seconds / generations, dynamic_seconds / fixed_seconds);
+        return true;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int generations = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    if (generations < 1)
+    {
+        std::cerr << "Usage: " << argv[0] << " [generations]\n";
+        return 2;
+    }
+
+    std::printf("%d generations\n", generations);
+    std::printf("%6s %14s %14s %9s\n", "size", "packed ns/gen", "fixed ns/gen", "speedup");
+    return compare<16>(generations) && compare<32>(generations) && compare<64>(generations) ? 0 : 1;
+}
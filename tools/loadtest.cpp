@@ -0,0 +1,141 @@
+// Load-test client for the simulation server (game --serve=<socket>).
+// Every client thread opens its own session and sends tick and stats
+// requests in turn; the tool reports requests per second and latency
+// percentiles over all requests.
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    int connect_to(const std::string &socket_path)
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+        {
+            throw std::runtime_error("It couldn't connect to: " + socket_path);
+        }
+        return fd;
+    }
+
+    // Sends a request and reads the first line of the response
+    std::string request(int fd, const std::string &line, std::string &pending)
+    {
+        std::string message = line + "\n";
+        if (::send(fd, message.data(), message.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(message.size()))
+        {
+            throw std::runtime_error("The server closed the connection.");
+        }
+
+        char chunk[4096];
+        size_t end;
+        while ((end = pending.find('\n')) == std::string::npos)
+        {
+            ssize_t received = ::read(fd, chunk, sizeof(chunk));
+            if (received <= 0)
+            {
+                throw std::runtime_error("The server closed the connection.");
+            }
+            pending.append(chunk, received);
+        }
+
+        std::string response = pending.substr(0, end);
+        pending.erase(0, end + 1);
+        if (response.rfind("OK", 0) != 0)
+        {
+            throw std::runtime_error("Request failed: " + line + ": " + response);
+        }
+        return response;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <socket> <pattern.live> [clients] [requests per client] [ticks per request]\n";
+        return 2;
+    }
+
+    std::string socket_path = argv[1];
+    std::string pattern = argv[2];
+    int clients = argc > 3 ? std::stoi(argv[3]) : 8;
+    int requests = argc > 4 ? std::stoi(argv[4]) : 200;
+    int ticks = argc > 5 ? std::stoi(argv[5]) : 1;
+
+    std::vector<std::vector<double> > latencies(clients);
+    std::vector<std::string> errors(clients);
+    auto started = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (int client = 0; client < clients; ++client)
+    {
+        threads.emplace_back([&, client]
+                             {
+            try
+            {
+                int fd = connect_to(socket_path);
+                std::string pending;
+                std::string session = "load" + std::to_string(::getpid()) + "-" + std::to_string(client);
+                request(fd, session + " load " + pattern, pending);
+
+                for (int i = 0; i < requests; ++i)
+                {
+                    std::string line = session + (i % 2 == 0 ? " tick " + std::to_string(ticks) : " stats");
+                    auto sent = std::chrono::steady_clock::now();
+                    request(fd, line, pending);
+                    latencies[client].push_back(
+                        std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - sent).count());
+                }
+
+                request(fd, session + " exit", pending);
+                ::close(fd);
+            }
+            catch (const std::exception &e)
+            {
+                errors[client] = e.what();
+            } });
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    std::vector<double> all;
+    for (int client = 0; client < clients; ++client)
+    {
+        if (!errors[client].empty())
+        {
+            std::cerr << "Client " << client << ": " << errors[client] << "\n";
+            return 1;
+        }
+        all.insert(all.end(), latencies[client].begin(), latencies[client].end());
+    }
+    std::sort(all.begin(), all.end());
+
+    auto percentile = [&all](double p)
+    {
+        return all.empty() ? 0.0 : all[std::min(all.size() - 1, static_cast<size_t>(p * all.size()))];
+    };
+
+    std::printf("requests: %zu in %.3f s (%.0f requests/s)\n", all.size(), seconds, all.size() / seconds);
+    std::printf("latency us: p50 %.0f  p90 %.0f  p99 %.0f  p99.9 %.0f  max %.0f\n",
+                percentile(0.50), percentile(0.90), percentile(0.99), percentile(0.999), all.empty() ? 0.0 : all.back());
+    return 0;
+}
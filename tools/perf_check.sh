@@ -0,0 +1,16 @@
+#!/bin/sh
+# Builds an optimized tree and runs the performance regression gate.
+# With --update, the results of the run become the new baseline.
+set -e
+
+root=$(cd "$(dirname "$0")/.." && pwd)
+build="${PERF_BUILD_DIR:-$root/build-perf}" # An optimized tree of its own unless one is given
+
+cmake -S "$root" -B "$build" -DCMAKE_BUILD_TYPE=Release > /dev/null
+cmake --build "$build" --target perfcheck -j"$(nproc)"
+
+if [ "$1" = "--update" ]; then
+    "$build/tools/perfcheck" --games="$root/games" --output="$root/tools/perf_baseline.json"
+else
+    cmake --build "$build" --target perf-check
+fi
@@ -0,0 +1,307 @@
+// Performance regression gate. Runs a fixed set of workloads, writes their
+// timings as JSON and compares them against a checked-in baseline. Every time
+// is divided by the time of a calibration loop measured in the same run, so
+// that a baseline recorded on one machine stays comparable on another one.
+//
+// Usage: perfcheck [--games=DIR] [--baseline=FILE] [--output=FILE] [--tolerance=FRACTION]
+// Exit codes: 0 no regression, 1 regression, missing or failed workload, 2 invalid arguments or baseline.
+
+#include "../library/GameOfLife.hpp"
+
+#include <cstdio>
+
+namespace
+{
+    const int REPEATS = 3; // Runs per workload, the median one counts
+
+    struct Result
+    {
+        std::string name;  // Name of the workload
+        double seconds;    // Median run
+        double normalized; // Median run in calibration loops
+    };
+
+    // The median ignores a lucky run as well as a disturbed one
+    template <typename Run>
+    double median_seconds_of(Run run)
+    {
+        std::vector<double> times;
+        for (int i = 0; i < REPEATS; ++i)
+        {
+            auto started = std::chrono::steady_clock::now();
+            run();
+            times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count());
+        }
+        std::nth_element(times.begin(), times.begin() + REPEATS / 2, times.end());
+        return times[REPEATS / 2];
+    }
+
+    // Integer work the compiler cannot fold: a xorshift generator mixed with popcounts
+    double calibrate()
+    {
+        volatile uint64_t sink = 0;
+        return median_seconds_of([&]
+                                 {
+                                     uint64_t x = 88172645463325252ull, sum = 0;
+                                     for (int i = 0; i < 50000000; ++i)
+                                     {
+                                         x ^= x << 13;
+                                         x ^= x >> 7;
+                                         x ^= x << 17;
+                                         sum += std::popcount(x) + (x >> 60);
+                                     }
+                                     sink = sum; });
+    }
+
+    GameState make_soup(int size, int percent, uint64_t seed)
+    {
+        GameState game;
+        game.set_size(size);
+        game.set_B_conditions({3});
+        game.set_S_conditions({2, 3});
+        game.set_field(PackedField(size));
+
+        std::mt19937_64 random(seed);
+        for (int row = 0; row < size; ++row)
+        {
+            for (int col = 0; col < size; ++col)
+            {
+                if (static_cast<int>(random() % 100) < percent)
+                {
+                    game.set_cell(row, col, true);
+                }
+            }
+        }
+        return game;
+    }
+
+    // Repeats a pattern in a grid of tiles x tiles copies
+    GameState tile(const GameState &pattern, int tiles)
+    {
+        int size = pattern.get_size();
+        GameState game = pattern;
+        game.set_size(size * tiles);
+        game.set_field(PackedField(size * tiles));
+        for (int row = 0; row < size; ++row)
+        {
+            for (int col = 0; col < size; ++col)
+            {
+                if (!pattern.get_packed_field().get(row, col))
+                {
+                    continue;
+                }
+                for (int i = 0; i < tiles; ++i)
+                {
+                    for (int j = 0; j < tiles; ++j)
+                    {
+                        game.set_cell(i * size + row, j * size + col, true);
+                    }
+                }
+            }
+        }
+        return game;
+    }
+
+    double run_generations(const GameState &start, int generations)
+    {
+        PackedField buffer;
+        return median_seconds_of([&]
+                                 {
+                                     GameState game = start;
+                                     GameEngine(game, generations, buffer).UpdateGameState(); });
+    }
+
+    std::vector<Result> run_workloads(const std::string &games, double calibration)
+    {
+        std::vector<Result> results;
+        auto add = [&](const std::string &name, double seconds)
+        {
+            results.push_back({name, seconds, seconds / calibration});
+            std::printf("%-24s %10.3f ms %10.3f\n", name.c_str(), 1000 * seconds, seconds / calibration);
+        };
+
+        // The shipped patterns, tiled into fields of about a thousand cells across
+        std::vector<std::filesystem::path> patterns;
+        for (const auto &entry : std::filesystem::directory_iterator(games))
+        {
+            if (entry.path().extension() == ".live")
+            {
+                patterns.push_back(entry.path());
+            }
+        }
+        std::sort(patterns.begin(), patterns.end());
+        for (const auto &path : patterns)
+        {
+            GameState pattern;
+            ParserFile(path.string()).parse(pattern);
+            GameState game = tile(pattern, 1024 / pattern.get_size());
+            add("pattern-" + path.stem().string(), run_generations(game, 200));
+        }
+
+        for (int percent : {10, 35, 60})
+        {
+            add("soup-" + std::to_string(percent), run_generations(make_soup(1024, percent, percent), 200));
+        }
+
+        // A 1.5 million cell file written and read back
+        std::string file = (std::filesystem::temp_directory_path() / "perfcheck.live").string();
+        GameState soup = make_soup(2048, 35, 1);
+        add("dump-2048", median_seconds_of([&]
+                                           { LiveFileWriter(file).write(soup); }));
+        add("parse-2048", median_seconds_of([&]
+                                            {
+                                                GameState parsed;
+                                                ParserFile(file).parse(parsed); }));
+        std::filesystem::remove(file);
+        return results;
+    }
+
+    void write_results(const std::string &file_name, double calibration, const std::vector<Result> &results)
+    {
+        std::ofstream file(file_name);
+        file << "{\n  \"calibration_seconds\": " << calibration << ",\n  \"workloads\": {\n";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            file << "    \"" << results[i].name << "\": {\"seconds\": " << results[i].seconds
+                 << ", \"normalized\": " << results[i].normalized << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        file << "  }\n}\n";
+        if (!file)
+        {
+            throw std::runtime_error("Cannot write " + file_name);
+        }
+    }
+
+    // Reads the normalized times of a file written by write_results
+    std::map<std::string, double> read_baseline(const std::string &file_name)
+    {
+        std::ifstream file(file_name);
+        if (!file)
+        {
+            throw std::runtime_error("Cannot read " + file_name);
+        }
+        std::stringstream text;
+        text << file.rdbuf();
+        std::string json = text.str();
+
+        std::map<std::string, double> baseline;
+        static const std::regex entry(R"re("([^"]+)"\s*:\s*\{\s*"seconds"\s*:\s*[-+0-9.eE]+\s*,\s*"normalized"\s*:\s*([-+0-9.eE]+)\s*\})re");
+        for (std::sregex_iterator it(json.begin(), json.end(), entry), end; it != end; ++it)
+        {
+            baseline[(*it)[1]] = std::stod((*it)[2]);
+        }
+        if (baseline.empty())
+        {
+            throw std::runtime_error("No workloads in " + file_name);
+        }
+        return baseline;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::string games = "games";
+    std::string baseline_file;
+    std::string output_file;
+    double tolerance = 0.25;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg.rfind("--games=", 0) == 0)
+        {
+            games = arg.substr(8);
+        }
+        else if (arg.rfind("--baseline=", 0) == 0)
+        {
+            baseline_file = arg.substr(11);
+        }
+        else if (arg.rfind("--output=", 0) == 0)
+        {
+            output_file = arg.substr(9);
+        }
+        else if (arg.rfind("--tolerance=", 0) == 0 && std::atof(arg.c_str() + 12) > 0)
+        {
+            tolerance = std::atof(arg.c_str() + 12);
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--games=DIR] [--baseline=FILE] [--output=FILE] [--tolerance=FRACTION]\n";
+            return 2;
+        }
+    }
+
+#ifndef NDEBUG
+    std::cerr << "Warning: perfcheck is not an optimized build, its times are not comparable to a baseline\n";
+#endif
+
+    std::map<std::string, double> baseline;
+    std::vector<Result> results;
+    double calibration = 0;
+    try
+    {
+        if (!baseline_file.empty())
+        {
+            baseline = read_baseline(baseline_file);
+        }
+        calibration = calibrate();
+        std::printf("calibration %.3f ms\n", 1000 * calibration);
+        std::printf("%-24s %13s %10s\n", "workload", "time", "normalized");
+        results = run_workloads(games, calibration);
+        if (!output_file.empty())
+        {
+            write_results(output_file, calibration, results);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return baseline.empty() && !baseline_file.empty() ? 2 : 1;
+    }
+
+    if (baseline_file.empty())
+    {
+        return 0;
+    }
+
+    int regressions = 0;
+    int missing = 0;
+    std::printf("\n%-24s %10s %10s %9s\n", "workload", "baseline", "now", "change");
+    for (const auto &result : results)
+    {
+        auto it = baseline.find(result.name);
+        if (it == baseline.end())
+        {
+            std::printf("%-24s %10s %10.3f %9s\n", result.name.c_str(), "-", result.normalized, "new");
+            continue;
+        }
+        double change = result.normalized / it->second - 1;
+        bool regressed = change > tolerance;
+        regressions += regressed;
+        std::printf("%-24s %10.3f %10.3f %+8.1f%%%s\n", result.name.c_str(), it->second, result.normalized,
+                    100 * change, regressed ? "  REGRESSION" : "");
+        baseline.erase(it);
+    }
+    // A workload that no longer runs must not pass the gate unnoticed
+    for (const auto &[name, normalized] : baseline)
+    {
+        std::printf("%-24s %10.3f %10s %9s\n", name.c_str(), normalized, "-", "MISSING");
+        ++missing;
+    }
+
+    if (regressions > 0 || missing > 0)
+    {
+        if (regressions > 0)
+        {
+            std::printf("%d of %zu workloads are more than %.0f%% slower than the baseline\n", regressions,
+                        results.size(), 100 * tolerance);
+        }
+        if (missing > 0)
+        {
+            std::printf("%d workloads of the baseline did not run\n", missing);
+        }
+        return 1;
+    }
+    std::printf("no workload is more than %.0f%% slower than the baseline\n", 100 * tolerance);
+    return 0;
+}